@@ -0,0 +1,203 @@
+// bench/bench_db.cpp
+// Write latency per DatabaseOptions preset; substring search at scale
+// (SQLite and the in-memory MetadataIndex); add/get/search/list as the
+// table grows.
+//   ./epm_bench "[db-presets]"
+//   EPM_BENCH_ROWS=1000000 ./epm_bench "[db-search]"
+//   EPM_BENCH_SCALES=1000,100000 ./epm_bench "[db-scale]"
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+#include "MetadataIndex.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace {
+    // Throwaway DB file (plus WAL side files) removed on scope exit
+    struct TempDb {
+        std::string path;
+        explicit TempDb(std::string p) : path(std::move(p)) { removeAll(); }
+        ~TempDb() { removeAll(); }
+        void removeAll() const {
+            std::error_code ec;
+            for (const char* suffix : {"", "-wal", "-shm", "-journal"})
+                std::filesystem::remove(path + suffix, ec);
+        }
+    };
+
+    // Comma-separated row counts from EPM_BENCH_SCALES, or 1k/100k/1M
+    std::vector<std::size_t> bench_scales() {
+        const char* env = std::getenv("EPM_BENCH_SCALES");
+        std::string spec = env && *env ? env : "1000,100000,1000000";
+        std::vector<std::size_t> out;
+        std::size_t pos = 0;
+        while (pos <= spec.size()) {
+            const std::size_t comma = std::min(spec.find(',', pos), spec.size());
+            const std::size_t n = std::strtoul(spec.substr(pos, comma - pos).c_str(), nullptr, 10);
+            if (n > 0) out.push_back(n);
+            pos = comma + 1;
+        }
+        return out;
+    }
+
+    // Appends n synthetic rows in 50k-row transactions (bounded memory at 1M)
+    void populate(DatabaseManager& db, std::size_t n) {
+        const std::vector<std::uint8_t> enc(48, 0xAB), iv(12, 0x01);
+        constexpr std::size_t kChunk = 50000;
+        std::vector<NewCredential> rows;
+        for (std::size_t base = 0; base < n; base += kChunk) {
+            rows.resize(std::min(kChunk, n - base));
+            for (std::size_t j = 0; j < rows.size(); ++j) {
+                const std::size_t i = base + j;
+                rows[j].service      = "service-" + std::to_string(i);
+                rows[j].username     = "user" + std::to_string(i * 7919 % n) + "@example.com";
+                rows[j].notes        = i % 10 == 0 ? "shared team login" : "";
+                rows[j].enc_password = enc;
+                rows[j].iv           = iv;
+                rows[j].created_at   = "2025-01-01T00:00:00Z";
+            }
+            db.addCredentials(rows);
+        }
+    }
+
+    DatabaseOptions legacyOptions() {
+        // What the constructor used before presets existed
+        DatabaseOptions o;
+        o.journalMode = DatabaseOptions::JournalMode::Delete;
+        o.synchronous = DatabaseOptions::Synchronous::Full;
+        return o;
+    }
+}
+
+TEST_CASE("DB presets: write latency", "[bench][db][db-presets]") {
+    const std::vector<std::uint8_t> enc(48, 0xAB), iv(12, 0x01);
+
+    std::vector<NewCredential> rows(1000);
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        rows[i].service      = "service-" + std::to_string(i % 97);
+        rows[i].username     = "user" + std::to_string(i);
+        rows[i].enc_password = enc;
+        rows[i].iv           = iv;
+        rows[i].created_at   = "2025-01-01T00:00:00Z";
+    }
+
+    const std::pair<const char*, DatabaseOptions> presets[] = {
+        { "legacy",  legacyOptions() },
+        { "durable", DatabaseOptions::durable() },
+        { "fast",    DatabaseOptions::fast() },
+    };
+
+    for (const auto& [name, opts] : presets) {
+        TempDb tmp(std::string("tmp_bench_preset_") + name + ".sqlite");
+        DatabaseManager db(tmp.path, opts);
+        db.init();
+
+        BENCHMARK(std::string(name) + ": addCredential (autocommit)") {
+            return db.addCredential("github", "octocat", enc, iv, "");
+        };
+
+        BENCHMARK(std::string(name) + ": addCredentials x1000 (one txn)") {
+            return db.addCredentials(rows).size();
+        };
+
+        BENCHMARK(std::string(name) + ": getCredentialById") {
+            return db.getCredentialById(1).has_value();
+        };
+    }
+}
+
+TEST_CASE("DB search: trigram index vs LIKE scan", "[bench][db][db-search]") {
+    std::size_t n = 200000;
+    if (const char* env = std::getenv("EPM_BENCH_ROWS")) n = std::strtoul(env, nullptr, 10);
+
+    TempDb tmp("tmp_bench_search.sqlite");
+    DatabaseManager db(tmp.path, DatabaseOptions::fast());
+    db.init();
+    populate(db, n);
+
+    // Rare substring: a handful of hits anywhere in the table
+    const std::string rare = "ice-" + std::to_string(n / 2 + 7);
+
+    BENCHMARK("searchCredentials: rare substring (trigram)") {
+        return db.searchCredentials(rare).size();
+    };
+
+    BENCHMARK("searchCredentials: 2-char query (LIKE scan)") {
+        return db.searchCredentials("zz").size();
+    };
+
+    BENCHMARK("searchByService: rare substring (trigram)") {
+        return db.searchByService(rare).size();
+    };
+
+    // A cursor halfway down the table, as after paging through n/2 rows
+    const ListCursor middle{ "2025-01-01T00:00:00Z", static_cast<int>(n / 2) };
+
+    BENCHMARK("listCredentials: first page of 50") {
+        return db.listCredentials(std::nullopt, 50).rows.size();
+    };
+
+    BENCHMARK("listCredentials: page of 50 at depth n/2") {
+        return db.listCredentials(middle, 50).rows.size();
+    };
+
+    BENCHMARK("MetadataIndex::build") {
+        return MetadataIndex::build(db).size();
+    };
+
+    const MetadataIndex index = MetadataIndex::build(db);
+
+    BENCHMARK("MetadataIndex: rare substring") {
+        return index.search(rare, MetadataIndex::Mode::Substring).size();
+    };
+
+    BENCHMARK("MetadataIndex: 2-char substring") {
+        return index.search("zz", MetadataIndex::Mode::Substring).size();
+    };
+
+    BENCHMARK("MetadataIndex: fuzzy with a typo") {
+        return index.search("sevrice-4242", MetadataIndex::Mode::Fuzzy, 10).size();
+    };
+}
+
+TEST_CASE("DB scale: add/get/search/list by table size", "[bench][db][db-scale]") {
+    const std::vector<std::uint8_t> enc(48, 0xAB), iv(12, 0x01);
+
+    for (const std::size_t n : bench_scales()) {
+        TempDb tmp("tmp_bench_scale.sqlite");
+        DatabaseManager db(tmp.path, DatabaseOptions::fast());
+        db.init();
+        populate(db, n);
+
+        const std::string label = " @" + std::to_string(n);
+        const std::string rare = "ice-" + std::to_string(n / 2 + 7);
+        const ListCursor middle{ "2025-01-01T00:00:00Z", static_cast<int>(n / 2) };
+
+        BENCHMARK("addCredential (autocommit)" + label) {
+            return db.addCredential("github", "octocat", enc, iv, "");
+        };
+
+        // Scattered ids, so the page cache does not just serve one row
+        std::uint64_t next = 1;
+        BENCHMARK("getCredentialById" + label) {
+            next = (next * 6364136223846793005ull + 1442695040888963407ull);
+            return db.getCredentialById(static_cast<int>(1 + (next >> 33) % n)).has_value();
+        };
+
+        BENCHMARK("searchCredentials: rare substring" + label) {
+            return db.searchCredentials(rare).size();
+        };
+
+        BENCHMARK("listCredentials: first page of 50" + label) {
+            return db.listCredentials(std::nullopt, 50).rows.size();
+        };
+
+        BENCHMARK("listCredentials: page of 50 at depth n/2" + label) {
+            return db.listCredentials(middle, 50).rows.size();
+        };
+    }
+}
@@ -0,0 +1,100 @@
+// bench/bench_json.cpp
+// Machine-readable results for regression tracking. Set EPM_BENCH_JSON to a
+// path and every BENCHMARK's estimates are written there when the run ends:
+//   EPM_BENCH_JSON=bench.json ./epm_bench "[crypto]"
+// Runs alongside whatever reporter is selected on the command line.
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+    std::string json_escape(const std::string& s) {
+        std::string out;
+        out.reserve(s.size() + 2);
+        for (char c : s) {
+            switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+            }
+        }
+        return out;
+    }
+
+    struct Result {
+        std::string testCase;
+        std::string name;
+        double meanNs, meanLowNs, meanHighNs, stddevNs;
+        int samples;
+        int iterations;
+    };
+
+    class JsonBenchListener : public Catch::EventListenerBase {
+    public:
+        using EventListenerBase::EventListenerBase;
+
+        void testCaseStarting(const Catch::TestCaseInfo& info) override {
+            m_testCase = info.name;
+        }
+
+        void benchmarkEnded(const Catch::BenchmarkStats<>& stats) override {
+            m_results.push_back({
+                m_testCase, stats.info.name,
+                stats.mean.point.count(), stats.mean.lower_bound.count(),
+                stats.mean.upper_bound.count(), stats.standardDeviation.point.count(),
+                static_cast<int>(stats.info.samples), static_cast<int>(stats.info.iterations),
+            });
+        }
+
+        void testRunEnded(const Catch::TestRunStats&) override {
+            const char* path = std::getenv("EPM_BENCH_JSON");
+            if (!path || !*path) return;
+
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                std::fprintf(stderr, "epm_bench: cannot write %s\n", path);
+                return;
+            }
+            const char* rows = std::getenv("EPM_BENCH_ROWS");
+            const char* scales = std::getenv("EPM_BENCH_SCALES");
+            out << "{\n  \"timestamp\": " << std::time(nullptr) << ",\n"
+                << "  \"rows\": \"" << json_escape(rows ? rows : "") << "\",\n"
+                << "  \"scales\": \"" << json_escape(scales ? scales : "") << "\",\n"
+                << "  \"benchmarks\": [";
+            for (std::size_t i = 0; i < m_results.size(); ++i) {
+                const Result& r = m_results[i];
+                out << (i ? ",\n" : "\n")
+                    << "    {\"test_case\": \"" << json_escape(r.testCase)
+                    << "\", \"name\": \"" << json_escape(r.name)
+                    << "\", \"mean_ns\": " << r.meanNs
+                    << ", \"mean_low_ns\": " << r.meanLowNs
+                    << ", \"mean_high_ns\": " << r.meanHighNs
+                    << ", \"stddev_ns\": " << r.stddevNs
+                    << ", \"samples\": " << r.samples
+                    << ", \"iterations\": " << r.iterations << "}";
+            }
+            out << "\n  ]\n}\n";
+        }
+
+    private:
+        std::string m_testCase;
+        std::vector<Result> m_results;
+    };
+}
+
+CATCH_REGISTER_LISTENER(JsonBenchListener)
@@ -0,0 +1,83 @@
+// bench/bench_kdf.cpp
+// Argon2id deriveKey at several cost settings, password generation and
+// strength estimation.
+// The KDF cases are slow by design; fewer samples keep the run short:
+//   ./epm_bench "[kdf]" --benchmark-samples 10
+//   ./epm_bench "[passgen]"
+//   ./epm_bench "[strength]"
+#include <catch2/catch_all.hpp>
+#include "EncryptionManager.hpp"
+#include "KdfParams.hpp"
+#include "PasswordGenerator.hpp"
+#include "PasswordStrength.hpp"
+#include "password_gen.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+TEST_CASE("KDF: deriveKey cost settings", "[bench][kdf]") {
+    const std::vector<std::uint8_t> salt(16, 0x11);
+    const std::string master = "correct horse battery staple";
+
+    struct Setting { const char* name; KdfParams params; };
+    const Setting settings[] = {
+        { "t=1 m=8MiB p=1",   { 1, 8 * 1024, 1 } },
+        { "t=2 m=19MiB p=1",  { 2, 19 * 1024, 1 } },  // OWASP minimum
+        { "t=3 m=64MiB p=1",  KdfParams{} },          // vault default
+        { "t=3 m=64MiB p=4",  { 3, 64 * 1024, 4 } },
+    };
+
+    for (const auto& s : settings) {
+        BENCHMARK(std::string("deriveKey ") + s.name) {
+            return EncryptionManager::deriveKey(master, salt, s.params);
+        };
+    }
+}
+
+TEST_CASE("Password generation", "[bench][passgen]") {
+    for (const std::size_t len : {16u, 32u, 64u}) {
+        const std::string label = std::to_string(len) + " chars";
+
+        BENCHMARK("generate_password " + label) {
+            return generate_password(len);
+        };
+
+        BENCHMARK("generate_password " + label + ", no symbols") {
+            return generate_password(len, true, true, true, false);
+        };
+    }
+
+    // Bulk: tables built once, one RAND_bytes per 4 KiB
+    PasswordPolicy policy;
+    policy.length = 20;
+    policy.minDigits = 2;
+    policy.minSymbols = 2;
+    const PasswordGenerator gen(policy);
+    BENCHMARK("PasswordGenerator::generateMany 1000 x 20 chars, minimums") {
+        return gen.generateMany(1000);
+    };
+}
+
+TEST_CASE("Password strength estimation", "[bench][strength]") {
+    // What epm audit runs per credential: random, pattern-heavy and long input
+    PasswordPolicy policy;
+    policy.length = 20;
+    const auto random = PasswordGenerator(policy).generateMany(1000);
+    const std::string_view context[] = { "github.com", "octocat" };
+
+    BENCHMARK("estimateStrength 1000 x 20 random chars") {
+        double bits = 0;
+        for (const std::string& pw : random) bits += estimateStrength(pw, context).bits;
+        return bits;
+    };
+
+    BENCHMARK("estimateStrength \"Octocat2024!qwerty\"") {
+        return estimateStrength("Octocat2024!qwerty", context).bits;
+    };
+
+    const std::string longPw(128, 'x');
+    BENCHMARK("estimateStrength 128 chars") {
+        return estimateStrength(longPw).bits;
+    };
+}
@@ -3,16 +3,19 @@
 #include <commctrl.h>
 #include <string>
 #include <vector>
+#include <span>
 #include <memory>
 #include <sstream>
-#include <ctime>
 #include <stdexcept>
-#include <openssl/rand.h>
 
 #include "resource.h"
 #include "DatabaseManager.hpp"
-#include "AuthManager.hpp"
 #include "EncryptionManager.hpp"
+#include "CredentialAad.hpp"
+#include "VaultUnlock.hpp"
+#include "MetadataIndex.hpp"
+#include "LazyCredential.hpp"
+#include "SecureAllocator.hpp"
 #include "password_gen.hpp"
 
 // Globals
@@ -23,14 +26,23 @@ NOTIFYICONDATA g_nid{};
 bool g_loginOpen = false;
 std::unique_ptr<DatabaseManager> g_db;
 std::unique_ptr<EncryptionManager> g_enc;
+std::unique_ptr<MetadataIndex> g_index; // attached to g_db as its observer
 
 // Forward declarations
 LRESULT CALLBACK MainWndProc(HWND, UINT, WPARAM, LPARAM);
 LRESULT CALLBACK MenuWndProc(HWND, UINT, WPARAM, LPARAM);
 
+const wchar_t* const kTrayTip = L"EPM (click to unlock)";
+
+void SetTrayTip(const std::wstring& tip) {
+    lstrcpyn(g_nid.szTip, tip.c_str(), ARRAYSIZE(g_nid.szTip));
+    g_nid.uFlags = NIF_TIP;
+    Shell_NotifyIcon(NIM_MODIFY, &g_nid);
+}
+
 // ---- Login dialog helpers -------------------------------------------------
 namespace {
-static std::string g_loginPw;
+static secure_string g_loginPw;
 static bool g_loginOk = false;
 static bool g_loginDone = false;
 
@@ -41,6 +53,15 @@ std::string narrow(const std::wstring& ws) {
     return s;
 }
 
+// UTF-8 conversion straight into locked memory, for passwords
+secure_string narrowSecret(const wchar_t* ws) {
+    int len = WideCharToMultiByte(CP_UTF8, 0, ws, -1, nullptr, 0, nullptr, nullptr);
+    secure_string s;
+    s.resize(len > 0 ? len - 1 : 0);
+    WideCharToMultiByte(CP_UTF8, 0, ws, -1, s.data(), len, nullptr, nullptr);
+    return s;
+}
+
 LRESULT CALLBACK LoginWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
     case WM_COMMAND:
@@ -48,13 +69,14 @@ LRESULT CALLBACK LoginWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         case IDC_BTN_OK: {
             wchar_t buf[256];
             GetWindowText(GetDlgItem(hwnd, IDC_EDIT_PASSWORD), buf, 256);
-            g_loginPw = narrow(buf);
+            g_loginPw = narrowSecret(buf);
+            SecureZeroMemory(buf, sizeof(buf));
             g_loginOk = true;
             DestroyWindow(hwnd);
             return 0;
         }
         case IDC_BTN_CANCEL:
-            g_loginPw.clear();
+            g_loginPw = secure_string();
             g_loginOk = false;
             DestroyWindow(hwnd);
             return 0;
@@ -74,7 +96,7 @@ LRESULT CALLBACK LoginWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     return DefWindowProc(hwnd, msg, wParam, lParam);
 }
 
-bool ShowPasswordDialog(HWND owner, std::string& outPw) {
+bool ShowPasswordDialog(HWND owner, secure_string& outPw) {
     WNDCLASS wc{};
     wc.lpfnWndProc = LoginWndProc;
     wc.hInstance = g_hInst;
@@ -122,7 +144,7 @@ bool ShowPasswordDialog(HWND owner, std::string& outPw) {
         }
     }
     if (g_loginOk) {
-        outPw = g_loginPw;
+        outPw = std::move(g_loginPw);
     }
     return g_loginOk;
 }
@@ -132,46 +154,29 @@ bool PromptLogin(HWND owner) {
     if (g_enc) return true; // already logged in
     g_loginOpen = true;
     bool authed = false;
-    std::string pw;
+    secure_string pw;
     while (ShowPasswordDialog(owner, pw)) {
         try {
             CreateDirectoryA("data", nullptr);
             g_db = std::make_unique<DatabaseManager>("data/epm.sqlite");
             g_db->init();
 
-            AuthManager auth;
-            auto master = g_db->loadMaster();
-            if (!master) {
+            if (!g_db->loadMaster()) {
                 if (pw.empty()) {
                     MessageBox(owner, L"Password cannot be empty", L"Error", MB_OK | MB_ICONERROR);
                     continue;
                 }
-                StoredAuth rec = auth.createMasterRecord(pw);
-                g_db->storeMaster(rec.salt, rec.hash);
-                std::vector<std::uint8_t> salt(16);
-                RAND_bytes(salt.data(), static_cast<int>(salt.size()));
-                g_db->storeKdfSalt(salt);
-                auto key = EncryptionManager::deriveKey(pw, salt);
-                g_enc = std::make_unique<EncryptionManager>(key);
+                g_enc = std::make_unique<EncryptionManager>(createVault(*g_db, pw));
                 authed = true;
                 break;
             } else {
-                StoredAuth stored{ master->first, master->second };
-                if (!auth.verifyMasterPassword(pw, stored)) {
+                // Older vaults stay on the two-KDF scheme until `epm upgrade`
+                auto unlocked = unlockVault(*g_db, pw);
+                if (!unlocked) {
                     MessageBox(owner, L"Incorrect password", L"Error", MB_OK | MB_ICONERROR);
                     continue;
                 }
-                auto kdfSaltOpt = g_db->loadKdfSalt();
-                std::vector<std::uint8_t> salt;
-                if (kdfSaltOpt) {
-                    salt = *kdfSaltOpt;
-                } else {
-                    salt.resize(16);
-                    RAND_bytes(salt.data(), static_cast<int>(salt.size()));
-                    g_db->storeKdfSalt(salt);
-                }
-                auto key = EncryptionManager::deriveKey(pw, salt);
-                g_enc = std::make_unique<EncryptionManager>(key);
+                g_enc = std::make_unique<EncryptionManager>(std::move(*unlocked));
                 authed = true;
                 break;
             }
@@ -179,6 +184,15 @@ bool PromptLogin(HWND owner) {
             MessageBoxA(owner, e.what(), "Error", MB_OK | MB_ICONERROR);
         }
     }
+    if (authed) {
+        try {
+            g_index = std::make_unique<MetadataIndex>(MetadataIndex::build(*g_db));
+            g_db->setObserver(g_index.get());
+        } catch (const std::exception& e) {
+            // Quick find stays unavailable; everything else works without it
+            MessageBoxA(owner, e.what(), "Error", MB_OK | MB_ICONERROR);
+        }
+    }
     g_loginOpen = false;
     return authed;
 }
@@ -192,7 +206,8 @@ struct Field {
 };
 
 static std::vector<HWND> g_inputEdits;
-static std::vector<std::string> g_inputVals;
+static std::vector<std::string> g_inputVals;      // empty for password fields
+static std::vector<secure_string> g_inputSecrets; // password fields only
 static bool g_inputOk = false;
 static bool g_inputDone = false;
 static const std::vector<Field>* g_inputFields = nullptr;
@@ -228,10 +243,18 @@ LRESULT CALLBACK InputWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         case IDC_BTN_OK: {
             wchar_t buf[512];
             g_inputVals.clear();
-            for (HWND e : g_inputEdits) {
-                GetWindowText(e, buf, 512);
-                g_inputVals.push_back(narrow(buf));
+            g_inputSecrets.clear();
+            for (size_t i = 0; i < g_inputEdits.size(); ++i) {
+                GetWindowText(g_inputEdits[i], buf, 512);
+                if ((*g_inputFields)[i].password) {
+                    g_inputVals.emplace_back();
+                    g_inputSecrets.push_back(narrowSecret(buf));
+                } else {
+                    g_inputVals.push_back(narrow(buf));
+                    g_inputSecrets.emplace_back();
+                }
             }
+            SecureZeroMemory(buf, sizeof(buf));
             g_inputOk = true;
             DestroyWindow(hwnd);
             return 0;
@@ -256,13 +279,17 @@ LRESULT CALLBACK InputWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     return DefWindowProc(hwnd, msg, wParam, lParam);
 }
 
+// Password fields come back in `secrets` (same index, locked memory); their
+// slot in `values` is left empty
 bool ShowInputDialog(HWND owner, const wchar_t* title,
                      const std::vector<Field>& fields,
-                     std::vector<std::string>& values) {
+                     std::vector<std::string>& values,
+                     std::vector<secure_string>& secrets) {
     g_inputFields = &fields;
     g_inputOk = false;
     g_inputDone = false;
     g_inputVals.clear();
+    g_inputSecrets.clear();
     g_inputEdits.clear();
 
     WNDCLASS wc{};
@@ -305,18 +332,17 @@ bool ShowInputDialog(HWND owner, const wchar_t* title,
     }
     if (g_inputOk) {
         values = g_inputVals;
+        secrets = std::move(g_inputSecrets);
     }
+    g_inputSecrets = std::vector<secure_string>();
     return g_inputOk;
 }
 
-
-std::string isoNow() {
-    std::time_t t = std::time(nullptr);
-    std::tm tm;
-    gmtime_s(&tm, &t);
-    char buf[32];
-    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
-    return buf;
+bool ShowInputDialog(HWND owner, const wchar_t* title,
+                     const std::vector<Field>& fields,
+                     std::vector<std::string>& values) {
+    std::vector<secure_string> secrets;
+    return ShowInputDialog(owner, title, fields, values, secrets);
 }
 
 enum MenuIds {
@@ -327,7 +353,8 @@ enum MenuIds {
     ID_BTN_DELETE,
     ID_BTN_GEN,
     ID_BTN_LIST,
-    ID_BTN_CHANGE
+    ID_BTN_CHANGE,
+    ID_BTN_FIND
 };
 
 void OnAddCredential(HWND hwnd) {
@@ -339,18 +366,17 @@ void OnAddCredential(HWND hwnd) {
         {IDC_EDIT_NOTES, L"Notes:"}
     };
     std::vector<std::string> vals;
-    if (!ShowInputDialog(hwnd, L"Add credential", fields, vals)) return;
+    std::vector<secure_string> secrets;
+    if (!ShowInputDialog(hwnd, L"Add credential", fields, vals, secrets)) return;
     try {
-        std::string service = vals[0];
-        std::string username = vals[1];
-        std::string secret = vals[2];
-        std::string notes = vals[3];
-        std::string created = isoNow();
-        std::string aadStr = service + "\n" + username + "\n" + created;
-        std::vector<std::uint8_t> aad(aadStr.begin(), aadStr.end());
-        std::vector<std::uint8_t> pt(secret.begin(), secret.end());
-        auto encRes = g_enc->encrypt(pt, aad);
-        int id = g_db->addCredential(service, username, encRes.encAndTag, encRes.iv, notes);
+        NewCredential nc;
+        nc.service = vals[0];
+        nc.username = vals[1];
+        nc.notes = vals[3];
+        nc.created_at = iso8601UtcNow();
+        sealCredential(*g_enc, secrets[2], nc.service, nc.username, nc.created_at,
+                       nc.iv, nc.enc_password);
+        int id = g_db->addCredentials(std::span<const NewCredential>(&nc, 1)).front();
         MessageBoxA(hwnd, ("Added id " + std::to_string(id)).c_str(), "Success", MB_OK);
     } catch (const std::exception& e) {
         MessageBoxA(hwnd, e.what(), "Error", MB_OK | MB_ICONERROR);
@@ -359,13 +385,12 @@ void OnAddCredential(HWND hwnd) {
 
 void OnSearchService(HWND hwnd) {
     if (!g_db) return;
-    std::vector<Field> fields = { {IDC_EDIT_QUERY, L"Service substring:"} };
+    std::vector<Field> fields = { {IDC_EDIT_QUERY, L"Service, username or notes:"} };
     std::vector<std::string> vals;
     if (!ShowInputDialog(hwnd, L"Search", fields, vals)) return;
     try {
-        auto rows = g_db->searchByService(vals[0]);
         std::ostringstream oss;
-        for (const auto& r : rows) {
+        for (const auto& r : g_db->searchCredentials(vals[0])) {
             oss << r.id << " | " << r.service << " | " << r.username << " | " << r.created_at << "\n";
         }
         std::string text = oss.str();
@@ -376,6 +401,23 @@ void OnSearchService(HWND hwnd) {
     }
 }
 
+void OnQuickFind(HWND hwnd) {
+    if (!g_index) return;
+    std::vector<Field> fields = { {IDC_EDIT_QUERY, L"Service or username (typos ok):"} };
+    std::vector<std::string> vals;
+    if (!ShowInputDialog(hwnd, L"Quick find", fields, vals)) return;
+    // Exact substrings first; fuzzy only when nothing matches exactly
+    auto hits = g_index->search(vals[0], MetadataIndex::Mode::Substring);
+    if (hits.empty()) hits = g_index->search(vals[0], MetadataIndex::Mode::Fuzzy, 10);
+    std::ostringstream oss;
+    for (const auto& h : hits) {
+        oss << h.id << " | " << h.service << " | " << h.username << " | " << h.created_at << "\n";
+    }
+    std::string text = oss.str();
+    if (text.empty()) text = "(no matches)";
+    MessageBoxA(hwnd, text.c_str(), "Quick find", MB_OK);
+}
+
 void OnViewById(HWND hwnd) {
     if (!g_db || !g_enc) return;
     std::vector<Field> fields = { {IDC_EDIT_ID, L"Credential ID:"} };
@@ -383,17 +425,18 @@ void OnViewById(HWND hwnd) {
     if (!ShowInputDialog(hwnd, L"View credential", fields, vals)) return;
     try {
         int id = std::stoi(vals[0]);
-        auto rowOpt = g_db->getCredentialById(id);
-        if (!rowOpt) {
+        auto cred = LazyCredential::load(*g_db, *g_enc, id);
+        if (!cred) {
             MessageBox(hwnd, L"ID not found", L"Error", MB_OK | MB_ICONERROR);
             return;
         }
-        const Credential& r = *rowOpt;
-        std::string aadStr = r.service + "\n" + r.username + "\n" + r.created_at;
-        std::vector<std::uint8_t> aad(aadStr.begin(), aadStr.end());
-        auto pt = g_enc->decrypt(r.iv, r.enc_password, aad);
-        std::string secret(pt.begin(), pt.end());
-        std::string msg = "Service: " + r.service + "\nUsername: " + r.username + "\nSecret: " + secret;
+        // Built in place: no temporaries hold the secret
+        secure_string msg("Service: ");
+        msg += cred->meta.service;
+        msg += "\nUsername: ";
+        msg += cred->meta.username;
+        msg += "\nSecret: ";
+        msg += cred->secret.reveal();
         MessageBoxA(hwnd, msg.c_str(), "Credential", MB_OK);
     } catch (const std::exception& e) {
         MessageBoxA(hwnd, e.what(), "Error", MB_OK | MB_ICONERROR);
@@ -409,34 +452,24 @@ void OnUpdateById(HWND hwnd) {
         {IDC_EDIT_NEW_NOTES, L"New notes:"}
     };
     std::vector<std::string> vals;
-    if (!ShowInputDialog(hwnd, L"Update credential", fields, vals)) return;
+    std::vector<secure_string> secrets;
+    if (!ShowInputDialog(hwnd, L"Update credential", fields, vals, secrets)) return;
     try {
         int id = std::stoi(vals[0]);
-        auto rowOpt = g_db->getCredentialById(id);
-        if (!rowOpt) {
+        auto cred = LazyCredential::load(*g_db, *g_enc, id);
+        if (!cred) {
             MessageBox(hwnd, L"ID not found", L"Error", MB_OK | MB_ICONERROR);
             return;
         }
-        Credential r = *rowOpt;
-        std::string newUser = vals[1].empty() ? r.username : vals[1];
-        std::string newNotes = vals[3].empty() ? r.notes : vals[3];
-        std::vector<std::uint8_t> newEnc = r.enc_password;
-        std::vector<std::uint8_t> newIv = r.iv;
-        bool usernameChanged = newUser != r.username;
-        if (!vals[2].empty() || usernameChanged) {
-            std::string oldAadStr = r.service + "\n" + r.username + "\n" + r.created_at;
-            std::vector<std::uint8_t> oldAad(oldAadStr.begin(), oldAadStr.end());
-            auto pt = g_enc->decrypt(r.iv, r.enc_password, oldAad);
-            if (!vals[2].empty()) {
-                pt.assign(vals[2].begin(), vals[2].end());
-            }
-            std::string newAadStr = r.service + "\n" + newUser + "\n" + r.created_at;
-            std::vector<std::uint8_t> newAad(newAadStr.begin(), newAadStr.end());
-            auto encRes = g_enc->encrypt(pt, newAad);
-            newEnc = encRes.encAndTag;
-            newIv = encRes.iv;
-        }
-        g_db->updateCredential(id, newUser, newEnc, newIv, newNotes);
+        const CredentialMeta& m = cred->meta;
+        std::string newUser = vals[1].empty() ? m.username : vals[1];
+        std::string newNotes = vals[3].empty() ? m.notes : vals[3];
+        // Always re-seal: the username is part of the AAD, and the old
+        // ciphertext is never loaded unless the secret is kept
+        std::string_view kept = secrets[2].empty() ? cred->secret.reveal() : std::string_view(secrets[2]);
+        auto newAad = makeCredentialAad(m.service, newUser, m.created_at);
+        auto encRes = g_enc->encrypt(asBytes(kept), newAad);
+        g_db->updateCredential(id, newUser, encRes.encAndTag, encRes.iv, newNotes);
         MessageBox(hwnd, L"Updated", L"Info", MB_OK);
     } catch (const std::exception& e) {
         MessageBoxA(hwnd, e.what(), "Error", MB_OK | MB_ICONERROR);
@@ -472,67 +505,54 @@ void OnChangeMaster(HWND hwnd) {
         {IDC_EDIT_CONFIRM_MASTER, L"Confirm new password:", true}
     };
     std::vector<std::string> vals;
-    if (!ShowInputDialog(hwnd, L"Change master password", fields, vals)) return;
-    std::string cur = vals[0];
-    std::string nw = vals[1];
-    std::string confirm = vals[2];
+    std::vector<secure_string> secrets;
+    if (!ShowInputDialog(hwnd, L"Change master password", fields, vals, secrets)) return;
+    const secure_string& cur = secrets[0];
+    const secure_string& nw = secrets[1];
+    const secure_string& confirm = secrets[2];
     if (nw != confirm) {
         MessageBox(hwnd, L"Passwords do not match", L"Error", MB_OK | MB_ICONERROR);
         return;
     }
     try {
-        AuthManager auth;
-        auto masterOpt = g_db->loadMaster();
-        if (!masterOpt) {
-            MessageBox(hwnd, L"No master record", L"Error", MB_OK | MB_ICONERROR);
-            return;
-        }
-        StoredAuth stored{ masterOpt->first, masterOpt->second };
-        if (!auth.verifyMasterPassword(cur, stored)) {
+        auto changed = changeMasterPassword(*g_db, cur, nw, [](std::size_t done, std::size_t total) {
+            SetTrayTip(L"EPM (re-encrypting " + std::to_wstring(done) + L"/"
+                       + std::to_wstring(total) + L")");
+        });
+        SetTrayTip(kTrayTip);
+        if (!changed) {
             MessageBox(hwnd, L"Incorrect password", L"Error", MB_OK | MB_ICONERROR);
             return;
         }
-        g_db->beginTransaction();
-        auto rows = g_db->getAllCredentials();
-        auto oldSaltOpt = g_db->loadKdfSalt();
-        if (!oldSaltOpt) {
-            throw std::runtime_error("Missing KDF salt");
-        }
-        auto oldKey = EncryptionManager::deriveKey(cur, *oldSaltOpt);
-        EncryptionManager encOld(oldKey);
-        std::vector<std::uint8_t> newSalt(16);
-        RAND_bytes(newSalt.data(), (int)newSalt.size());
-        auto newKey = EncryptionManager::deriveKey(nw, newSalt);
-        EncryptionManager encNew(newKey);
-        for (const auto& r : rows) {
-            std::string aadStr = r.service + "\n" + r.username + "\n" + r.created_at;
-            std::vector<std::uint8_t> aad(aadStr.begin(), aadStr.end());
-            auto pt = encOld.decrypt(r.iv, r.enc_password, aad);
-            auto encRes = encNew.encrypt(pt, aad);
-            g_db->updateCredential(r.id, r.username, encRes.encAndTag, encRes.iv, r.notes);
-        }
-        StoredAuth newRec = auth.createMasterRecord(nw);
-        g_db->storeKdfSalt(newSalt);
-        g_db->storeMaster(newRec.salt, newRec.hash);
-        g_db->commit();
-        g_enc = std::make_unique<EncryptionManager>(newKey);
+        g_enc = std::make_unique<EncryptionManager>(std::move(*changed));
         MessageBox(hwnd, L"Master password changed", L"Info", MB_OK);
     } catch (const std::exception& e) {
-        g_db->rollback();
+        // changeMasterPassword already rolled back
+        SetTrayTip(kTrayTip);
         MessageBoxA(hwnd, e.what(), "Error", MB_OK | MB_ICONERROR);
     }
 }
 void OnListAll(HWND hwnd) {
     if (!g_db) return;
     try {
-        auto rows = g_db->getAllCredentials();
-        std::ostringstream oss;
-        for (const auto& r : rows) {
-            oss << r.id << " | " << r.service << " | " << r.username << " | " << r.created_at << "\n";
+        // Newest first, a page per box; OK shows the next page
+        std::optional<ListCursor> cursor;
+        for (;;) {
+            CredentialPage page = g_db->listCredentials(cursor, 30);
+            std::ostringstream oss;
+            for (const auto& r : page.rows) {
+                oss << r.id << " | " << r.service << " | " << r.username << " | " << r.created_at << "\n";
+            }
+            std::string text = oss.str();
+            if (text.empty()) text = cursor ? "(no more credentials)" : "(no credentials)";
+            if (!page.next) {
+                MessageBoxA(hwnd, text.c_str(), "Credentials", MB_OK);
+                break;
+            }
+            text += "\nOK = next page";
+            if (MessageBoxA(hwnd, text.c_str(), "Credentials", MB_OKCANCEL) != IDOK) break;
+            cursor = std::move(page.next);
         }
-        std::string text = oss.str();
-        if (text.empty()) text = "(no credentials)";
-        MessageBoxA(hwnd, text.c_str(), "Credentials", MB_OK);
     } catch (const std::exception& e) {
         MessageBoxA(hwnd, e.what(), "Error", MB_OK | MB_ICONERROR);
     }
@@ -572,7 +592,7 @@ void ShowMainMenu() {
 
         g_menuWnd = CreateWindow(wc.lpszClassName, L"EPM Menu",
             WS_OVERLAPPED | WS_CAPTION | WS_SYSMENU,
-            CW_USEDEFAULT, CW_USEDEFAULT, 300, 350,
+            CW_USEDEFAULT, CW_USEDEFAULT, 300, 390,
             nullptr, nullptr, g_hInst, nullptr);
         if (!g_menuWnd) {
             MessageBox(g_mainWnd, L"Failed to create menu window", L"Error", MB_OK | MB_ICONERROR);
@@ -584,21 +604,22 @@ void ShowMainMenu() {
         SendMessage(g_menuWnd, WM_SETICON, ICON_SMALL, (LPARAM)LoadIcon(g_hInst, MAKEINTRESOURCE(IDI_TRAY)));
 
 
-        const wchar_t* labels[8] = {
+        const wchar_t* labels[9] = {
             L"Add credential",
-            L"Search by service",
+            L"Search",
             L"View (decrypt) by ID",
             L"Update by ID",
             L"Delete by ID",
             L"Generate password",
             L"List all credentials",
-            L"Change master password"
+            L"Change master password",
+            L"Quick find (fuzzy)"
         };
-        const int ids[8] = {
+        const int ids[9] = {
             ID_BTN_ADD, ID_BTN_SEARCH, ID_BTN_VIEW, ID_BTN_UPDATE,
-            ID_BTN_DELETE, ID_BTN_GEN, ID_BTN_LIST, ID_BTN_CHANGE
+            ID_BTN_DELETE, ID_BTN_GEN, ID_BTN_LIST, ID_BTN_CHANGE, ID_BTN_FIND
         };
-        for (int i = 0; i < 8; ++i) {
+        for (int i = 0; i < 9; ++i) {
             CreateWindow(L"BUTTON", labels[i], WS_CHILD | WS_VISIBLE,
                 10, 10 + i * 40, 260, 24, g_menuWnd, (HMENU)ids[i], g_hInst, nullptr);
 
@@ -638,6 +659,9 @@ LRESULT CALLBACK MenuWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         case ID_BTN_CHANGE:
             OnChangeMaster(hwnd);
             break;
+        case ID_BTN_FIND:
+            OnQuickFind(hwnd);
+            break;
         }
         break;
     case WM_CLOSE:
@@ -708,7 +732,7 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int) {
 
     g_nid.hIcon = LoadIcon(hInstance, MAKEINTRESOURCE(IDI_TRAY));
 
-    lstrcpyn(g_nid.szTip, L"EPM (click to unlock)", ARRAYSIZE(g_nid.szTip));
+    lstrcpyn(g_nid.szTip, kTrayTip, ARRAYSIZE(g_nid.szTip));
     Shell_NotifyIcon(NIM_ADD, &g_nid);
 
     MSG msg;
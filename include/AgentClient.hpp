@@ -0,0 +1,49 @@
+#pragma once
+#include "AgentProtocol.hpp"
+#include "DatabaseManager.hpp"
+#include "SecureAllocator.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A credential fetched through the agent; the password stays in secure memory
+struct AgentCredential {
+    CredentialMeta meta;
+    secure_string  password;
+};
+
+// Blocking client for AgentServer, one request at a time. Every call throws
+// std::runtime_error if the agent is unreachable or reports an error, and
+// std::invalid_argument if it rejected the request as malformed.
+class AgentClient {
+public:
+    explicit AgentClient(const std::string& socketPath = agent::defaultSocketPath());
+    ~AgentClient();
+
+    AgentClient(AgentClient&& other) noexcept;
+    AgentClient& operator=(AgentClient&& other) noexcept;
+    AgentClient(const AgentClient&) = delete;
+    AgentClient& operator=(const AgentClient&) = delete;
+
+    void ping();
+    // nullopt if there is no such id
+    std::optional<AgentCredential> get(int id);
+    std::vector<CredentialMeta> search(std::string_view query, std::uint32_t limit = 50);
+    // Returns the new id
+    int add(std::string_view service, std::string_view username,
+            std::string_view password, std::string_view notes = {});
+    // Makes the agent wipe its key and exit
+    void lock();
+
+private:
+    // Sends one request frame and reads the response into m_response.
+    // Returns a reader past the status byte, or nullopt for NotFound;
+    // BadRequest/Error responses are thrown.
+    std::optional<agent::Reader> call(const secure_vector& request);
+
+    int           m_fd = -1;
+    secure_vector m_response;
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include "SecureAllocator.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Wire format between epm_agent and its clients. Every message is a frame:
+//
+//   u32 payload length | payload
+//
+// A request payload is `u8 op` followed by the op's fields; a response is
+// `u8 status` followed by the result (or, for BadRequest/Error, a message
+// string). Integers are little-endian; strings are `u32 length | bytes`.
+//
+//   Ping   ()                                        -> ()
+//   Get    (i32 id)                                  -> (i32 id, str service, str username,
+//                                                        str notes, str created_at, str password)
+//   Search (u32 limit, str query)                    -> (u32 n, n x (i32 id, str service,
+//                                                        str username, str created_at))
+//   Add    (str service, str username, str password, str notes) -> (i32 id)
+//   Lock   ()                                        -> ()   then the agent wipes its key and exits
+//
+// Buffers are secure_vector since requests and responses carry passwords.
+namespace agent {
+    inline constexpr std::uint32_t kMaxFrame = 1u << 20;
+
+    enum class Op : std::uint8_t { Ping = 1, Get = 2, Search = 3, Add = 4, Lock = 5 };
+    enum class Status : std::uint8_t { Ok = 0, NotFound = 1, BadRequest = 2, Error = 3 };
+
+    // Appends one frame to `out`; the length prefix is patched in by finish()
+    class FrameWriter {
+    public:
+        explicit FrameWriter(secure_vector& out);
+        FrameWriter& u8(std::uint8_t v);
+        FrameWriter& u32(std::uint32_t v);
+        FrameWriter& i32(std::int32_t v) { return u32(static_cast<std::uint32_t>(v)); }
+        FrameWriter& str(std::string_view s);
+        // Throws std::length_error if the payload exceeds kMaxFrame
+        void finish();
+
+    private:
+        secure_vector& m_out;
+        std::size_t m_start;
+    };
+
+    // Reads fields from one payload; throws std::invalid_argument when
+    // the payload is shorter than the fields asked for
+    class Reader {
+    public:
+        explicit Reader(std::span<const std::uint8_t> payload) : m_p(payload) {}
+        std::uint8_t  u8();
+        std::uint32_t u32();
+        std::int32_t  i32() { return static_cast<std::int32_t>(u32()); }
+        std::string_view str();
+        bool done() const { return m_pos == m_p.size(); }
+        std::size_t remaining() const { return m_p.size() - m_pos; }
+
+    private:
+        std::span<const std::uint8_t> take(std::size_t n);
+        std::span<const std::uint8_t> m_p;
+        std::size_t m_pos = 0;
+    };
+
+    // Payload length from a frame's 4-byte prefix. Throws std::length_error
+    // for a frame larger than kMaxFrame.
+    std::uint32_t frameLength(std::span<const std::uint8_t, 4> prefix);
+
+    // Payload length of the frame at the start of `buf`, or nullopt until
+    // the length prefix and the whole payload have arrived. Throws
+    // std::length_error for a frame larger than kMaxFrame.
+    std::optional<std::uint32_t> completeFrame(std::span<const std::uint8_t> buf);
+
+    // $EPM_AGENT_SOCK, else $XDG_RUNTIME_DIR/epm-agent.sock, else
+    // /tmp/epm-agent-<uid>/agent.sock
+    std::string defaultSocketPath();
+}
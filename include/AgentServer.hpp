@@ -0,0 +1,85 @@
+#pragma once
+#include "AgentProtocol.hpp"
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Unlocked-vault agent (Linux): holds the session key so scripted lookups
+// skip Argon2id, and serves the AgentProtocol.hpp ops on a Unix socket.
+//
+// One thread, one epoll loop, non-blocking sockets: requests are answered
+// in the order each client sent them, and a client never waits on another
+// one's I/O. Adds that arrive together (one epoll wakeup) are inserted in
+// a single transaction. The socket is created 0600 (and its directory 0700
+// if missing); connections from any other uid are refused (SO_PEERCRED).
+//
+// The key is wiped when run() returns: after stop(), a Lock request, or
+// `idleTimeout` without requests.
+class AgentServer {
+public:
+    struct Options {
+        std::string socketPath = agent::defaultSocketPath();
+        std::chrono::seconds idleTimeout{900}; // 0 = never
+        std::size_t maxClients = 1024;         // further connections are closed at once
+    };
+
+    enum class StopReason { Stopped, Locked, IdleTimeout };
+
+    // Binds the socket (replacing a stale one); throws std::runtime_error if
+    // another agent is already listening on it
+    AgentServer(DatabaseManager& db, EncryptionManager enc, Options options);
+    ~AgentServer();
+
+    AgentServer(const AgentServer&) = delete;
+    AgentServer& operator=(const AgentServer&) = delete;
+
+    // Serve until stopped; then close every client and remove the socket
+    StopReason run();
+    // Thread-safe; run() returns shortly after
+    void stop() noexcept;
+
+    const std::string& socketPath() const { return m_options.socketPath; }
+
+private:
+    struct Connection {
+        secure_vector in;
+        secure_vector out;
+        std::size_t   outPos    = 0;
+        std::uint32_t events    = 0;     // epoll interest currently registered
+        bool          addQueued = false; // waiting for commitAdds()
+        bool          closing   = false; // peer is done sending; close once flushed
+    };
+
+    struct PendingAdd {
+        int           fd;
+        NewCredential row;
+    };
+
+    void acceptClients();
+    bool readFrom(int fd, Connection& c);      // false: socket error
+    bool processFrames(int fd, Connection& c); // true: frames left behind a queued Add
+    void handle(agent::Reader req, int fd, Connection& c);
+    void commitAdds();
+    bool flushOut(int fd, Connection& c);      // false: close the client now
+    void watch(int fd, Connection& c);         // sync epoll interest with c's state
+    void closeClient(int fd);
+    void teardown() noexcept;
+
+    DatabaseManager&                    m_db;
+    std::optional<EncryptionManager>    m_enc;
+    Options                             m_options;
+    int                                 m_listenFd = -1;
+    int                                 m_epollFd  = -1;
+    int                                 m_stopFd   = -1; // eventfd
+    bool                                m_bound    = false; // socket file is ours to remove
+    bool                                m_locked   = false;
+    std::unordered_map<int, Connection> m_clients;
+    std::vector<PendingAdd>             m_adds;
+};
@@ -1,6 +1,6 @@
 #pragma once
 #include <vector>
-#include <string>
+#include <string_view>
 #include <cstdint>
 
 struct StoredAuth {
@@ -13,10 +13,10 @@ public:
     // Create new master record from plaintext password:
     // - generates 16B salt
     // - Argon2id with t=3, m≈64 MiB, p=1 -> 32B hash
-    StoredAuth createMasterRecord(const std::string& masterPassword) const;
+    StoredAuth createMasterRecord(std::string_view masterPassword) const;
 
     // Verify password against stored {salt, hash}
-    bool verifyMasterPassword(const std::string& masterPassword,
+    bool verifyMasterPassword(std::string_view masterPassword,
                               const StoredAuth& stored) const;
 
 private:
@@ -0,0 +1,63 @@
+#pragma once
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "SecureAllocator.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Line-delimited JSON command processor behind `epm --batch`. One object per
+// input line, one result object per output line, in input order:
+//
+//   {"op":"add","service":"github","username":"octocat","password":"...","notes":"..."}
+//   {"op":"get","id":42}
+//   {"op":"search","query":"git","limit":10}
+//   {"op":"update","id":42,"password":"..."}      (username/notes optional too)
+//   {"op":"delete","id":42}
+//   {"op":"generate","length":24,"symbols":false}
+//
+// Results are {"ok":true,...} or {"ok":false,"error":"..."}; a "tag" on the
+// command is echoed back. Writes are pipelined: they join one open
+// transaction until the input runs dry (nothing buffered to read) or
+// maxPendingWrites is reached, and their results are only written after the
+// commit succeeds. If the commit fails, every command that ran inside that
+// transaction reports the error: the writes, and any get/search after them,
+// since those may have returned rows that were rolled back.
+class BatchRunner {
+public:
+    struct Options {
+        std::size_t maxPendingWrites = 1000; // writes per transaction, at most
+    };
+
+    BatchRunner(DatabaseManager& db, const EncryptionManager& enc)
+        : BatchRunner(db, enc, Options{}) {}
+    BatchRunner(DatabaseManager& db, const EncryptionManager& enc, Options options);
+
+    // Process commands until EOF. Returns the number of failed commands.
+    std::size_t run(std::istream& in, std::ostream& out);
+
+    std::size_t transactionsCommitted() const { return m_commits; }
+
+private:
+    struct Result {
+        secure_string json;  // full result line, no newline; a get's carries the password
+        std::string tagJson; // echoed tag ("" if none), for rewriting on commit failure
+        bool write = false;
+        bool inTransaction = false; // ran in the open transaction: fails with its commit
+        bool ok = false;
+    };
+
+    Result execute(std::string_view line);
+    void flush(std::ostream& out);
+
+    DatabaseManager&         m_db;
+    const EncryptionManager& m_enc;
+    Options                  m_options;
+    std::vector<Result>      m_pending;
+    std::size_t              m_pendingWrites = 0;
+    std::size_t              m_failures = 0;
+    std::size_t              m_commits = 0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include "EncryptionManager.hpp"
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// AAD bound into every credential ciphertext: service \n username \n created_at.
+// Changing any of the three (or the format) makes the tag check fail.
+inline void makeCredentialAad(std::vector<std::uint8_t>& out,
+                              std::string_view service,
+                              std::string_view username,
+                              std::string_view createdAt) {
+    out.clear();
+    out.reserve(service.size() + username.size() + createdAt.size() + 2);
+    out.insert(out.end(), service.begin(), service.end());
+    out.push_back('\n');
+    out.insert(out.end(), username.begin(), username.end());
+    out.push_back('\n');
+    out.insert(out.end(), createdAt.begin(), createdAt.end());
+}
+
+inline std::vector<std::uint8_t> makeCredentialAad(std::string_view service,
+                                                   std::string_view username,
+                                                   std::string_view createdAt) {
+    std::vector<std::uint8_t> out;
+    makeCredentialAad(out, service, username, createdAt);
+    return out;
+}
+
+// created_at format: ISO-8601 UTC to the second, "2025-01-02T03:04:05Z". It
+// is part of the AAD, so every writer stamps rows with these two.
+inline std::string iso8601Utc(std::time_t t) {
+    std::tm tm{};
+#if defined(_WIN32)
+    gmtime_s(&tm, &t);
+#else
+    gmtime_r(&t, &tm);
+#endif
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    return buf;
+}
+
+inline std::string iso8601UtcNow() { return iso8601Utc(std::time(nullptr)); }
+
+// Seal `secret` for a row holding (service, username, createdAt): a fresh
+// IV into `iv`, ciphertext||tag into `sealed`. Stamp createdAt once before
+// calling and store exactly that string with the row. `aad` is scratch, so
+// bulk writers can reuse one buffer.
+inline void sealCredential(const EncryptionManager& enc, std::string_view secret,
+                           std::string_view service, std::string_view username,
+                           std::string_view createdAt,
+                           std::vector<std::uint8_t>& iv, std::vector<std::uint8_t>& sealed,
+                           std::vector<std::uint8_t>& aad) {
+    makeCredentialAad(aad, service, username, createdAt);
+    iv.resize(EncryptionManager::kIvLen);
+    sealed.resize(EncryptionManager::sealedSize(secret.size()));
+    enc.encrypt(asBytes(secret), aad, iv, sealed);
+}
+
+inline void sealCredential(const EncryptionManager& enc, std::string_view secret,
+                           std::string_view service, std::string_view username,
+                           std::string_view createdAt,
+                           std::vector<std::uint8_t>& iv, std::vector<std::uint8_t>& sealed) {
+    std::vector<std::uint8_t> aad;
+    sealCredential(enc, secret, service, username, createdAt, iv, sealed, aad);
+}
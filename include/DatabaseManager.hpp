@@ -1,11 +1,18 @@
 #pragma once
+#include "KdfParams.hpp"
+
 #include <string>
 #include <vector>
 #include <optional>
+#include <array>
+#include <span>
+#include <string_view>
+#include <functional>
 #include <cstdint>
 
 // Forward-declare sqlite3 so consumers of this header don't need sqlite3.h
 struct sqlite3;
+struct sqlite3_stmt;
 
 // Full credential row used by most CRUD APIs
 struct Credential {
@@ -29,24 +36,149 @@ struct CredentialRow {
     std::string notes; // include notes so we can preserve them on update
 };
 
+// Zero-copy view of the current row in a forEach* scan. All views point into
+// SQLite's column buffers and are only valid inside the visitor call.
+struct CredentialView {
+    int id;
+    std::string_view service;
+    std::string_view username;
+    std::span<const std::uint8_t> enc_password;
+    std::span<const std::uint8_t> iv;
+    std::string_view notes;
+    std::string_view created_at;
+};
+
+using CredentialVisitor = std::function<void(const CredentialView&)>;
+
+// Connection tuning applied by the DatabaseManager constructor.
+// Use one of the presets and override single fields as needed.
+struct DatabaseOptions {
+    enum class JournalMode { Delete, Truncate, Persist, Memory, Wal, Off };
+    enum class Synchronous { Off, Normal, Full, Extra };
+    enum class TempStore   { Default, File, Memory };
+
+    JournalMode   journalMode   = JournalMode::Wal;
+    Synchronous   synchronous   = Synchronous::Full;
+    int           cacheSizeKiB  = 2000;    // page cache budget (PRAGMA cache_size = -N)
+    std::int64_t  mmapSizeBytes = 0;       // 0 = no memory-mapped I/O
+    TempStore     tempStore     = TempStore::Default;
+    int           busyTimeoutMs = 5000;    // wait this long on a locked DB
+
+    // WAL + synchronous=FULL: every commit is on disk before it returns
+    static DatabaseOptions durable();
+    // WAL + synchronous=NORMAL, larger cache, mmap, temp tables in RAM.
+    // Never corrupts, but the last commits may roll back on power loss.
+    static DatabaseOptions fast();
+};
+
+// Input row for bulk inserts (e.g., CSV import). created_at is part of the
+// AAD callers encrypt with, so it is chosen up front; empty = now (UTC).
+struct NewCredential {
+    std::string service;
+    std::string username;
+    std::vector<std::uint8_t> enc_password;
+    std::vector<std::uint8_t> iv;
+    std::string notes;
+    std::string created_at;
+};
+
+// New ciphertext/IV for an existing row (batched re-encryption)
+struct SecretUpdate {
+    int id;
+    std::vector<std::uint8_t> enc_password;
+    std::vector<std::uint8_t> iv;
+};
+
+// Columns searchCredentials() matches against (bitmask)
+enum SearchField : unsigned {
+    kSearchService  = 1u << 0,
+    kSearchUsername = 1u << 1,
+    kSearchNotes    = 1u << 2,
+    kSearchAll      = kSearchService | kSearchUsername | kSearchNotes,
+};
+
+// Search hit: metadata only, no ciphertext
+struct CredentialMeta {
+    int id;
+    std::string service;
+    std::string username;
+    std::string notes;
+    std::string created_at;
+};
+
+// Optional columns listCredentials() fills (bitmask); id and created_at
+// always come back. Service/username are read from a covering index;
+// notes cost a lookup into the table row.
+enum ListColumn : unsigned {
+    kListService  = 1u << 0,
+    kListUsername = 1u << 1,
+    kListNotes    = 1u << 2,
+    kListBrief    = kListService | kListUsername,
+};
+
+// Keyset position: the last row of the previous page
+struct ListCursor {
+    std::string created_at;
+    int id = 0;
+};
+
+// One page of listCredentials(), newest first
+struct CredentialPage {
+    std::vector<CredentialMeta> rows;
+    std::optional<ListCursor> next; // pass back for the following page; nullopt at the end
+};
+
+// Receives metadata changes made through one DatabaseManager (e.g. to keep
+// an in-memory index current). Changes inside a transaction are delivered
+// after commit() and dropped on rollback(); outside one, right away.
+class CredentialObserver {
+public:
+    virtual ~CredentialObserver() = default;
+    // Row added, or its username/created_at changed
+    virtual void credentialUpserted(int id, std::string_view service,
+                                    std::string_view username,
+                                    std::string_view createdAt) = 0;
+    virtual void credentialErased(int id) = 0;
+};
+
+// Prepared-statement cache counters (per connection)
+struct StmtCacheStats {
+    std::uint64_t hits   = 0; // statement reused from the cache
+    std::uint64_t misses = 0; // statement compiled with sqlite3_prepare_v3
+};
+
 class DatabaseManager {
 public:
-    explicit DatabaseManager(const std::string& dbPath);
+    explicit DatabaseManager(const std::string& dbPath,
+                             const DatabaseOptions& options = DatabaseOptions::durable());
     ~DatabaseManager();
 
+    // Owns a connection and cached statements; not copyable
+    DatabaseManager(const DatabaseManager&) = delete;
+    DatabaseManager& operator=(const DatabaseManager&) = delete;
+
     // Create tables if not present
     void init();
 
     // ---- Master auth (id=1)
+    // `scheme` records how salt/hash were produced (see VaultUnlock.hpp);
+    // rows written before the column existed read back as scheme 1.
     void storeMaster(const std::vector<std::uint8_t>& salt,
-                     const std::vector<std::uint8_t>& hash);
+                     const std::vector<std::uint8_t>& hash,
+                     int scheme = 1);
     // returns {salt, hash} or nullopt
     std::optional<std::pair<std::vector<std::uint8_t>, std::vector<std::uint8_t>>>
     loadMaster() const;
+    // returns the stored scheme or nullopt if there is no master record
+    std::optional<int> loadMasterScheme() const;
 
     // ---- App settings (KDF salt at id=1)
     void storeKdfSalt(const std::vector<std::uint8_t>& kdfSalt);
     std::optional<std::vector<std::uint8_t>> loadKdfSalt() const;
+    // Argon2id costs next to the salt; store the salt first.
+    // Rows from before the columns existed read back as KdfParams{}.
+    void storeKdfParams(const KdfParams& params);
+    std::optional<KdfParams> loadKdfParams() const;
 
     // ---- Credentials CRUD
     int addCredential(const std::string& service,
@@ -55,7 +187,20 @@ public:
                       const std::vector<std::uint8_t>& iv,
                       const std::string& notes);
 
+    // Bulk insert reusing one prepared statement. Commits every `batchSize`
+    // rows (BEGIN IMMEDIATE ... COMMIT); if a transaction is already open the
+    // rows join it instead. Returns the new ids in input order.
+    static constexpr std::size_t kDefaultBatchSize = 5000;
+    std::vector<int> addCredentials(std::span<const NewCredential> rows,
+                                    std::size_t batchSize = kDefaultBatchSize);
+
     std::optional<Credential> getCredentialById(int id) const;
+    // Metadata only (no ciphertext copied); nullopt if there is no such id
+    std::optional<CredentialMeta> getCredentialMeta(int id) const;
+    // Zero-copy read of the columns needed to decrypt one row (service,
+    // username, created_at, ciphertext, IV; notes are left empty). Returns
+    // false if there is no such id. Views die with the visitor call.
+    bool readSecret(int id, const CredentialVisitor& visit) const;
     std::vector<Credential>   searchByService(const std::string& query) const;
     void updateCredential(int id,
                           const std::string& newUsername,
@@ -64,19 +209,172 @@ public:
                           const std::string& newNotes);
     void deleteCredential(int id);
 
+    // Rewrite only encrypted_password/iv for many rows with one statement.
+    // Joins the caller's transaction if open, otherwise runs in its own.
+    void updateSecrets(std::span<const SecretUpdate> updates);
+
+    std::size_t countCredentials() const;
+
+    // ---- Streaming scans (constant memory; one row alive at a time)
+    // Visit rows with id > afterId in ascending id order, at most `limit`
+    // rows (-1 = no limit). Returns the number of rows visited. Use the last
+    // visited id as the next afterId to page through the table.
+    // Don't start the same scan again from inside the visitor.
+    std::size_t forEachCredential(const CredentialVisitor& visit,
+                                  int afterId = 0, int limit = -1) const;
+    // Visit service-substring matches, newest first (like searchByService)
+    std::size_t forEachByService(const std::string& query,
+                                 const CredentialVisitor& visit) const;
+
+    // ---- Paged listing (metadata only, never ciphertext)
+    // Up to `limit` rows ordered by (created_at, id) descending, starting
+    // after `after` (nullopt = newest). Keyset paging: every page costs
+    // O(limit) no matter how deep, and rows added meanwhile don't shift it.
+    CredentialPage listCredentials(const std::optional<ListCursor>& after = std::nullopt,
+                                   int limit = 50,
+                                   unsigned columns = kListBrief) const;
+
+    // ---- Search
+    // Case-insensitive substring match over the selected fields, best first
+    // (service hits outrank username hits, which outrank notes hits), at most
+    // `limit` rows (-1 = no limit). Queries of 3+ characters use the FTS5
+    // trigram index; shorter ones (or builds without FTS5) scan with LIKE.
+    std::vector<CredentialMeta> searchCredentials(const std::string& query,
+                                                  unsigned fields = kSearchAll,
+                                                  int limit = 50) const;
+    // True if the trigram index exists on this connection
+    bool hasFullTextIndex() const { return m_hasFts; }
+    // Bulk loads: stop indexing inserts until resumeFullTextIndex(), which
+    // indexes every row added meanwhile in one statement. Searches miss
+    // those rows until then, even after they are updated; deleting them is
+    // safe. If resume never runs, a mark left in the vault makes the next
+    // init() index them.
+    void deferFullTextIndex();
+    void resumeFullTextIndex();
+
     // ---- Bulk / maintenance & transactions
     std::vector<CredentialRow> getAllCredentials() const;
     void beginTransaction();
     void commit();
     void rollback();
+    bool inTransaction() const;
+    // PRAGMA quick_check: page/record/index-level damage in the file.
+    // Returns SQLite's problem lines; empty means the file is sound.
+    std::vector<std::string> quickCheck() const;
+
+    // ---- Change notification
+    // Not owned; nullptr detaches. Detach before the observer is destroyed.
+    void setObserver(CredentialObserver* observer);
+
+    // ---- Statement cache diagnostics
+    StmtCacheStats stmtCacheStats() const;
 
     // ---- Test-only helper
     void test_updateCreatedAt(int id, const std::string& createdAt);
+    // Value of `PRAGMA <name>` on this connection, as text
+    std::string test_pragma(const std::string& name) const;
 
 private:
+    // Keys for the prepared-statement cache (one slot per SQL statement)
+    enum class StmtId : std::size_t {
+        StoreMaster,
+        LoadMaster,
+        LoadMasterScheme,
+        StoreKdfSalt,
+        LoadKdfSalt,
+        StoreKdfParams,
+        LoadKdfParams,
+        AddCredential,
+        GetCredentialById,
+        GetCredentialMeta,
+        ReadSecret,
+        SearchByService,
+        SearchByServiceFts,
+        UpdateCredential,
+        DeleteCredential,
+        UpdateCreatedAt,
+        GetAllCredentials,
+        ForEachCredential,
+        ForEachByService,
+        ForEachByServiceFts,
+        SearchFts,
+        SearchLike,
+        IndexFullText,
+        UpdateSecret,
+        CountCredentials,
+        MarkFtsDeferred,
+        ListFirst,
+        ListAfter,
+        ListFirstNotes,
+        ListAfterNotes,
+        Count
+    };
+
     std::string m_dbPath;
     sqlite3*    m_db = nullptr; // persistent DB connection
 
+    // Statements are compiled once per connection, reset after each use
+    // and finalized in the destructor.
+    mutable std::array<sqlite3_stmt*, static_cast<std::size_t>(StmtId::Count)> m_stmts{};
+    mutable StmtCacheStats m_stmtStats;
+
+    bool m_hasFts = false;      // credentials_fts is available and kept in sync
+    bool m_ftsDeferred = false; // inserts are left for resumeFullTextIndex()
+    int  m_ftsDeferredAfter = 0; // highest id before deferFullTextIndex()
+
+    // Observer and the changes held back until the open transaction commits
+    struct PendingChange {
+        int id;
+        bool erased;
+        std::string service, username, createdAt;
+    };
+    CredentialObserver*        m_observer = nullptr;
+    std::vector<PendingChange> m_pending;
+
+    // Fetch (or prepare and cache) the statement for `id`; StmtReset puts it
+    // back (both defined in the .cpp)
+    struct StmtHandle;
+    class StmtReset;
+    StmtHandle cachedStmt(StmtId id, const char* sql) const;
+
+    // Bind + step one row on the insert statement; returns the new id
+    int insertCredential(sqlite3_stmt* stmt,
+                         const std::string& service,
+                         const std::string& username,
+                         const std::vector<std::uint8_t>& encPassword,
+                         const std::vector<std::uint8_t>& iv,
+                         const std::string& notes,
+                         const std::string& createdAt);
+
     // helper to run raw SQL without parameters on m_db
     void exec(const std::string& sql) const;
+
+    // ALTER TABLE ... ADD COLUMN unless the column is already there
+    void ensureColumn(const char* table, const char* column, const char* decl);
+
+    // Create (and on first creation, fill) the FTS5 trigram index and its
+    // sync triggers. Returns false if this SQLite lacks FTS5/trigram.
+    bool initFullTextIndex();
+    // Add rows [firstId, lastId] to the trigram index (inserts only)
+    void indexFullText(int firstId, int lastId);
+    // Record in the vault that rows above m_ftsDeferredAfter may be
+    // unindexed. Written with every deferred insert, so the mark survives
+    // an init() on another connection clearing it mid-load.
+    void markFtsDeferred();
+    // Whether `query` can go through the trigram index
+    bool useFullText(const std::string& query) const;
+
+    // Deliver (or queue, inside a transaction) one change to m_observer
+    void notifyUpsert(int id, const std::string& service, const std::string& username,
+                      const std::string& createdAt);
+    void notifyErase(int id);
+    // Re-read the row's metadata and report it (after an UPDATE that may change it)
+    void notifyReload(int id);
+
+    // step `stmt` to completion, handing each row to `visit`
+    std::size_t visitRows(sqlite3_stmt* stmt, const CredentialVisitor& visit,
+                          const char* what) const;
+
+    // apply journal/sync/cache pragmas from the constructor
+    void applyOptions(const DatabaseOptions& options);
 };
@@ -1,20 +1,41 @@
 #pragma once
+#include "KdfParams.hpp"
+#include "SecureAllocator.hpp"
+
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <span>
+#include <memory>
+
+// View a string's bytes without copying (plaintexts, AAD pieces)
+inline std::span<const std::uint8_t> asBytes(std::string_view s) {
+    return { reinterpret_cast<const std::uint8_t*>(s.data()), s.size() };
+}
 
 // Handles key derivation (Argon2id) and AES-256-GCM encrypt/decrypt.
 // Keep the derived key only in RAM for the session.
 class EncryptionManager {
 public:
     // Derive a 32-byte key from master password and 16-byte salt (Argon2id).
-    static std::vector<std::uint8_t> deriveKey(
-        const std::string& masterPassword,
-        const std::vector<std::uint8_t>& kdfSalt
+    // Lanes run on parallelism threads; the default params match old vaults.
+    // The key is returned in locked, zeroize-on-free memory.
+    static secure_vector deriveKey(
+        std::string_view masterPassword,
+        std::span<const std::uint8_t> kdfSalt,
+        const KdfParams& params = {}
     );
 
-    // Construct with 32-byte key (K_enc).
-    explicit EncryptionManager(const std::vector<std::uint8_t>& key);
+    // Construct with 32-byte key (K_enc); the copy lives in secure memory.
+    explicit EncryptionManager(std::span<const std::uint8_t> key);
+    ~EncryptionManager();
+
+    // Owns keyed cipher contexts; movable but not copyable
+    EncryptionManager(EncryptionManager&&) noexcept;
+    EncryptionManager& operator=(EncryptionManager&&) noexcept;
+    EncryptionManager(const EncryptionManager&) = delete;
+    EncryptionManager& operator=(const EncryptionManager&) = delete;
 
     struct EncResult {
         std::vector<std::uint8_t> iv;         // 12-byte random IV
@@ -22,22 +43,91 @@ public:
     };
 
     // Optional AAD lets you bind extra metadata; can be empty.
-    EncResult encrypt(const std::vector<std::uint8_t>& plaintext,
-                      const std::vector<std::uint8_t>& aad = {}) const;
+    EncResult encrypt(std::span<const std::uint8_t> plaintext,
+                      std::span<const std::uint8_t> aad = {}) const;
 
+    // Plaintext comes back in secure memory (pooled, so no mmap per call).
     // Throws std::runtime_error on tag verification failure or API error.
-    std::vector<std::uint8_t> decrypt(const std::vector<std::uint8_t>& iv,
-                                      const std::vector<std::uint8_t>& encAndTag,
-                                      const std::vector<std::uint8_t>& aad = {}) const;
+    secure_vector decrypt(std::span<const std::uint8_t> iv,
+                          std::span<const std::uint8_t> encAndTag,
+                          std::span<const std::uint8_t> aad = {}) const;
+
+    // ---- Allocation-free API: caller owns every buffer ----
+    static constexpr std::size_t kIvLen  = 12;
+    static constexpr std::size_t kTagLen = 16;
+    // ciphertext||tag size for a plaintext of n bytes
+    static constexpr std::size_t sealedSize(std::size_t n) { return n + kTagLen; }
+
+    // Writes a fresh random IV to ivOut (exactly 12 bytes) and ciphertext||tag
+    // to encAndTagOut (at least sealedSize(plaintext.size())). Returns the
+    // number of bytes written to encAndTagOut.
+    std::size_t encrypt(std::span<const std::uint8_t> plaintext,
+                        std::span<const std::uint8_t> aad,
+                        std::span<std::uint8_t> ivOut,
+                        std::span<std::uint8_t> encAndTagOut) const;
+
+    // Decrypts into plaintextOut (at least encAndTag.size() - 16 bytes) and
+    // returns the plaintext length. On tag failure the output is wiped and
+    // std::runtime_error is thrown.
+    std::size_t decrypt(std::span<const std::uint8_t> iv,
+                        std::span<const std::uint8_t> encAndTag,
+                        std::span<const std::uint8_t> aad,
+                        std::span<std::uint8_t> plaintextOut) const;
+
+    // ---- Batch API for many small records ----
+    // One context lease and one RAND_bytes call per batch; all output goes
+    // into a single arena. Pass the same result object again to reuse its
+    // capacity.
+
+    struct SealedBatch {
+        std::vector<std::uint8_t> ivs;     // record i's IV at [i*12, i*12+12)
+        std::vector<std::uint8_t> arena;   // ciphertext||tag records back to back
+        std::vector<std::size_t>  offsets; // size()+1 entries into arena
+
+        std::size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+        std::span<const std::uint8_t> iv(std::size_t i) const {
+            return { ivs.data() + i * kIvLen, kIvLen };
+        }
+        std::span<const std::uint8_t> sealed(std::size_t i) const {
+            return { arena.data() + offsets[i], offsets[i + 1] - offsets[i] };
+        }
+    };
+
+    // Plaintext arena lives in secure memory: wiped on reuse and when freed.
+    struct OpenedBatch {
+        secure_vector             arena;
+        std::vector<std::size_t>  offsets;
+        std::vector<std::uint8_t> ok;      // 1 if record i verified
+
+        std::size_t size() const { return ok.size(); }
+        std::span<const std::uint8_t> plaintext(std::size_t i) const {
+            return { arena.data() + offsets[i], offsets[i + 1] - offsets[i] };
+        }
+        void wipe();
+    };
+
+    // aads may be empty (no AAD) or hold one entry per plaintext.
+    void encryptBatch(std::span<const std::span<const std::uint8_t>> plaintexts,
+                      std::span<const std::span<const std::uint8_t>> aads,
+                      SealedBatch& out) const;
+
+    // Per-record failures (bad tag, malformed IV/input) do not throw: ok[i]
+    // stays 0 and that record's plaintext is empty. Returns the failure count.
+    std::size_t decryptBatch(std::span<const std::span<const std::uint8_t>> ivs,
+                             std::span<const std::span<const std::uint8_t>> encAndTags,
+                             std::span<const std::span<const std::uint8_t>> aads,
+                             OpenedBatch& out) const;
 
 private:
-    std::vector<std::uint8_t> m_key;
+    // Pre-keyed AES-256-GCM contexts, reused across calls and threads so the
+    // key schedule is expanded once per context instead of once per call.
+    struct CtxPool;
+    class CtxLease;
 
-    static constexpr std::size_t KEY_LEN = 32;
-    static constexpr std::size_t IV_LEN  = 12;
-    static constexpr std::size_t TAG_LEN = 16;
+    secure_vector            m_key;
+    std::unique_ptr<CtxPool> m_pool;
 
-    static constexpr uint32_t T_COST = 3;               // iterations
-    static constexpr uint32_t M_COST_KiB = 64 * 1024;   // memory (~64 MiB)
-    static constexpr uint32_t PARALLELISM = 1;          // lanes
+    static constexpr std::size_t KEY_LEN = 32;
+    static constexpr std::size_t IV_LEN  = kIvLen;
+    static constexpr std::size_t TAG_LEN = kTagLen;
 };
@@ -0,0 +1,104 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Per-operation latency histograms for the hot paths (KDF, AES-GCM, each
+// cached SQLite statement, transactions). Recording is lock-free: a few
+// relaxed atomic adds per sample. Build with -DEPM_INSTRUMENTATION=OFF to
+// compile the timers out entirely; the histogram types stay available.
+#ifndef EPM_INSTRUMENTATION
+#define EPM_INSTRUMENTATION 1
+#endif
+
+namespace instrumentation {
+    inline constexpr bool kEnabled = EPM_INSTRUMENTATION != 0;
+
+    // HDR-style log-linear histogram of nanosecond values: 16 linear
+    // sub-buckets per power of two, so any reported percentile is within
+    // 1/16 (6.25%) of the true value. Values past ~18 min are clamped.
+    class Histogram {
+    public:
+        static constexpr unsigned    kSubBits    = 4;
+        static constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBits;
+        static constexpr unsigned    kMaxBits    = 40; // 2^40 ns ~ 18 min
+        static constexpr std::size_t kBuckets    = kSubBuckets * (kMaxBits - kSubBits + 1);
+
+        explicit Histogram(std::string name) : m_name(std::move(name)) {}
+        Histogram(const Histogram&) = delete;
+        Histogram& operator=(const Histogram&) = delete;
+
+        void record(std::uint64_t ns) noexcept;
+        void reset() noexcept;
+
+        const std::string& name() const { return m_name; }
+        std::uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+        // Smallest bucket upper bound covering fraction q (0..1) of samples
+        std::uint64_t percentile(double q) const;
+
+        // Bucket mapping, exposed for tests
+        static std::size_t bucketOf(std::uint64_t ns) noexcept;
+        static std::uint64_t bucketUpperBound(std::size_t bucket) noexcept;
+
+        struct Summary {
+            std::string   name;
+            std::uint64_t count = 0, totalNs = 0, maxNs = 0;
+            std::uint64_t p50Ns = 0, p90Ns = 0, p99Ns = 0;
+        };
+        Summary summary() const;
+
+    private:
+        std::string m_name;
+        std::array<std::atomic<std::uint64_t>, kBuckets> m_buckets{};
+        std::atomic<std::uint64_t> m_count{0}, m_totalNs{0}, m_maxNs{0};
+    };
+
+    // Process-wide histogram for `name`, created on first use. The reference
+    // stays valid for the life of the process; cache it in a static.
+    Histogram& histogram(std::string_view name);
+
+    // Every histogram with samples, most total time first
+    std::vector<Histogram::Summary> snapshot();
+    void resetAll();
+
+    // Human-readable table of snapshot()
+    void dump(std::ostream& out);
+
+    // Records the lifetime of the scope into `h`
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram& h) noexcept
+            : m_h(h), m_start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            m_h.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - m_start).count()));
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Histogram& m_h;
+        std::chrono::steady_clock::time_point m_start;
+    };
+}
+
+#define EPM_INSTR_CAT2(a, b) a##b
+#define EPM_INSTR_CAT(a, b) EPM_INSTR_CAT2(a, b)
+
+// Times the rest of the enclosing scope under `name` (a string literal)
+#if EPM_INSTRUMENTATION
+#define EPM_TIMED(name)                                                            \
+    static ::instrumentation::Histogram& EPM_INSTR_CAT(epm_hist_, __LINE__) =      \
+        ::instrumentation::histogram(name);                                        \
+    ::instrumentation::ScopedTimer EPM_INSTR_CAT(epm_timer_, __LINE__)(            \
+        EPM_INSTR_CAT(epm_hist_, __LINE__))
+#else
+#define EPM_TIMED(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+#include "SecureAllocator.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+// Minimal JSON for line-oriented protocols (epm --batch, JSONL dumps):
+// one flat object per line. Values are null, booleans, numbers and strings;
+// nested objects and arrays are rejected on input and written raw on output.
+namespace json {
+    using Value  = std::variant<std::nullptr_t, bool, double, std::string>;
+    using Object = std::map<std::string, Value, std::less<>>;
+
+    // Throws std::invalid_argument with the byte offset on malformed input.
+    // On failure every string parsed so far is wiped before it is freed.
+    Object parseObject(std::string_view text);
+    // Zero every string value in place (call before a map holding a secret
+    // is freed)
+    void wipeValues(Object& obj);
+
+    // Typed lookups; nullopt if the key is absent or null. A present value
+    // of the wrong type throws std::invalid_argument naming the key.
+    std::optional<std::string_view> getString(const Object& obj, std::string_view key);
+    std::optional<std::int64_t>     getInt(const Object& obj, std::string_view key);
+    std::optional<bool>             getBool(const Object& obj, std::string_view key);
+
+    // Append `s` as a quoted JSON string (UTF-8 passed through)
+    void appendString(std::string& out, std::string_view s);
+    void appendString(secure_string& out, std::string_view s);
+    // Append any Value in JSON form
+    void appendValue(std::string& out, const Value& v);
+    void appendValue(secure_string& out, const Value& v);
+
+    // Builds one object into `out`. Separate names per type, so a string
+    // literal can never pick the bool overload. Instantiated for std::string
+    // and, for objects that carry a password, secure_string.
+    template <class Out>
+    class BasicObjectWriter {
+    public:
+        explicit BasicObjectWriter(Out& out) : m_out(out) { m_out += '{'; }
+        BasicObjectWriter& str(std::string_view key, std::string_view value);
+        BasicObjectWriter& num(std::string_view key, std::int64_t value);
+        BasicObjectWriter& boolean(std::string_view key, bool value);
+        BasicObjectWriter& value(std::string_view key, const Value& value);
+        // `json` must already be valid JSON (an array or object)
+        BasicObjectWriter& raw(std::string_view key, std::string_view json);
+        void close() { m_out += '}'; }
+
+    private:
+        void key(std::string_view k);
+        Out& m_out;
+        bool m_first = true;
+    };
+    using ObjectWriter       = BasicObjectWriter<std::string>;
+    using SecureObjectWriter = BasicObjectWriter<secure_string>;
+}
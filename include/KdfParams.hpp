@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+
+// Argon2id cost parameters, persisted per vault in app_settings.
+// Defaults are the values every vault used before they were stored.
+struct KdfParams {
+    std::uint32_t tCost       = 3;          // iterations
+    std::uint32_t mCostKiB    = 64 * 1024;  // memory (~64 MiB)
+    std::uint32_t parallelism = 1;          // lanes (and threads)
+
+    // Bounds accepted from the DB or the user. Keeps a tampered vault from
+    // asking for absurd memory or time before the password is even checked.
+    static constexpr std::uint32_t kMaxTCost       = 64;
+    static constexpr std::uint32_t kMaxMCostKiB    = 4u * 1024 * 1024; // 4 GiB
+    static constexpr std::uint32_t kMaxParallelism = 64;
+
+    void validate() const {
+        if (tCost < 1 || tCost > kMaxTCost)
+            throw std::invalid_argument("KdfParams: t must be in [1, 64]");
+        if (parallelism < 1 || parallelism > kMaxParallelism)
+            throw std::invalid_argument("KdfParams: p must be in [1, 64]");
+        // argon2 needs at least 8 KiB per lane
+        if (mCostKiB < 8 * parallelism || mCostKiB > kMaxMCostKiB)
+            throw std::invalid_argument("KdfParams: m must be in [8*p KiB, 4 GiB]");
+    }
+
+    friend bool operator==(const KdfParams&, const KdfParams&) = default;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "SecureAllocator.hpp"
+
+#include <optional>
+#include <string_view>
+
+// Handle to one credential's secret. Holds just the row id until reveal();
+// then the ciphertext is read straight from SQLite's buffers, decrypted once
+// and kept until forget() or destruction, which wipe the plaintext.
+// The DatabaseManager and EncryptionManager must outlive the handle.
+class SecretRef {
+public:
+    SecretRef(const DatabaseManager& db, const EncryptionManager& enc, int id)
+        : m_db(&db), m_enc(&enc), m_id(id) {}
+    ~SecretRef() { forget(); }
+
+    // Movable (the plaintext buffer moves with it), not copyable
+    SecretRef(SecretRef&& other) noexcept;
+    SecretRef& operator=(SecretRef&& other) noexcept;
+    SecretRef(const SecretRef&) = delete;
+    SecretRef& operator=(const SecretRef&) = delete;
+
+    int id() const { return m_id; }
+
+    // Plaintext, fetched and decrypted on the first call. Valid until
+    // forget()/destruction. Throws std::runtime_error if the row is gone or
+    // the GCM tag does not verify.
+    std::string_view reveal() const;
+    bool revealed() const { return m_revealed; }
+
+    // Wipe the plaintext now; the next reveal() reads the row again
+    void forget() noexcept;
+
+private:
+    const DatabaseManager*   m_db;
+    const EncryptionManager* m_enc;
+    int m_id;
+    mutable secure_vector m_plain; // locked; zeroized when freed
+    mutable bool m_revealed = false;
+};
+
+// A credential as search/list/view paths use it: metadata up front, the
+// secret only if someone asks.
+struct LazyCredential {
+    CredentialMeta meta;
+    SecretRef      secret;
+
+    // nullopt if there is no such id. Reads no secret columns.
+    static std::optional<LazyCredential> load(const DatabaseManager& db,
+                                              const EncryptionManager& enc, int id);
+};
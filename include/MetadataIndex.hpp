@@ -0,0 +1,87 @@
+#pragma once
+#include "DatabaseManager.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// In-RAM index of the non-secret columns (id, service, username, created_at)
+// for as-you-type lookup without touching the DB. Built once at unlock and
+// kept current as a CredentialObserver on the DatabaseManager.
+//
+// Layout is struct-of-arrays: per-record offsets/lengths in parallel vectors
+// and all text in two arenas. Substring search is one SIMD pass (SSE2, or
+// the C library's memchr elsewhere) over the lowercase arena rather than a
+// walk over per-record strings. Not thread-safe; use from the DB's thread.
+class MetadataIndex : public CredentialObserver {
+public:
+    enum class Mode {
+        Prefix,     // service or username starts with the query
+        Substring,  // query appears anywhere in service or username
+        Fuzzy,      // query chars appear in order (subsequence), or service
+                    // starts with something within 1-2 typos of the query
+    };
+
+    // Views point into the index and stay valid until the next change
+    struct Hit {
+        int              id;
+        std::string_view service;
+        std::string_view username;
+        std::string_view created_at;
+        int              score; // higher is better; only comparable within one search
+    };
+
+    MetadataIndex() = default;
+
+    // One streaming pass over the credentials table
+    static MetadataIndex build(const DatabaseManager& db);
+
+    // Case-insensitive (ASCII) match, best first, at most `limit` hits.
+    // Service matches outrank username matches.
+    std::vector<Hit> search(std::string_view query, Mode mode, std::size_t limit = 50) const;
+
+    void upsert(int id, std::string_view service, std::string_view username,
+                std::string_view createdAt);
+    void erase(int id);
+
+    std::size_t size() const { return m_slotById.size(); }
+
+    // CredentialObserver
+    void credentialUpserted(int id, std::string_view service, std::string_view username,
+                            std::string_view createdAt) override {
+        upsert(id, service, username, createdAt);
+    }
+    void credentialErased(int id) override { erase(id); }
+
+private:
+    // Per record (slot), parallel arrays
+    std::vector<int>           m_ids;
+    std::vector<std::uint32_t> m_foldOff;    // into m_folded: service \0 username \0
+    std::vector<std::uint32_t> m_textOff;    // into m_text: service username created_at
+    std::vector<std::uint32_t> m_serviceLen;
+    std::vector<std::uint32_t> m_userLen;
+    std::vector<std::uint32_t> m_createdLen;
+    std::vector<std::uint8_t>  m_alive;      // 0 once erased or replaced
+
+    std::string m_folded; // ASCII-lowercased service/username, \0-separated
+    std::string m_text;   // original bytes for display
+
+    std::unordered_map<int, std::uint32_t> m_slotById;
+    std::size_t m_dead = 0;
+
+    void append(int id, std::string_view service, std::string_view username,
+                std::string_view createdAt);
+    void kill(std::uint32_t slot);
+    void compactIfSparse();
+    Hit hitFor(std::uint32_t slot, int score) const;
+
+    std::string_view foldedService(std::uint32_t slot) const {
+        return { m_folded.data() + m_foldOff[slot], m_serviceLen[slot] };
+    }
+    std::string_view foldedUser(std::uint32_t slot) const {
+        return { m_folded.data() + m_foldOff[slot] + m_serviceLen[slot] + 1, m_userLen[slot] };
+    }
+};
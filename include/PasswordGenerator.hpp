@@ -0,0 +1,86 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Character-mode rules. Minimums are met by drawing that many characters
+// from the class, filling the rest from the whole alphabet and shuffling.
+struct PasswordPolicy {
+    std::size_t length = 20;
+    bool upper   = true;
+    bool lower   = true;
+    bool digits  = true;
+    bool symbols = true;
+    std::size_t minUpper   = 0;
+    std::size_t minLower   = 0;
+    std::size_t minDigits  = 0;
+    std::size_t minSymbols = 0;
+    bool excludeAmbiguous = false; // drop 0 O 1 l I
+
+    // Throws std::invalid_argument (no class enabled, a minimum for a
+    // disabled class, minimums longer than `length`)
+    void validate() const;
+};
+
+// Passphrase-mode rules: `words` words from the list joined by `separator`
+struct PassphrasePolicy {
+    std::size_t words = 6;
+    std::string separator = "-";
+    bool capitalize = false; // first letter of each word
+};
+
+// Random passwords or passphrases, drawn without modulo bias.
+//
+// Random bytes come from a per-thread RAND_bytes buffer refilled 4 KiB at a
+// time; bytes are wiped from it as soon as they are used. Character tables
+// are built once per generator, and each character costs one byte lookup.
+// Rejection sampling is a scalar loop on purpose: SSE can only vectorise the
+// accept test (a shuffle looks up 16 entries, alphabets have up to 86), and
+// a vector compaction before the scalar lookup measured slower.
+// generate() is const and safe to call from several threads at once.
+class PasswordGenerator {
+public:
+    explicit PasswordGenerator(const PasswordPolicy& policy = {});
+    // Passphrase mode; the list must hold at least two distinct words
+    PasswordGenerator(std::vector<std::string> wordlist, const PassphrasePolicy& policy);
+
+    std::string generate() const;
+    std::vector<std::string> generateMany(std::size_t n) const;
+
+    // Strength of one result if the attacker knows the policy
+    double entropyBits() const;
+
+private:
+    // 256-entry lookup for one alphabet: bytes below `bound` map uniformly
+    // onto it, the rest are rejected
+    struct CharTable {
+        std::array<char, 256> lut{};
+        unsigned bound = 0;
+        std::size_t size = 0;
+    };
+    struct ClassDraw {
+        CharTable table;
+        std::size_t count;
+    };
+
+    void append(std::string& out) const;
+    static CharTable makeTable(const std::string& alphabet);
+    static void fill(const CharTable& table, char* out, std::size_t n);
+
+    // Character mode
+    std::size_t            m_length = 0;
+    CharTable              m_all;
+    std::vector<ClassDraw> m_required; // classes with a minimum
+
+    // Passphrase mode (used when m_words is non-empty)
+    std::vector<std::string> m_words;
+    PassphrasePolicy         m_phrase;
+};
+
+// Words from a list file, one per line. Only the last whitespace-separated
+// field counts, so EFF-style "11111<TAB>word" lists load as-is. Empty lines
+// and duplicates are dropped.
+std::vector<std::string> readWordlist(std::istream& in);
@@ -0,0 +1,20 @@
+#pragma once
+#include <span>
+#include <string_view>
+
+// Rough guessing cost of a password, in the spirit of zxcvbn: the password
+// is split into the cheapest sequence of patterns an attacker would try
+// (common passwords and words, also l33t/reversed/capitalised; runs like
+// "abc" or "987"; keyboard rows; repeats; years) and brute-forced
+// characters, and the bits of each piece are summed.
+struct StrengthEstimate {
+    double bits = 0; // log2 of the estimated guesses
+    int score = 0;   // 0 very weak, 1 weak, 2 fair, 3 strong, 4 very strong
+};
+
+// `context` holds strings an attacker would try first (service, username)
+StrengthEstimate estimateStrength(std::string_view password,
+                                  std::span<const std::string_view> context = {});
+
+// "very weak" ... "very strong"
+const char* strengthLabel(int score);
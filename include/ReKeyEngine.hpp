@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+class DatabaseManager;
+class EncryptionManager;
+
+// Called from the writer (caller's) thread after each batch is written
+using ReKeyProgress = std::function<void(std::size_t done, std::size_t total)>;
+
+struct ReKeyOptions {
+    std::size_t threads     = 0;    // crypto workers; 0 = all hardware threads
+    std::size_t batchSize   = 2048; // rows per read / write batch
+    std::size_t maxInFlight = 0;    // batches queued or being processed; 0 = 2 * threads
+};
+
+// Re-encrypts every credential from one key to another (master-password
+// change). Rows are streamed from the DB in id-keyset batches, decrypted and
+// re-encrypted on a worker pool, and written back in order by the calling
+// thread, which owns the DB connection. Memory stays bounded by
+// batchSize * maxInFlight rows.
+class ReKeyEngine {
+public:
+    ReKeyEngine(DatabaseManager& db,
+                const EncryptionManager& from,
+                const EncryptionManager& to,
+                ReKeyOptions options = {});
+
+    // Must run inside a transaction the caller opened (and commits or rolls
+    // back). Throws on the first row that fails to decrypt. Returns the
+    // number of rows re-encrypted.
+    std::size_t run(const ReKeyProgress& progress = {});
+
+private:
+    DatabaseManager&         m_db;
+    const EncryptionManager& m_from;
+    const EncryptionManager& m_to;
+    ReKeyOptions             m_options;
+};
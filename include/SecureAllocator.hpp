@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Memory for secrets (keys, master passwords, plaintexts). Blocks come from
+// page-locked mappings (mlock / VirtualLock) that are excluded from core
+// dumps (MADV_DONTDUMP where available) and are zeroized when freed.
+//
+// Small blocks (up to kMaxPooled bytes) are recycled through per-size
+// free lists carved from 64 KiB arenas, so a hot decrypt path costs a mutex
+// and a list pop, not an mmap + mlock per call. Larger blocks get their own
+// mapping. Locking is best effort: if RLIMIT_MEMLOCK is exhausted the memory
+// still works (and is still wiped), and lockFailures counts it.
+namespace secure_memory {
+    inline constexpr std::size_t kMaxPooled = 4096;
+
+    void* allocate(std::size_t bytes);                     // throws std::bad_alloc
+    void  deallocate(void* p, std::size_t bytes) noexcept; // zeroizes first
+
+    struct Stats {
+        std::size_t bytesInUse    = 0; // handed out, rounded to block size
+        std::size_t bytesMapped   = 0; // arenas + large blocks currently mapped
+        std::size_t mappings      = 0; // mmap/VirtualAlloc calls so far
+        std::size_t lockFailures  = 0; // mappings that could not be locked
+    };
+    Stats stats();
+}
+
+template <class T>
+struct SecureAllocator {
+    using value_type = T;
+
+    SecureAllocator() noexcept = default;
+    template <class U> SecureAllocator(const SecureAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n > static_cast<std::size_t>(-1) / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T*>(secure_memory::allocate(n * sizeof(T)));
+    }
+    void deallocate(T* p, std::size_t n) noexcept {
+        secure_memory::deallocate(p, n * sizeof(T));
+    }
+
+    template <class U> bool operator==(const SecureAllocator<U>&) const noexcept { return true; }
+};
+
+// Byte buffer for keys and plaintexts
+using secure_vector = std::vector<std::uint8_t, SecureAllocator<std::uint8_t>>;
+
+// String for passwords. Always keeps its characters in secure memory: the
+// capacity never drops below the small-string buffer, so even a short
+// password is not stored inline in the object (where nothing would wipe it).
+class secure_string
+    : public std::basic_string<char, std::char_traits<char>, SecureAllocator<char>> {
+    using Base = std::basic_string<char, std::char_traits<char>, SecureAllocator<char>>;
+    static constexpr std::size_t kMinCapacity = 32; // above every library's SSO size
+
+public:
+    secure_string() { reserve(kMinCapacity); }
+    explicit secure_string(std::string_view s) {
+        reserve(s.size() < kMinCapacity ? kMinCapacity : s.size());
+        append(s);
+    }
+    secure_string(const char* s) : secure_string(std::string_view(s)) {}
+    secure_string(const secure_string& other) : secure_string(std::string_view(other)) {}
+    // Steals the heap buffer. Like any moved-from string, `other` should
+    // only be destroyed or assigned a new secure_string.
+    secure_string(secure_string&& other) noexcept : Base(std::move(other)) {}
+
+    secure_string& operator=(const secure_string& other) {
+        if (this != &other) assign(other.data(), other.size());
+        return *this;
+    }
+    secure_string& operator=(secure_string&& other) noexcept {
+        Base::operator=(std::move(other));
+        return *this;
+    }
+    secure_string& operator=(std::string_view s) {
+        assign(s.data(), s.size());
+        return *this;
+    }
+};
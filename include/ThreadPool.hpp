@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fixed-size worker pool for CPU-bound jobs (bulk decrypt/encrypt).
+// Jobs still queued when the pool is destroyed are run before it returns.
+class ThreadPool {
+public:
+    // threads = 0 -> std::thread::hardware_concurrency() (at least 1)
+    explicit ThreadPool(std::size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return m_workers.size(); }
+
+    // Queue a job; the future reports completion or rethrows its exception.
+    std::future<void> submit(std::function<void()> job);
+
+    // Resolve a requested thread count (0 = all hardware threads)
+    static std::size_t resolveThreads(std::size_t requested);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread>               m_workers;
+    std::deque<std::packaged_task<void()>> m_jobs;
+    std::mutex                             m_mutex;
+    std::condition_variable                m_cv;
+    bool                                   m_stop = false;
+};
+
+// Bounded, order-preserving pipeline over its own pool. The caller submits
+// items in order; a worker runs `work` on each, and the caller's thread
+// hands them to `retire` in submission order, at most `maxInFlight` queued
+// (0 = twice the threads). A worker failure is rethrown by the submit() or
+// finish() that retires its item. Items never retired (a failure, or the
+// pipeline going away early) are passed to `discard` once no worker uses
+// them any more.
+template <class Item>
+class OrderedPipeline {
+public:
+    using Retire  = std::function<void(std::unique_ptr<Item>)>;
+    using Discard = std::function<void(Item&)>;
+
+    OrderedPipeline(std::size_t threads, std::size_t maxInFlight, Retire retire, Discard discard = {})
+        : m_retire(std::move(retire)), m_discard(std::move(discard)), m_pool(threads) {
+        m_maxInFlight = maxInFlight > 0 ? maxInFlight : 2 * m_pool.size();
+    }
+
+    ~OrderedPipeline() {
+        for (Slot& s : m_slots) {
+            if (s.done.valid()) s.done.wait();
+            if (m_discard) m_discard(*s.item);
+        }
+    }
+
+    OrderedPipeline(const OrderedPipeline&) = delete;
+    OrderedPipeline& operator=(const OrderedPipeline&) = delete;
+
+    std::size_t threads() const { return m_pool.size(); }
+
+    // Queue `work(*item)`; once maxInFlight items are queued, retire the oldest
+    void submit(std::unique_ptr<Item> item, std::function<void(Item&)> work) {
+        Item* raw = item.get();
+        std::future<void> done = m_pool.submit([raw, work = std::move(work)] { work(*raw); });
+        m_slots.push_back(Slot{ std::move(item), std::move(done) });
+        if (m_slots.size() >= m_maxInFlight) retireOldest();
+    }
+
+    // Retire everything still queued
+    void finish() {
+        while (!m_slots.empty()) retireOldest();
+    }
+
+private:
+    struct Slot {
+        std::unique_ptr<Item> item;
+        std::future<void>     done;
+    };
+
+    void retireOldest() {
+        Slot s = std::move(m_slots.front());
+        m_slots.pop_front();
+        try {
+            s.done.get(); // rethrows worker failures
+        } catch (...) {
+            if (m_discard) m_discard(*s.item);
+            throw;
+        }
+        m_retire(std::move(s.item));
+    }
+
+    Retire           m_retire;
+    Discard          m_discard;
+    std::size_t      m_maxInFlight = 0;
+    // Before the pool, so the pool's workers are joined before items are freed
+    std::deque<Slot> m_slots;
+    ThreadPool       m_pool;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "VaultScan.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct AuditOptions {
+    ScanOptions scan;
+    int weakBelow = 2;     // estimateStrength scores below this are weak
+    std::string oldBefore; // ISO-8601 UTC; created_at earlier is old, empty = no age check
+};
+
+struct WeakFinding {
+    int id;
+    int score;
+    double bits;
+};
+
+struct OldFinding {
+    int id;
+    std::string created_at;
+};
+
+struct AuditReport {
+    std::size_t rows = 0;
+    std::size_t failed = 0;                // could not be decrypted, so not audited
+    std::vector<WeakFinding> weak;         // ascending id
+    std::vector<std::vector<int>> reused;  // ids sharing one password, each ascending, by first id
+    std::vector<OldFinding> old;           // ascending id
+
+    bool clean() const { return failed == 0 && weak.empty() && reused.empty() && old.empty(); }
+};
+
+// "now minus `days`" in the created_at format, for AuditOptions::oldBefore
+std::string iso8601DaysAgo(int days);
+
+// Decrypt every row on the worker pool (scanDecryptedUnordered) and, on the
+// same worker, score its strength against its service/username and hash it
+// with HMAC-SHA256 under a random per-audit key. Reuse is found by grouping
+// those digests in a hash table; no plaintext outlives its chunk, and the
+// key is wiped on return so the digests can't be brute-forced later.
+AuditReport auditVault(const DatabaseManager& db, const EncryptionManager& enc,
+                       const AuditOptions& options = {});
@@ -0,0 +1,30 @@
+#pragma once
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "VaultScan.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+#include <optional>
+#include <string_view>
+
+// Plaintext dump of the whole vault (`epm dump`), for audits and migration.
+//
+//   Csv        service,username,password,notes,created_at,id  (with that
+//              header line; `epm import` reads it back)
+//   JsonLines  one {"id","service","username","password","notes","created_at"}
+//              object per line
+enum class DumpFormat { Csv, JsonLines };
+
+// "csv" / "jsonl"; nullopt for anything else
+std::optional<DumpFormat> parseDumpFormat(std::string_view name);
+
+struct DumpStats {
+    std::size_t rows   = 0; // written
+    std::size_t failed = 0; // skipped: did not decrypt
+};
+
+// Rows are decrypted in parallel (scanDecrypted) and written in id order
+// through one reused line buffer. Throws std::runtime_error if `out` fails.
+DumpStats dumpVault(const DatabaseManager& db, const EncryptionManager& enc,
+                    std::ostream& out, DumpFormat format, const ScanOptions& options = {});
@@ -0,0 +1,58 @@
+#pragma once
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "KdfParams.hpp"
+#include "VaultUnlock.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+
+// Whole-vault backup container (`epm export` / `epm import`). Independent of
+// the vault it came from: it is sealed under its own passphrase, so it can
+// be restored into any vault.
+//
+//   header  "EPMX" | u8 version | u8 flags | u16 0 | u32 t | u32 m KiB | u32 p | salt[16]
+//   chunk   u32 sealed length | u8 final | iv[12] | ciphertext || tag
+//
+// Each chunk holds about chunkBytes of records (u32-length-prefixed service,
+// username, notes, created_at, password), zstd-compressed if flags bit 0 is
+// set, then AES-256-GCM sealed under Argon2id(passphrase, salt) with
+// AAD = header || u64 chunk index || final. Reordered, dropped or spliced
+// chunks fail the tag check, and the last chunk is marked final so a
+// truncated file is rejected too. Integers are little-endian.
+//
+// Both directions stream: memory stays at a couple of chunks however large
+// the vault is, and each chunk is one large sequential read or write.
+struct ExportOptions {
+    KdfParams   kdf        = defaultKdfParams(); // Argon2id cost for the passphrase
+    bool        compress   = false;              // zstd; see exportCompressionAvailable()
+    std::size_t chunkBytes = 1u << 20;           // plaintext per chunk, before compression
+};
+
+struct ExportStats {
+    std::size_t   records = 0;
+    std::size_t   chunks  = 0;
+    std::uint64_t bytes   = 0; // container size
+};
+
+// True if this build links zstd (EPM_HAVE_ZSTD)
+bool exportCompressionAvailable();
+
+// Writes every credential in `db`, decrypting each secret with `vault`.
+// Throws std::invalid_argument for bad options (or compress without zstd),
+// std::runtime_error if a row fails to decrypt or the stream fails.
+ExportStats exportVault(const DatabaseManager& db, const EncryptionManager& vault,
+                        std::string_view passphrase, std::ostream& out,
+                        const ExportOptions& options = {});
+
+// True if `in` starts with the container magic; the stream is rewound
+bool isVaultExport(std::istream& in);
+
+// Adds every record to `db`, re-sealed under `vault` with the original
+// created_at. All or nothing: the inserts run in one transaction (joined if
+// the caller has one open), rolled back on any error. Throws
+// std::runtime_error for a wrong passphrase or a corrupt/truncated file.
+ExportStats importVault(DatabaseManager& db, const EncryptionManager& vault,
+                        std::string_view passphrase, std::istream& in);
@@ -0,0 +1,48 @@
+#pragma once
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string_view>
+
+// One row of a decrypting scan. All views are only valid inside the visitor
+// call; `password` is empty when `ok` is false (bad tag or malformed row).
+struct PlainRow {
+    int id;
+    std::string_view service;
+    std::string_view username;
+    std::string_view notes;
+    std::string_view created_at;
+    std::span<const std::uint8_t> iv;
+    std::span<const std::uint8_t> sealed; // ciphertext || tag as stored
+    std::string_view password;
+    bool ok;
+};
+
+using PlainVisitor = std::function<void(const PlainRow&)>;
+using PlainChunkVisitor = std::function<void(std::span<const PlainRow>)>;
+
+struct ScanOptions {
+    std::size_t threads   = 0;    // decrypt workers, 0 = all hardware threads
+    std::size_t chunkRows = 4096; // rows read, decrypted and delivered together
+};
+
+// Decrypt every credential on a worker pool and hand the rows to `visit` on
+// the calling thread, in ascending id order. The calling thread reads the
+// next chunks from SQLite while workers decrypt; at most 2 x threads chunks
+// are in flight, so memory stays flat however large the vault is. Plaintext
+// lives in secure memory and is wiped once its chunk has been visited.
+// Returns the number of rows that failed to decrypt. An exception from
+// `visit` stops the scan and is rethrown after the workers finish.
+std::size_t scanDecrypted(const DatabaseManager& db, const EncryptionManager& enc,
+                          const PlainVisitor& visit, const ScanOptions& options = {});
+
+// Unordered variant for per-row work heavier than decryption, which would
+// otherwise bottleneck the calling thread: `visit` gets whole chunks on the
+// worker that decrypted them, concurrently and in no particular order, so it
+// must be thread-safe. Same bounds, wiping and exception rules as above.
+std::size_t scanDecryptedUnordered(const DatabaseManager& db, const EncryptionManager& enc,
+                                   const PlainChunkVisitor& visit, const ScanOptions& options = {});
@@ -0,0 +1,79 @@
+#pragma once
+#include "EncryptionManager.hpp"
+#include "KdfParams.hpp"
+#include "ReKeyEngine.hpp"
+#include "SecureAllocator.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+class DatabaseManager;
+
+// How master_auth {salt, hash} was produced.
+enum MasterScheme : int {
+    // Legacy: Argon2id(pw, auth salt) as verifier, then a second
+    // Argon2id(pw, kdf_salt) for K_enc. Two full KDF runs per unlock.
+    kMasterSchemeTwoHash = 1,
+    // One Argon2id(pw, kdf_salt) root, split with HKDF-SHA256 into
+    // K_enc ("epm/v2/enc") and the stored verifier ("epm/v2/auth").
+    kMasterSchemeHkdf = 2,
+};
+
+// Both halves of a scheme-2 root key (secure memory: wiped when freed)
+struct MasterKeys {
+    secure_vector encKey;   // 32 bytes, for EncryptionManager
+    secure_vector verifier; // 32 bytes, stored in master_auth.hash
+};
+
+// Scheme 2 split of a 32-byte Argon2id root
+MasterKeys splitRootKey(std::span<const std::uint8_t> root);
+
+// Unlock/create/change flows shared by the CLI and the GUI. Each runs
+// Argon2id once per password it checks or sets. Passwords are taken as
+// views so callers can keep them in a secure_string.
+
+// Params for new vaults: the historic t/m with one lane per core (up to 4)
+KdfParams defaultKdfParams();
+
+// First run: new kdf_salt and a scheme-2 master record. Returns the session key.
+EncryptionManager createVault(DatabaseManager& db, std::string_view masterPassword,
+                              const KdfParams& params = defaultKdfParams());
+
+// nullopt on a wrong password. A scheme-1 vault stays scheme 1 (two KDF
+// runs per unlock) and the returned key reads its rows as they are; only a
+// vault with nothing encrypted yet is switched to scheme 2 here.
+std::optional<EncryptionManager> unlockVault(DatabaseManager& db,
+                                             std::string_view masterPassword);
+
+// Explicit scheme 1 -> 2 upgrade: re-encrypts every row under the scheme-2
+// key in one transaction; `progress` reports that re-encryption. Throws (and
+// rolls back, leaving a usable scheme-1 vault) if a row fails to decrypt.
+// nullopt on a wrong password; a scheme-2 vault is just unlocked.
+std::optional<EncryptionManager> upgradeVault(DatabaseManager& db,
+                                              std::string_view masterPassword,
+                                              const ReKeyProgress& progress = {});
+
+// Verifies `current`, re-encrypts everything under `next` with a fresh
+// kdf_salt and stores a scheme-2 record, all in one transaction (rolled back
+// and rethrown on failure). nullopt if `current` is wrong. `newParams`
+// replaces the vault's KDF costs; by default they are kept. Passing the same
+// password twice with new params re-tunes the KDF.
+std::optional<EncryptionManager> changeMasterPassword(DatabaseManager& db,
+                                                      std::string_view current,
+                                                      std::string_view next,
+                                                      const ReKeyProgress& progress = {},
+                                                      std::optional<KdfParams> newParams = std::nullopt);
+
+struct KdfCalibration {
+    KdfParams params;
+    std::chrono::milliseconds measured{0}; // one derivation with `params`
+};
+
+// Pick Argon2id costs that take about `target` on this host: one lane per
+// hardware thread (up to 8), memory doubled from 64 MiB while it fits the
+// budget and at most half the target, then iterations to fill the rest.
+KdfCalibration calibrateKdf(std::chrono::milliseconds target,
+                            std::uint32_t maxMemKiB = 1024 * 1024);
@@ -0,0 +1,41 @@
+#pragma once
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "VaultScan.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// What `epm verify` can find wrong with a credential row
+enum class VerifyIssue {
+    BadTag,          // GCM tag does not match ciphertext + AAD (tampered or wrong key)
+    DuplicateIv,     // IV already used by an earlier row: breaks GCM's guarantees
+    BadIvLength,     // IV is not EncryptionManager::kIvLen bytes
+    ShortCiphertext, // shorter than the GCM tag
+    EmptyService,
+    BadCreatedAt,    // not YYYY-MM-DDTHH:MM:SSZ (it is part of the AAD)
+};
+
+// Short stable name, e.g. "bad-tag"
+const char* verifyIssueName(VerifyIssue issue);
+
+struct VerifyFinding {
+    int id;
+    VerifyIssue issue;
+    int otherId = 0; // DuplicateIv: the earlier row with the same IV
+};
+
+struct VerifyReport {
+    std::size_t rows = 0;
+    std::vector<VerifyFinding> findings;      // ascending id
+    std::vector<std::string>   storageErrors; // from DatabaseManager::quickCheck()
+
+    bool clean() const { return findings.empty() && storageErrors.empty(); }
+};
+
+// Check the SQLite file, then authenticate every row in parallel
+// (scanDecrypted) while tracking IVs and row shape on the calling thread.
+// Plaintext is never copied out of the scan. Read-only.
+VerifyReport verifyVault(const DatabaseManager& db, const EncryptionManager& enc,
+                         const ScanOptions& options = {});
@@ -1,4 +1,6 @@
 #pragma once
+#include "SecureAllocator.hpp"
+
 #include <string>
 #include <iostream>
 
@@ -9,9 +11,11 @@
   #include <unistd.h>
 #endif
 
-inline std::string prompt_hidden(const std::string& message) {
-    std::cout << message << std::flush;
-    std::string out;
+// Reads a line without echo straight into secure memory. The prompt goes
+// to `promptOut` (std::cerr when stdout carries machine-readable output).
+inline secure_string prompt_hidden(const std::string& message, std::ostream& promptOut = std::cout) {
+    promptOut << message << std::flush;
+    secure_string out;
 
 #if defined(_WIN32)
     HANDLE hStdin = GetStdHandle(STD_INPUT_HANDLE);
@@ -32,6 +36,6 @@ inline std::string prompt_hidden(const std::string& message) {
     tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
 #endif
 
-    std::cout << "\n";
+    promptOut << "\n";
     return out;
 }
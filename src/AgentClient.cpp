@@ -0,0 +1,167 @@
+#include "AgentClient.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using agent::FrameWriter;
+using agent::Op;
+using agent::Status;
+
+namespace {
+    std::runtime_error sys_error(const std::string& what) {
+        return std::runtime_error("agent: " + what + ": " + std::strerror(errno));
+    }
+
+    void send_all(int fd, const std::uint8_t* p, std::size_t n) {
+        while (n > 0) {
+            const ssize_t w = ::send(fd, p, n, MSG_NOSIGNAL);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                throw sys_error("send");
+            }
+            p += w;
+            n -= static_cast<std::size_t>(w);
+        }
+    }
+
+    void recv_all(int fd, std::uint8_t* p, std::size_t n) {
+        while (n > 0) {
+            const ssize_t r = ::recv(fd, p, n, 0);
+            if (r == 0) throw std::runtime_error("agent: connection closed");
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                throw sys_error("recv");
+            }
+            p += r;
+            n -= static_cast<std::size_t>(r);
+        }
+    }
+
+    std::uint8_t op_byte(Op op) { return static_cast<std::uint8_t>(op); }
+}
+
+AgentClient::AgentClient(const std::string& socketPath) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path)) {
+        throw std::invalid_argument("agent: bad socket path");
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    m_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) throw sys_error("socket");
+    if (::connect(m_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        const auto err = sys_error("connect " + socketPath);
+        ::close(m_fd);
+        throw err;
+    }
+
+    // Secrets go over this socket: only talk to an agent run by this user
+    ucred peer{};
+    socklen_t len = sizeof(peer);
+    if (::getsockopt(m_fd, SOL_SOCKET, SO_PEERCRED, &peer, &len) != 0 || peer.uid != ::geteuid()) {
+        ::close(m_fd);
+        m_fd = -1;
+        throw std::runtime_error("agent: " + socketPath + " is not served by this user");
+    }
+}
+
+AgentClient::~AgentClient() {
+    if (m_fd >= 0) ::close(m_fd);
+}
+
+AgentClient::AgentClient(AgentClient&& other) noexcept
+    : m_fd(std::exchange(other.m_fd, -1)), m_response(std::move(other.m_response)) {}
+
+AgentClient& AgentClient::operator=(AgentClient&& other) noexcept {
+    if (this != &other) {
+        if (m_fd >= 0) ::close(m_fd);
+        m_fd = std::exchange(other.m_fd, -1);
+        m_response = std::move(other.m_response);
+    }
+    return *this;
+}
+
+std::optional<agent::Reader> AgentClient::call(const secure_vector& request) {
+    if (m_fd < 0) throw std::logic_error("agent: client was moved from");
+    send_all(m_fd, request.data(), request.size());
+
+    std::uint8_t prefix[4];
+    recv_all(m_fd, prefix, sizeof(prefix));
+    const std::uint32_t len = agent::frameLength(prefix);
+    if (len == 0) throw std::runtime_error("agent: empty response");
+    m_response.resize(len);
+    recv_all(m_fd, m_response.data(), len);
+
+    agent::Reader reader(m_response);
+    switch (static_cast<Status>(reader.u8())) {
+    case Status::Ok:         return reader;
+    case Status::NotFound:   return std::nullopt;
+    case Status::BadRequest: throw std::invalid_argument(std::string(reader.str()));
+    case Status::Error:      throw std::runtime_error(std::string(reader.str()));
+    }
+    throw std::runtime_error("agent: unknown response status");
+}
+
+void AgentClient::ping() {
+    secure_vector req;
+    FrameWriter(req).u8(op_byte(Op::Ping)).finish();
+    call(req);
+}
+
+std::optional<AgentCredential> AgentClient::get(int id) {
+    secure_vector req;
+    FrameWriter(req).u8(op_byte(Op::Get)).i32(id).finish();
+    auto r = call(req);
+    if (!r) return std::nullopt;
+
+    AgentCredential cred;
+    cred.meta.id         = r->i32();
+    cred.meta.service    = std::string(r->str());
+    cred.meta.username   = std::string(r->str());
+    cred.meta.notes      = std::string(r->str());
+    cred.meta.created_at = std::string(r->str());
+    cred.password        = r->str();
+    return cred;
+}
+
+std::vector<CredentialMeta> AgentClient::search(std::string_view query, std::uint32_t limit) {
+    secure_vector req;
+    FrameWriter(req).u8(op_byte(Op::Search)).u32(limit).str(query).finish();
+    auto r = call(req);
+    if (!r) return {};
+
+    // A row is at least an id and three length prefixes: a count the
+    // payload can't hold is corrupt and must not size the allocation
+    const std::uint32_t count = r->u32();
+    if (count > r->remaining() / 16) throw std::invalid_argument("agent: truncated message");
+    std::vector<CredentialMeta> rows(count);
+    for (CredentialMeta& m : rows) {
+        m.id         = r->i32();
+        m.service    = std::string(r->str());
+        m.username   = std::string(r->str());
+        m.created_at = std::string(r->str());
+    }
+    return rows;
+}
+
+int AgentClient::add(std::string_view service, std::string_view username,
+                     std::string_view password, std::string_view notes) {
+    secure_vector req;
+    FrameWriter(req).u8(op_byte(Op::Add)).str(service).str(username).str(password).str(notes).finish();
+    auto r = call(req);
+    if (!r) throw std::runtime_error("agent: add returned no id");
+    return r->i32();
+}
+
+void AgentClient::lock() {
+    secure_vector req;
+    FrameWriter(req).u8(op_byte(Op::Lock)).finish();
+    call(req);
+}
@@ -0,0 +1,98 @@
+#include "AgentProtocol.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace agent {
+
+namespace {
+    std::uint32_t load_le32(const std::uint8_t* p) {
+        return static_cast<std::uint32_t>(p[0]) | static_cast<std::uint32_t>(p[1]) << 8 |
+               static_cast<std::uint32_t>(p[2]) << 16 | static_cast<std::uint32_t>(p[3]) << 24;
+    }
+
+    void store_le32(std::uint8_t* p, std::uint32_t v) {
+        p[0] = static_cast<std::uint8_t>(v);
+        p[1] = static_cast<std::uint8_t>(v >> 8);
+        p[2] = static_cast<std::uint8_t>(v >> 16);
+        p[3] = static_cast<std::uint8_t>(v >> 24);
+    }
+}
+
+FrameWriter::FrameWriter(secure_vector& out) : m_out(out), m_start(out.size()) {
+    m_out.resize(m_start + 4);
+}
+
+FrameWriter& FrameWriter::u8(std::uint8_t v) {
+    m_out.push_back(v);
+    return *this;
+}
+
+FrameWriter& FrameWriter::u32(std::uint32_t v) {
+    const std::size_t at = m_out.size();
+    m_out.resize(at + 4);
+    store_le32(m_out.data() + at, v);
+    return *this;
+}
+
+FrameWriter& FrameWriter::str(std::string_view s) {
+    if (s.size() > kMaxFrame) throw std::length_error("agent: string too long");
+    u32(static_cast<std::uint32_t>(s.size()));
+    m_out.insert(m_out.end(), s.begin(), s.end());
+    return *this;
+}
+
+void FrameWriter::finish() {
+    const std::size_t len = m_out.size() - m_start - 4;
+    if (len > kMaxFrame) {
+        m_out.resize(m_start);
+        throw std::length_error("agent: frame too large");
+    }
+    store_le32(m_out.data() + m_start, static_cast<std::uint32_t>(len));
+}
+
+std::span<const std::uint8_t> Reader::take(std::size_t n) {
+    if (m_p.size() - m_pos < n) throw std::invalid_argument("agent: truncated message");
+    const auto s = m_p.subspan(m_pos, n);
+    m_pos += n;
+    return s;
+}
+
+std::uint8_t Reader::u8() {
+    return take(1)[0];
+}
+
+std::uint32_t Reader::u32() {
+    return load_le32(take(4).data());
+}
+
+std::string_view Reader::str() {
+    const std::uint32_t n = u32();
+    const auto s = take(n);
+    return { reinterpret_cast<const char*>(s.data()), s.size() };
+}
+
+std::uint32_t frameLength(std::span<const std::uint8_t, 4> prefix) {
+    const std::uint32_t len = load_le32(prefix.data());
+    if (len > kMaxFrame) throw std::length_error("agent: frame too large");
+    return len;
+}
+
+std::optional<std::uint32_t> completeFrame(std::span<const std::uint8_t> buf) {
+    if (buf.size() < 4) return std::nullopt;
+    const std::uint32_t len = frameLength(buf.first<4>());
+    if (buf.size() - 4 < len) return std::nullopt;
+    return len;
+}
+
+std::string defaultSocketPath() {
+    if (const char* env = std::getenv("EPM_AGENT_SOCK"); env && *env) return env;
+    if (const char* run = std::getenv("XDG_RUNTIME_DIR"); run && *run) {
+        return std::string(run) + "/epm-agent.sock";
+    }
+    return "/tmp/epm-agent-" + std::to_string(::getuid()) + "/agent.sock";
+}
+
+} // namespace agent
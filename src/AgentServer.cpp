@@ -0,0 +1,434 @@
+#include "AgentServer.hpp"
+
+#include "CredentialAad.hpp"
+#include "LazyCredential.hpp"
+
+#include <openssl/crypto.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using agent::FrameWriter;
+using agent::Op;
+using agent::Status;
+
+namespace {
+    constexpr std::size_t kReadChunk  = 16 * 1024;
+    constexpr std::size_t kReadBudget = 256 * 1024; // per client per wakeup
+    constexpr int         kMaxEvents  = 64;
+
+    std::runtime_error sys_error(const std::string& what) {
+        return std::runtime_error("agent: " + what + ": " + std::strerror(errno));
+    }
+
+    sockaddr_un socket_address(const std::string& path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            throw std::invalid_argument("agent: socket path must be 1.." +
+                                        std::to_string(sizeof(addr.sun_path) - 1) + " bytes");
+        }
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        return addr;
+    }
+
+    // True if something is accepting connections on `path`
+    bool socket_alive(const sockaddr_un& addr) {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+        const bool alive = ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+        ::close(fd);
+        return alive;
+    }
+
+    void end_of_request(const agent::Reader& req) {
+        if (!req.done()) throw std::invalid_argument("agent: trailing bytes in request");
+    }
+}
+
+AgentServer::AgentServer(DatabaseManager& db, EncryptionManager enc, Options options)
+    : m_db(db), m_enc(std::move(enc)), m_options(std::move(options))
+{
+    const sockaddr_un addr = socket_address(m_options.socketPath);
+
+    // A private directory for the default /tmp location. One that already
+    // exists must be ours and closed to everyone else: whoever can write to
+    // it could swap the socket for their own listener.
+    const std::filesystem::path dir = std::filesystem::path(m_options.socketPath).parent_path();
+    if (!dir.empty()) {
+        if (::mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) throw sys_error("mkdir " + dir.string());
+        struct stat ds{};
+        if (::lstat(dir.c_str(), &ds) != 0) throw sys_error("lstat " + dir.string());
+        if (!S_ISDIR(ds.st_mode) || ds.st_uid != ::geteuid() || (ds.st_mode & 077) != 0) {
+            throw std::runtime_error("agent: " + dir.string() +
+                                     " must be a directory owned by this user with mode 0700");
+        }
+    }
+
+    struct stat st{};
+    if (::lstat(addr.sun_path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            throw std::runtime_error("agent: " + m_options.socketPath + " exists and is not a socket");
+        }
+        if (socket_alive(addr)) {
+            throw std::runtime_error("agent: already running on " + m_options.socketPath);
+        }
+        ::unlink(addr.sun_path); // left behind by an agent that died
+    }
+
+    try {
+        m_listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_listenFd < 0) throw sys_error("socket");
+
+        // Never visible with looser permissions, not even between bind and chmod
+        const mode_t oldMask = ::umask(0177);
+        const int rc = ::bind(m_listenFd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+        ::umask(oldMask);
+        if (rc != 0) throw sys_error("bind " + m_options.socketPath);
+        m_bound = true;
+        if (::chmod(addr.sun_path, 0600) != 0) throw sys_error("chmod");
+        if (::listen(m_listenFd, SOMAXCONN) != 0) throw sys_error("listen");
+
+        m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (m_epollFd < 0) throw sys_error("epoll_create1");
+        m_stopFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_stopFd < 0) throw sys_error("eventfd");
+
+        for (const int fd : {m_listenFd, m_stopFd}) {
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            if (::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) throw sys_error("epoll_ctl");
+        }
+    } catch (...) {
+        teardown();
+        throw;
+    }
+}
+
+AgentServer::~AgentServer() {
+    teardown();
+}
+
+void AgentServer::stop() noexcept {
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const auto n = ::write(m_stopFd, &one, sizeof(one));
+}
+
+AgentServer::StopReason AgentServer::run() {
+    using clock = std::chrono::steady_clock;
+    auto lastRequest = clock::now();
+    StopReason reason = StopReason::Stopped;
+    epoll_event events[kMaxEvents];
+
+    for (;;) {
+        int timeoutMs = -1;
+        if (m_options.idleTimeout.count() > 0) {
+            const auto left = m_options.idleTimeout - (clock::now() - lastRequest);
+            if (left <= clock::duration::zero()) {
+                reason = StopReason::IdleTimeout;
+                break;
+            }
+            timeoutMs = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(left).count());
+        }
+
+        const int n = ::epoll_wait(m_epollFd, events, kMaxEvents, timeoutMs);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            teardown();
+            throw sys_error("epoll_wait");
+        }
+
+        bool stopRequested = false;
+        std::vector<int> ready;
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[i].data.fd;
+            const std::uint32_t ev = events[i].events;
+            if (fd == m_listenFd) { acceptClients(); continue; }
+            if (fd == m_stopFd)   { stopRequested = true; continue; }
+
+            auto it = m_clients.find(fd);
+            if (it == m_clients.end()) continue;
+            Connection& c = it->second;
+            if ((ev & EPOLLERR) || ((ev & EPOLLHUP) && c.closing)) { closeClient(fd); continue; }
+            if ((ev & EPOLLOUT) && !flushOut(fd, c)) { closeClient(fd); continue; }
+            if (ev & (EPOLLIN | EPOLLHUP)) {
+                if (!readFrom(fd, c)) { closeClient(fd); continue; }
+                ready.push_back(fd);
+            }
+        }
+        if (!ready.empty()) lastRequest = clock::now();
+
+        // A client that queued an Add gets nothing else answered until the
+        // batch commits, so its responses stay in request order
+        while (!ready.empty()) {
+            std::vector<int> blocked;
+            for (const int fd : ready) {
+                if (processFrames(fd, m_clients.at(fd))) blocked.push_back(fd);
+            }
+            commitAdds();
+            for (const int fd : ready) {
+                auto it = m_clients.find(fd);
+                if (it != m_clients.end() && !flushOut(fd, it->second)) closeClient(fd);
+            }
+            std::erase_if(blocked, [this](int fd) { return !m_clients.contains(fd); });
+            ready.swap(blocked);
+        }
+
+        if (m_locked)      { reason = StopReason::Locked; break; }
+        if (stopRequested) break;
+    }
+
+    teardown();
+    return reason;
+}
+
+void AgentServer::acceptClients() {
+    for (;;) {
+        const int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return; // EAGAIN, or out of descriptors: retried on the next wakeup
+        }
+
+        ucred peer{};
+        socklen_t len = sizeof(peer);
+        const bool sameUser = ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &len) == 0 &&
+                              peer.uid == ::geteuid();
+        if (!sameUser || m_clients.size() >= m_options.maxClients) {
+            ::close(fd);
+            continue;
+        }
+
+        Connection& c = m_clients[fd];
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            m_clients.erase(fd);
+            ::close(fd);
+            continue;
+        }
+        c.events = EPOLLIN;
+    }
+}
+
+bool AgentServer::readFrom(int fd, Connection& c) {
+    std::size_t total = 0;
+    while (total < kReadBudget) {
+        const std::size_t at = c.in.size();
+        c.in.resize(at + kReadChunk);
+        const ssize_t r = ::read(fd, c.in.data() + at, kReadChunk);
+        c.in.resize(at + (r > 0 ? static_cast<std::size_t>(r) : 0));
+        if (r > 0) {
+            total += static_cast<std::size_t>(r);
+            if (static_cast<std::size_t>(r) < kReadChunk) break;
+            continue;
+        }
+        if (r == 0) {
+            c.closing = true; // answer what was sent, then close
+            break;
+        }
+        if (errno == EINTR) continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    return true;
+}
+
+bool AgentServer::processFrames(int fd, Connection& c) {
+    std::size_t pos = 0;
+    bool blocked = false;
+    try {
+        while (!m_locked) {
+            const std::span<const std::uint8_t> rest(c.in.data() + pos, c.in.size() - pos);
+            const auto len = agent::completeFrame(rest);
+            if (!len) break;
+            const bool isAdd = *len > 0 && rest[4] == static_cast<std::uint8_t>(Op::Add);
+            if (c.addQueued && !isAdd) {
+                blocked = true;
+                break;
+            }
+            handle(agent::Reader(rest.subspan(4, *len)), fd, c);
+            pos += 4 + *len;
+        }
+    } catch (const std::length_error&) {
+        // Oversized frame: nothing after it can be parsed
+        pos = c.in.size();
+        c.closing = true;
+    }
+    OPENSSL_cleanse(c.in.data(), pos);
+    c.in.erase(c.in.begin(), c.in.begin() + static_cast<std::ptrdiff_t>(pos));
+    return blocked;
+}
+
+void AgentServer::handle(agent::Reader req, int fd, Connection& c) {
+    const std::size_t mark = c.out.size();
+    try {
+        const auto op = static_cast<Op>(req.u8());
+        switch (op) {
+        case Op::Ping:
+            end_of_request(req);
+            FrameWriter(c.out).u8(static_cast<std::uint8_t>(Status::Ok)).finish();
+            return;
+
+        case Op::Get: {
+            const int id = req.i32();
+            end_of_request(req);
+            auto cred = LazyCredential::load(m_db, *m_enc, id);
+            FrameWriter w(c.out);
+            if (!cred) {
+                w.u8(static_cast<std::uint8_t>(Status::NotFound)).finish();
+                return;
+            }
+            const CredentialMeta& m = cred->meta;
+            w.u8(static_cast<std::uint8_t>(Status::Ok))
+             .i32(m.id).str(m.service).str(m.username).str(m.notes).str(m.created_at)
+             .str(cred->secret.reveal())
+             .finish();
+            return;
+        }
+
+        case Op::Search: {
+            const std::uint32_t limit = req.u32();
+            const std::string query(req.str());
+            end_of_request(req);
+            if (limit < 1 || limit > 10000) throw std::invalid_argument("limit must be in [1, 10000]");
+            const auto rows = m_db.searchCredentials(query, kSearchAll, static_cast<int>(limit));
+            FrameWriter w(c.out);
+            w.u8(static_cast<std::uint8_t>(Status::Ok)).u32(static_cast<std::uint32_t>(rows.size()));
+            for (const CredentialMeta& m : rows) {
+                w.i32(m.id).str(m.service).str(m.username).str(m.created_at);
+            }
+            w.finish();
+            return;
+        }
+
+        case Op::Add: {
+            PendingAdd add{fd, {}};
+            NewCredential& nc = add.row;
+            nc.service  = std::string(req.str());
+            nc.username = std::string(req.str());
+            const std::string_view secret = req.str();
+            nc.notes    = std::string(req.str());
+            end_of_request(req);
+            if (nc.service.empty()) throw std::invalid_argument("service must not be empty");
+
+            nc.created_at = iso8601UtcNow();
+            sealCredential(*m_enc, secret, nc.service, nc.username, nc.created_at,
+                           nc.iv, nc.enc_password);
+
+            m_adds.push_back(std::move(add));
+            c.addQueued = true; // answered by commitAdds()
+            return;
+        }
+
+        case Op::Lock:
+            end_of_request(req);
+            m_enc.reset(); // wipes the key now; run() returns after this batch
+            m_locked = true;
+            FrameWriter(c.out).u8(static_cast<std::uint8_t>(Status::Ok)).finish();
+            return;
+        }
+        throw std::invalid_argument("unknown op " + std::to_string(static_cast<int>(op)));
+    } catch (const std::exception& ex) {
+        OPENSSL_cleanse(c.out.data() + mark, c.out.size() - mark);
+        c.out.resize(mark);
+        const bool bad = dynamic_cast<const std::invalid_argument*>(&ex) != nullptr;
+        FrameWriter(c.out)
+            .u8(static_cast<std::uint8_t>(bad ? Status::BadRequest : Status::Error))
+            .str(ex.what())
+            .finish();
+    }
+}
+
+void AgentServer::commitAdds() {
+    if (m_adds.empty()) return;
+
+    std::vector<NewCredential> rows;
+    rows.reserve(m_adds.size());
+    for (PendingAdd& a : m_adds) rows.push_back(std::move(a.row));
+
+    // addCredentials() runs its own transaction: all of these or none
+    std::vector<int> ids;
+    std::string error;
+    try {
+        ids = m_db.addCredentials(rows);
+    } catch (const std::exception& ex) {
+        error = ex.what();
+    }
+
+    for (std::size_t i = 0; i < m_adds.size(); ++i) {
+        Connection& c = m_clients.at(m_adds[i].fd);
+        FrameWriter w(c.out);
+        if (error.empty()) w.u8(static_cast<std::uint8_t>(Status::Ok)).i32(ids[i]);
+        else               w.u8(static_cast<std::uint8_t>(Status::Error)).str(error);
+        w.finish();
+        c.addQueued = false;
+    }
+    m_adds.clear();
+}
+
+bool AgentServer::flushOut(int fd, Connection& c) {
+    while (c.outPos < c.out.size()) {
+        const ssize_t w = ::send(fd, c.out.data() + c.outPos, c.out.size() - c.outPos, MSG_NOSIGNAL);
+        if (w > 0) {
+            c.outPos += static_cast<std::size_t>(w);
+        } else if (w < 0 && errno == EINTR) {
+            continue;
+        } else if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            watch(fd, c);
+            return true;
+        } else {
+            return false;
+        }
+    }
+    // Responses carry passwords: wipe them rather than leave them in the capacity
+    OPENSSL_cleanse(c.out.data(), c.out.size());
+    c.out.clear();
+    c.outPos = 0;
+    if (c.closing && !c.addQueued && !agent::completeFrame(c.in)) return false;
+    watch(fd, c);
+    return true;
+}
+
+void AgentServer::watch(int fd, Connection& c) {
+    std::uint32_t want = 0;
+    if (!c.closing) want |= EPOLLIN;
+    if (c.outPos < c.out.size()) want |= EPOLLOUT;
+    if (want == c.events) return;
+    epoll_event ev{};
+    ev.events = want;
+    ev.data.fd = fd;
+    if (::epoll_ctl(m_epollFd, EPOLL_CTL_MOD, fd, &ev) == 0) c.events = want;
+}
+
+void AgentServer::closeClient(int fd) {
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    m_clients.erase(fd); // buffers are wiped as they are freed
+}
+
+void AgentServer::teardown() noexcept {
+    m_enc.reset();
+    m_adds.clear();
+    for (auto& [fd, c] : m_clients) ::close(fd);
+    m_clients.clear();
+    if (m_listenFd >= 0) { ::close(m_listenFd); m_listenFd = -1; }
+    if (m_bound) {
+        ::unlink(m_options.socketPath.c_str());
+        m_bound = false;
+    }
+    if (m_epollFd >= 0) { ::close(m_epollFd); m_epollFd = -1; }
+    if (m_stopFd >= 0)  { ::close(m_stopFd);  m_stopFd = -1; }
+}
@@ -1,10 +1,12 @@
 #include "AuthManager.hpp"
+#include "Instrumentation.hpp"
 
 #include <openssl/rand.h>   // RAND_bytes
 #include <argon2.h>         // Argon2id
+#include <string>
 #include <stdexcept>
 
-StoredAuth AuthManager::createMasterRecord(const std::string& masterPassword) const {
+StoredAuth AuthManager::createMasterRecord(std::string_view masterPassword) const {
     // 1) Generate random 16-byte salt
     std::vector<std::uint8_t> salt(SALT_LEN);
     if (RAND_bytes(salt.data(), static_cast<int>(salt.size())) != 1) {
@@ -31,8 +33,9 @@ StoredAuth AuthManager::createMasterRecord(const std::string& masterPassword) co
     return StoredAuth{ std::move(salt), std::move(hash) };
 }
 
-bool AuthManager::verifyMasterPassword(const std::string& masterPassword,
+bool AuthManager::verifyMasterPassword(std::string_view masterPassword,
                                        const StoredAuth& stored) const {
+    EPM_TIMED("auth.verifyMasterPassword");
     // Recompute Argon2id with stored salt; compare in constant time
     if (stored.salt.size() != SALT_LEN || stored.hash.size() != HASH_LEN) {
         return false;
@@ -0,0 +1,212 @@
+#include "BatchRunner.hpp"
+
+#include "CredentialAad.hpp"
+#include "Json.hpp"
+#include "LazyCredential.hpp"
+#include "password_gen.hpp"
+
+#include <openssl/crypto.h>
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+
+namespace {
+    std::string_view require_string(const json::Object& cmd, std::string_view key) {
+        auto v = json::getString(cmd, key);
+        if (!v) throw std::invalid_argument("missing \"" + std::string(key) + "\"");
+        return *v;
+    }
+
+    int require_id(const json::Object& cmd) {
+        auto v = json::getInt(cmd, "id");
+        if (!v) throw std::invalid_argument("missing \"id\"");
+        if (*v < 1 || *v > INT32_MAX) throw std::invalid_argument("\"id\" out of range");
+        return static_cast<int>(*v);
+    }
+
+    void op_add(DatabaseManager& db, const EncryptionManager& enc,
+                const json::Object& cmd, json::SecureObjectWriter& w) {
+        NewCredential nc;
+        nc.service  = std::string(require_string(cmd, "service"));
+        nc.username = std::string(json::getString(cmd, "username").value_or(""));
+        nc.notes    = std::string(json::getString(cmd, "notes").value_or(""));
+        if (nc.service.empty()) throw std::invalid_argument("\"service\" must not be empty");
+        nc.created_at = iso8601UtcNow();
+        sealCredential(enc, require_string(cmd, "password"), nc.service, nc.username,
+                       nc.created_at, nc.iv, nc.enc_password);
+        const auto ids = db.addCredentials(std::span<const NewCredential>(&nc, 1));
+        w.num("id", ids.front());
+    }
+
+    void op_get(const DatabaseManager& db, const EncryptionManager& enc,
+                const json::Object& cmd, json::SecureObjectWriter& w) {
+        auto cred = LazyCredential::load(db, enc, require_id(cmd));
+        if (!cred) throw std::invalid_argument("no such id");
+        const CredentialMeta& m = cred->meta;
+        w.num("id", m.id)
+         .str("service", m.service)
+         .str("username", m.username)
+         .str("notes", m.notes)
+         .str("created_at", m.created_at)
+         .str("password", cred->secret.reveal());
+    }
+
+    void op_search(const DatabaseManager& db, const json::Object& cmd, json::SecureObjectWriter& w) {
+        const std::string query(require_string(cmd, "query"));
+        const auto limit = json::getInt(cmd, "limit").value_or(50);
+        if (limit < 1 || limit > 10000) throw std::invalid_argument("\"limit\" must be in [1, 10000]");
+
+        std::string rows = "[";
+        for (const CredentialMeta& m : db.searchCredentials(query, kSearchAll, static_cast<int>(limit))) {
+            if (rows.size() > 1) rows += ',';
+            json::ObjectWriter row(rows);
+            row.num("id", m.id)
+               .str("service", m.service)
+               .str("username", m.username)
+               .str("created_at", m.created_at);
+            row.close();
+        }
+        rows += ']';
+        w.raw("results", rows);
+    }
+
+    void op_update(DatabaseManager& db, const EncryptionManager& enc,
+                   const json::Object& cmd, json::SecureObjectWriter& w) {
+        const int id = require_id(cmd);
+        auto cred = LazyCredential::load(db, enc, id);
+        if (!cred) throw std::invalid_argument("no such id");
+        const CredentialMeta& m = cred->meta;
+
+        const std::string username(json::getString(cmd, "username").value_or(m.username));
+        const std::string notes(json::getString(cmd, "notes").value_or(m.notes));
+        // The username is in the AAD, so the secret is re-sealed either way
+        const auto newSecret = json::getString(cmd, "password");
+
+        std::vector<std::uint8_t> iv, sealed;
+        sealCredential(enc, newSecret ? *newSecret : cred->secret.reveal(), m.service, username,
+                       m.created_at, iv, sealed);
+        db.updateCredential(id, username, sealed, iv, notes);
+        w.num("id", id);
+    }
+
+    void op_delete(DatabaseManager& db, const json::Object& cmd, json::SecureObjectWriter& w) {
+        const int id = require_id(cmd);
+        if (!db.getCredentialMeta(id)) throw std::invalid_argument("no such id");
+        db.deleteCredential(id);
+        w.num("id", id);
+    }
+
+    void op_generate(const json::Object& cmd, json::SecureObjectWriter& w) {
+        const auto length = json::getInt(cmd, "length").value_or(20);
+        if (length < 1 || length > 1024) throw std::invalid_argument("\"length\" must be in [1, 1024]");
+        const bool symbols = json::getBool(cmd, "symbols").value_or(true);
+        std::string password = generate_password(static_cast<std::size_t>(length), true, true, true, symbols);
+        w.str("password", password);
+        OPENSSL_cleanse(password.data(), password.size());
+    }
+
+    secure_string error_line(const std::string& tagJson, std::string_view message) {
+        secure_string out;
+        json::SecureObjectWriter w(out);
+        w.boolean("ok", false);
+        if (!tagJson.empty()) w.raw("tag", tagJson);
+        w.str("error", message);
+        w.close();
+        return out;
+    }
+}
+
+BatchRunner::BatchRunner(DatabaseManager& db, const EncryptionManager& enc, Options options)
+    : m_db(db), m_enc(enc), m_options(options)
+{
+    if (m_options.maxPendingWrites == 0) {
+        throw std::invalid_argument("BatchRunner: maxPendingWrites must be > 0");
+    }
+}
+
+BatchRunner::Result BatchRunner::execute(std::string_view line) {
+    Result r;
+    json::Object cmd;
+    try {
+        cmd = json::parseObject(line);
+        const auto tag = cmd.find("tag");
+        if (tag != cmd.end()) json::appendValue(r.tagJson, tag->second);
+
+        const std::string op(require_string(cmd, "op"));
+        r.write = op == "add" || op == "update" || op == "delete";
+        if (r.write && !m_db.inTransaction()) m_db.beginTransaction();
+        // A read after queued writes sees them before they are committed
+        r.inTransaction = m_db.inTransaction() && op != "generate";
+
+        secure_string out;
+        json::SecureObjectWriter w(out);
+        w.boolean("ok", true);
+        if (!r.tagJson.empty()) w.raw("tag", r.tagJson);
+
+        if (op == "add")           op_add(m_db, m_enc, cmd, w);
+        else if (op == "get")      op_get(m_db, m_enc, cmd, w);
+        else if (op == "search")   op_search(m_db, cmd, w);
+        else if (op == "update")   op_update(m_db, m_enc, cmd, w);
+        else if (op == "delete")   op_delete(m_db, cmd, w);
+        else if (op == "generate") op_generate(cmd, w);
+        else throw std::invalid_argument("unknown op \"" + op + "\"");
+
+        w.close();
+        r.json = std::move(out);
+        r.ok = true;
+    } catch (const std::exception& ex) {
+        r.json = error_line(r.tagJson, ex.what());
+        r.ok = false;
+    }
+    // parseObject leaves "password" in a plain string sized exactly once
+    json::wipeValues(cmd);
+    return r;
+}
+
+void BatchRunner::flush(std::ostream& out) {
+    if (m_db.inTransaction()) {
+        try {
+            m_db.commit();
+            ++m_commits;
+        } catch (const std::exception& ex) {
+            try { m_db.rollback(); } catch (...) {}
+            const std::string msg = std::string("commit failed, rolled back: ") + ex.what();
+            for (Result& r : m_pending) {
+                if (r.inTransaction && r.ok) {
+                    r.json = error_line(r.tagJson, msg);
+                    r.ok = false;
+                }
+            }
+        }
+    }
+    for (const Result& r : m_pending) {
+        if (!r.ok) ++m_failures;
+        out << r.json << '\n';
+    }
+    out.flush();
+    m_pending.clear();
+    m_pendingWrites = 0;
+}
+
+std::size_t BatchRunner::run(std::istream& in, std::ostream& out) {
+    secure_string line; // add/update lines carry a password
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.find_first_not_of(" \t") == std::string::npos) continue;
+
+        Result r = execute(line);
+        if (r.write) ++m_pendingWrites;
+        m_pending.push_back(std::move(r));
+
+        // Commit before we could block on input, so a client waiting for
+        // this answer is never stuck behind our buffering
+        if (m_pendingWrites >= m_options.maxPendingWrites || in.rdbuf()->in_avail() <= 0) {
+            flush(out);
+        }
+    }
+    flush(out);
+    return m_failures;
+}
@@ -1,41 +1,38 @@
 // src/DatabaseManager.cpp
 #include "DatabaseManager.hpp"
+#include "CredentialAad.hpp"
+#include "Instrumentation.hpp"
 
 #include <sqlite3.h>
 #include <stdexcept>
 #include <string>
 #include <vector>
-#include <memory>     // std::unique_ptr
 #include <optional>   // std::optional
-#include <chrono>
-#include <iomanip>
-#include <sstream>
 #include <cstdint>
+#include <iterator>   // std::size
+#include <algorithm>  // std::min
+#include <array>
+#include <cstring>    // std::strcmp
 
-// Helper: RAII closer for sqlite3_stmt* + small helpers
+// Small helpers
 namespace {
-    struct StmtCloser {
-        void operator()(sqlite3_stmt* stmt) const {
-            if (stmt) sqlite3_finalize(stmt);
-        }
+    // Names for error messages, indexed like DatabaseManager::StmtId
+    const char* const kStmtNames[] = {
+        "storeMaster", "loadMaster", "loadMasterScheme", "storeKdfSalt", "loadKdfSalt",
+        "storeKdfParams", "loadKdfParams",
+        "addCredential", "getCredentialById", "getCredentialMeta", "readSecret", "searchByService", "searchByService(fts)",
+        "updateCredential", "deleteCredential", "test_updateCreatedAt",
+        "getAllCredentials", "forEachCredential", "forEachByService",
+        "forEachByService(fts)", "searchCredentials(fts)", "searchCredentials(like)", "indexFullText",
+        "updateSecrets", "countCredentials", "markFtsDeferred",
+        "listCredentials", "listCredentials(after)", "listCredentials(notes)",
+        "listCredentials(notes, after)",
     };
 
-    // UTC now in ISO-8601 "YYYY-MM-DDTHH:MM:SSZ"
-    std::string now_utc_iso8601() {
-        using namespace std::chrono;
-        auto now  = system_clock::now();
-        auto secs = time_point_cast<seconds>(now);
-        std::time_t t = system_clock::to_time_t(secs);
-        std::tm tm{};
-    #if defined(_WIN32)
-        gmtime_s(&tm, &t);
-    #else
-        gmtime_r(&t, &tm);
-    #endif
-        std::ostringstream oss;
-        oss << std::put_time(&tm, "%Y-%m-%dT%H:%M:%SZ");
-        return oss.str();
-    }
+    const char* const kInsertCredentialSql = R"SQL(
+        INSERT INTO credentials(service, username, encrypted_password, iv, notes, created_at)
+        VALUES(?, ?, ?, ?, ?, ?);
+    )SQL";
 
     // Escape %, _ and \ for use in a LIKE ... ESCAPE '\' clause
     std::string escape_like(const std::string& in) {
@@ -48,15 +45,104 @@ namespace {
         return out;
     }
 
+    // Index every row above the highest one already indexed: rows appended
+    // by builds that don't index inserts. One lookup, so it runs every init.
+    const char* const kFtsCatchUpSql =
+        "INSERT INTO credentials_fts(rowid, service, username, notes) "
+        "SELECT id, service, username, notes FROM credentials "
+        "WHERE id > (SELECT coalesce(max(id), 0) FROM credentials_fts_docsize);";
+
+    // Deferred rows left behind by a bulk load that never resumed. They may
+    // sit below rows other connections indexed meanwhile, so this is an
+    // anti-join; it only scans when a deferral mark is present.
+    const char* const kFtsGapSql =
+        "INSERT INTO credentials_fts(rowid, service, username, notes) "
+        "SELECT id, service, username, notes FROM credentials "
+        "WHERE id > (SELECT min(after_id) FROM credentials_fts_deferred) "
+        "AND id NOT IN (SELECT id FROM credentials_fts_docsize);"
+        "DELETE FROM credentials_fts_deferred;";
+
+    // Index every row added since deferFullTextIndex() that is not indexed
+    // yet; another connection may have indexed some of them meanwhile
+    const char* const kFtsResumeSql =
+        "INSERT INTO credentials_fts(rowid, service, username, notes) "
+        "SELECT id, service, username, notes FROM credentials "
+        "WHERE id > ? AND id NOT IN (SELECT id FROM credentials_fts_docsize);";
+
+    // Trigram index tokens are 3 characters; shorter queries can't use it
+    constexpr std::size_t kMinFtsQueryChars = 3;
+
+    std::size_t utf8_length(const std::string& s) {
+        std::size_t n = 0;
+        for (unsigned char ch : s) n += (ch & 0xC0) != 0x80;
+        return n;
+    }
+
+    // FTS5 query: `{col col} : "phrase"`. Quoting makes every character
+    // literal; embedded quotes are doubled.
+    std::string fts_phrase(const std::string& query, unsigned fields) {
+        std::string out = "{";
+        if (fields & kSearchService)  out += " service";
+        if (fields & kSearchUsername) out += " username";
+        if (fields & kSearchNotes)    out += " notes";
+        out += " } : \"";
+        for (char ch : query) {
+            if (ch == '"') out.push_back('"');
+            out.push_back(ch);
+        }
+        out.push_back('"');
+        return out;
+    }
+
+    // Bind the match expression for a FTS or LIKE variant of a search
+    void bind_search(sqlite3* db, sqlite3_stmt* stmt, int idx, const std::string& query,
+                     unsigned fields, bool fts) {
+        const std::string pattern = fts ? fts_phrase(query, fields) : "%" + escape_like(query) + "%";
+        if (sqlite3_bind_text(stmt, idx, pattern.c_str(), -1, SQLITE_TRANSIENT) != SQLITE_OK) {
+            throw std::runtime_error(std::string("bind pattern failed: ") + sqlite3_errmsg(db));
+        }
+    }
+
     // Null-safe read of TEXT columns
     inline std::string read_text_nullable(sqlite3_stmt* st, int col) {
         const unsigned char* p = sqlite3_column_text(st, col);
         return p ? reinterpret_cast<const char*>(p) : std::string{};
     }
+
+    // Non-owning views of TEXT / BLOB columns (valid until the next step/reset)
+    inline std::string_view view_text(sqlite3_stmt* st, int col) {
+        const unsigned char* p = sqlite3_column_text(st, col);
+        if (!p) return {};
+        return { reinterpret_cast<const char*>(p),
+                 static_cast<std::size_t>(sqlite3_column_bytes(st, col)) };
+    }
+
+    inline std::span<const std::uint8_t> view_blob(sqlite3_stmt* st, int col) {
+        const void* p = sqlite3_column_blob(st, col);
+        if (!p) return {};
+        return { static_cast<const std::uint8_t*>(p),
+                 static_cast<std::size_t>(sqlite3_column_bytes(st, col)) };
+    }
+}
+
+// ---- Connection presets ----
+
+DatabaseOptions DatabaseOptions::durable() {
+    return DatabaseOptions{};
+}
+
+DatabaseOptions DatabaseOptions::fast() {
+    DatabaseOptions o;
+    o.journalMode   = JournalMode::Wal;
+    o.synchronous   = Synchronous::Normal;
+    o.cacheSizeKiB  = 64 * 1024;           // 64 MiB
+    o.mmapSizeBytes = 256LL * 1024 * 1024; // 256 MiB
+    o.tempStore     = TempStore::Memory;
+    return o;
 }
 
 // ---- Persistent-connection ctor/dtor ----
-DatabaseManager::DatabaseManager(const std::string& dbPath)
+DatabaseManager::DatabaseManager(const std::string& dbPath, const DatabaseOptions& options)
     : m_dbPath(dbPath), m_db(nullptr)
 {
     int rc = sqlite3_open_v2(
@@ -73,17 +159,135 @@ DatabaseManager::DatabaseManager(const std::string& dbPath)
     }
 
     // Recommended pragmas (safe no-ops if unsupported)
-    exec("PRAGMA foreign_keys = ON;");
-    // exec("PRAGMA journal_mode = WAL;");
+    try {
+        exec("PRAGMA foreign_keys = ON;");
+        applyOptions(options);
+    } catch (...) {
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        throw;
+    }
+}
+
+void DatabaseManager::applyOptions(const DatabaseOptions& options) {
+    using O = DatabaseOptions;
+
+    const char* journal = "WAL";
+    switch (options.journalMode) {
+        case O::JournalMode::Delete:   journal = "DELETE";   break;
+        case O::JournalMode::Truncate: journal = "TRUNCATE"; break;
+        case O::JournalMode::Persist:  journal = "PERSIST";  break;
+        case O::JournalMode::Memory:   journal = "MEMORY";   break;
+        case O::JournalMode::Wal:      journal = "WAL";      break;
+        case O::JournalMode::Off:      journal = "OFF";      break;
+    }
+
+    const char* sync = "FULL";
+    switch (options.synchronous) {
+        case O::Synchronous::Off:    sync = "OFF";    break;
+        case O::Synchronous::Normal: sync = "NORMAL"; break;
+        case O::Synchronous::Full:   sync = "FULL";   break;
+        case O::Synchronous::Extra:  sync = "EXTRA";  break;
+    }
+
+    const char* temp = "DEFAULT";
+    switch (options.tempStore) {
+        case O::TempStore::Default: temp = "DEFAULT"; break;
+        case O::TempStore::File:    temp = "FILE";    break;
+        case O::TempStore::Memory:  temp = "MEMORY";  break;
+    }
+
+    exec(std::string("PRAGMA journal_mode = ") + journal + ";");
+    exec(std::string("PRAGMA synchronous = ") + sync + ";");
+    exec("PRAGMA cache_size = -" + std::to_string(options.cacheSizeKiB) + ";");
+    exec("PRAGMA mmap_size = " + std::to_string(options.mmapSizeBytes) + ";");
+    exec(std::string("PRAGMA temp_store = ") + temp + ";");
+    sqlite3_busy_timeout(m_db, options.busyTimeoutMs);
 }
 
 DatabaseManager::~DatabaseManager() {
+    // Cached statements must be finalized before the connection can close
+    for (auto& stmt : m_stmts) {
+        if (stmt) sqlite3_finalize(stmt);
+        stmt = nullptr;
+    }
     if (m_db) {
         sqlite3_close(m_db);
         m_db = nullptr;
     }
 }
 
+// A cached statement and the slot it came from. Converts to sqlite3_stmt*,
+// so call sites bind and step it directly.
+struct DatabaseManager::StmtHandle {
+    sqlite3_stmt* stmt;
+    StmtId        id;
+    operator sqlite3_stmt*() const { return stmt; }
+};
+
+// Returns a cached statement to its initial state when the caller is done,
+// so it holds no read lock and no stale bindings between uses. The scope is
+// timed into the statement's "sql.<name>" histogram (bind, steps and any
+// per-row visitor work).
+class DatabaseManager::StmtReset {
+public:
+    explicit StmtReset(const StmtHandle& h)
+        : m_stmt(h.stmt)
+#if EPM_INSTRUMENTATION
+        , m_timer(histogramFor(h.id))
+#endif
+    {}
+    ~StmtReset() {
+        sqlite3_reset(m_stmt);
+        sqlite3_clear_bindings(m_stmt);
+    }
+    StmtReset(const StmtReset&) = delete;
+    StmtReset& operator=(const StmtReset&) = delete;
+
+private:
+    sqlite3_stmt* m_stmt;
+#if EPM_INSTRUMENTATION
+    instrumentation::ScopedTimer m_timer;
+
+    static instrumentation::Histogram& histogramFor(StmtId id) {
+        static const auto table = [] {
+            std::array<instrumentation::Histogram*, std::size(kStmtNames)> t{};
+            for (std::size_t i = 0; i < t.size(); ++i)
+                t[i] = &instrumentation::histogram(std::string("sql.") + kStmtNames[i]);
+            return t;
+        }();
+        return *table[static_cast<std::size_t>(id)];
+    }
+#endif
+};
+
+// Return the cached statement for `id`, preparing it on first use.
+// The caller resets it when done (see StmtReset).
+DatabaseManager::StmtHandle DatabaseManager::cachedStmt(StmtId id, const char* sql) const {
+    static_assert(std::size(kStmtNames) == static_cast<std::size_t>(StmtId::Count),
+                  "kStmtNames must list every StmtId");
+
+    sqlite3_stmt*& slot = m_stmts[static_cast<std::size_t>(id)];
+    if (slot) {
+        ++m_stmtStats.hits;
+        return {slot, id};
+    }
+
+    int rc = sqlite3_prepare_v3(m_db, sql, -1, SQLITE_PREPARE_PERSISTENT, &slot, nullptr);
+    if (rc != SQLITE_OK) {
+        slot = nullptr;
+        throw std::runtime_error(std::string("sqlite3_prepare_v3(")
+                                 + kStmtNames[static_cast<std::size_t>(id)] + "): "
+                                 + sqlite3_errmsg(m_db));
+    }
+    ++m_stmtStats.misses;
+    return {slot, id};
+}
+
+StmtCacheStats DatabaseManager::stmtCacheStats() const {
+    return m_stmtStats;
+}
+
 // Run raw SQL (no parameters) on the same connection
 void DatabaseManager::exec(const std::string& sql) const {
     char* errMsg = nullptr;
@@ -99,14 +303,18 @@ void DatabaseManager::exec(const std::string& sql) const {
 void DatabaseManager::init() {
     static const char* kSchema = R"SQL(
 CREATE TABLE IF NOT EXISTS master_auth (
-  id   INTEGER PRIMARY KEY CHECK (id = 1),
-  salt BLOB NOT NULL,
-  hash BLOB NOT NULL
+  id     INTEGER PRIMARY KEY CHECK (id = 1),
+  salt   BLOB NOT NULL,
+  hash   BLOB NOT NULL,
+  scheme INTEGER NOT NULL DEFAULT 1
 );
 
 CREATE TABLE IF NOT EXISTS app_settings (
-  id       INTEGER PRIMARY KEY CHECK (id = 1),
-  kdf_salt BLOB NOT NULL
+  id              INTEGER PRIMARY KEY CHECK (id = 1),
+  kdf_salt        BLOB NOT NULL,
+  kdf_t_cost      INTEGER NOT NULL DEFAULT 3,
+  kdf_m_cost_kib  INTEGER NOT NULL DEFAULT 65536,
+  kdf_parallelism INTEGER NOT NULL DEFAULT 1
 );
 
 CREATE TABLE IF NOT EXISTS credentials (
@@ -120,34 +328,216 @@ CREATE TABLE IF NOT EXISTS credentials (
 );
 CREATE INDEX IF NOT EXISTS idx_credentials_service ON credentials(service);
 CREATE INDEX IF NOT EXISTS idx_credentials_service_user ON credentials(service, username);
+-- Covers listCredentials(): keyset order plus the brief columns
+CREATE INDEX IF NOT EXISTS idx_credentials_created
+  ON credentials(created_at, id, service, username);
 )SQL";
 
     exec(kSchema);
+
+    // Upgrade vaults created before these columns existed
+    ensureColumn("master_auth", "scheme", "INTEGER NOT NULL DEFAULT 1");
+    ensureColumn("app_settings", "kdf_t_cost", "INTEGER NOT NULL DEFAULT 3");
+    ensureColumn("app_settings", "kdf_m_cost_kib", "INTEGER NOT NULL DEFAULT 65536");
+    ensureColumn("app_settings", "kdf_parallelism", "INTEGER NOT NULL DEFAULT 1");
+
+    m_hasFts = initFullTextIndex();
+}
+
+bool DatabaseManager::initFullTextIndex() {
+    // External-content index: stores only the trigram postings, rows are read
+    // from `credentials`. The update trigger only fires for indexed columns,
+    // so re-encrypting secrets never touches it. Weights for ORDER BY rank:
+    // service 10, username 5, notes 1.
+    static const char* kFtsSchema = R"SQL(
+CREATE VIRTUAL TABLE credentials_fts USING fts5(
+  service, username, notes,
+  content='credentials', content_rowid='id', tokenize='trigram'
+);
+INSERT INTO credentials_fts(credentials_fts, rank) VALUES('rank', 'bm25(10.0, 5.0, 1.0)');
+INSERT INTO credentials_fts(credentials_fts) VALUES('rebuild');
+)SQL";
+
+    // No insert trigger: FTS5 flushes its pending postings at the end of
+    // every statement, so indexing row by row from a trigger writes one tiny
+    // segment per row (~6x slower bulk imports). Inserts are indexed per
+    // chunk by indexFullText instead; updates and deletes are rare.
+    // Rows written by other builds (or while indexing is deferred) may not
+    // be indexed yet, and an FTS5 'delete' for postings that don't exist
+    // corrupts the index, so both triggers only touch rows present in the
+    // docsize table. An update leaves an unindexed row to
+    // resumeFullTextIndex() or the init catch-up. Recreated on every init so
+    // vaults keep up with trigger changes.
+    static const char* kFtsTriggers = R"SQL(
+DROP TRIGGER IF EXISTS credentials_fts_ad;
+DROP TRIGGER IF EXISTS credentials_fts_au;
+CREATE TRIGGER credentials_fts_ad AFTER DELETE ON credentials
+WHEN EXISTS (SELECT 1 FROM credentials_fts_docsize WHERE id = old.id) BEGIN
+  INSERT INTO credentials_fts(credentials_fts, rowid, service, username, notes)
+  VALUES ('delete', old.id, old.service, old.username, old.notes);
+END;
+CREATE TRIGGER credentials_fts_au AFTER UPDATE OF service, username, notes ON credentials
+WHEN EXISTS (SELECT 1 FROM credentials_fts_docsize WHERE id = old.id) BEGIN
+  INSERT INTO credentials_fts(credentials_fts, rowid, service, username, notes)
+  VALUES ('delete', old.id, old.service, old.username, old.notes);
+  INSERT INTO credentials_fts(rowid, service, username, notes)
+  VALUES (new.id, new.service, new.username, new.notes);
+END;
+)SQL";
+
+    bool exists = false;
+    {
+        sqlite3_stmt* stmt = nullptr;
+        const char* sql = "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'credentials_fts';";
+        if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(std::string("prepare fts lookup: ") + sqlite3_errmsg(m_db));
+        }
+        exists = sqlite3_step(stmt) == SQLITE_ROW;
+        sqlite3_finalize(stmt);
+    }
+
+    // All or nothing, so a SQLite without FTS5 leaves no half-built index
+    exec("SAVEPOINT init_fts;");
+    try {
+        if (!exists) exec(kFtsSchema); // first time: index existing rows
+        exec(kFtsTriggers);
+        // Rows committed while indexing was deferred leave a mark here (see
+        // markFtsDeferred); resumeFullTextIndex() removes it
+        exec("CREATE TABLE IF NOT EXISTS credentials_fts_deferred (after_id INTEGER PRIMARY KEY);");
+        exec(kFtsGapSql);
+        exec(kFtsCatchUpSql);
+        exec("RELEASE init_fts;");
+        return true;
+    } catch (const std::runtime_error&) {
+        exec("ROLLBACK TO init_fts;");
+        exec("RELEASE init_fts;");
+        return false;
+    }
+}
+
+void DatabaseManager::indexFullText(int firstId, int lastId) {
+    const char* sql = R"SQL(
+        INSERT INTO credentials_fts(rowid, service, username, notes)
+        SELECT id, service, username, notes FROM credentials WHERE id BETWEEN ? AND ?;
+    )SQL";
+    StmtHandle stmt = cachedStmt(StmtId::IndexFullText, sql);
+    StmtReset reset(stmt);
+
+    if (sqlite3_bind_int(stmt, 1, firstId) != SQLITE_OK ||
+        sqlite3_bind_int(stmt, 2, lastId) != SQLITE_OK) {
+        throw std::runtime_error(std::string("bind indexFullText: ") + sqlite3_errmsg(m_db));
+    }
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        throw std::runtime_error(std::string("step indexFullText: ") + sqlite3_errmsg(m_db));
+    }
+}
+
+void DatabaseManager::deferFullTextIndex() {
+    if (m_ftsDeferred) return;
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql = "SELECT coalesce(max(id), 0) FROM credentials;";
+    if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error(std::string("prepare deferFullTextIndex: ") + sqlite3_errmsg(m_db));
+    }
+    const int rc = sqlite3_step(stmt);
+    m_ftsDeferredAfter = rc == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_ROW) {
+        throw std::runtime_error(std::string("step deferFullTextIndex: ") + sqlite3_errmsg(m_db));
+    }
+    m_ftsDeferred = true;
+}
+
+void DatabaseManager::markFtsDeferred() {
+    const char* sql = "INSERT OR IGNORE INTO credentials_fts_deferred(after_id) VALUES(?);";
+    StmtHandle stmt = cachedStmt(StmtId::MarkFtsDeferred, sql);
+    StmtReset reset(stmt);
+
+    if (sqlite3_bind_int(stmt, 1, m_ftsDeferredAfter) != SQLITE_OK) {
+        throw std::runtime_error(std::string("bind markFtsDeferred: ") + sqlite3_errmsg(m_db));
+    }
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        throw std::runtime_error(std::string("step markFtsDeferred: ") + sqlite3_errmsg(m_db));
+    }
+}
+
+void DatabaseManager::resumeFullTextIndex() {
+    if (m_hasFts && m_ftsDeferred) {
+        EPM_TIMED("sql.indexFullText");
+        // One big insert writes few, large segments; merging them as they are
+        // flushed only slows it down. 4 is the FTS5 default we restore.
+        exec("INSERT INTO credentials_fts(credentials_fts, rank) VALUES('automerge', 0);");
+        try {
+            sqlite3_stmt* stmt = nullptr;
+            if (sqlite3_prepare_v2(m_db, kFtsResumeSql, -1, &stmt, nullptr) != SQLITE_OK) {
+                throw std::runtime_error(std::string("prepare resumeFullTextIndex: ") + sqlite3_errmsg(m_db));
+            }
+            const int rc = sqlite3_bind_int(stmt, 1, m_ftsDeferredAfter) == SQLITE_OK
+                ? sqlite3_step(stmt) : SQLITE_ERROR;
+            sqlite3_finalize(stmt);
+            if (rc != SQLITE_DONE) {
+                throw std::runtime_error(std::string("step resumeFullTextIndex: ") + sqlite3_errmsg(m_db));
+            }
+        } catch (...) {
+            exec("INSERT INTO credentials_fts(credentials_fts, rank) VALUES('automerge', 4);");
+            throw;
+        }
+        exec("INSERT INTO credentials_fts(credentials_fts, rank) VALUES('automerge', 4);");
+        exec("DELETE FROM credentials_fts_deferred WHERE after_id = "
+             + std::to_string(m_ftsDeferredAfter) + ";");
+    }
+    m_ftsDeferred = false;
+}
+
+bool DatabaseManager::useFullText(const std::string& query) const {
+    return m_hasFts && utf8_length(query) >= kMinFtsQueryChars;
+}
+
+void DatabaseManager::ensureColumn(const char* table, const char* column, const char* decl) {
+    // PRAGMA arguments can't be bound; table names are internal constants
+    const std::string pragma = std::string("PRAGMA table_info(") + table + ");";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(m_db, pragma.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error(std::string("prepare table_info: ") + sqlite3_errmsg(m_db));
+    }
+    bool found = false;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const auto* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (name && std::strcmp(name, column) == 0) { found = true; break; }
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        throw std::runtime_error(std::string("step table_info: ") + sqlite3_errmsg(m_db));
+    }
+    if (!found) {
+        exec(std::string("ALTER TABLE ") + table + " ADD COLUMN " + column + " " + decl + ";");
+    }
 }
 
 // ---- Master auth (id=1)
 
 void DatabaseManager::storeMaster(const std::vector<std::uint8_t>& salt,
-                                  const std::vector<std::uint8_t>& hash) {
+                                  const std::vector<std::uint8_t>& hash,
+                                  int scheme) {
     const char* sql =
-        "INSERT INTO master_auth (id, salt, hash) VALUES (1, ?, ?) "
-        "ON CONFLICT(id) DO UPDATE SET salt=excluded.salt, hash=excluded.hash;";
+        "INSERT INTO master_auth (id, salt, hash, scheme) VALUES (1, ?, ?, ?) "
+        "ON CONFLICT(id) DO UPDATE SET salt=excluded.salt, hash=excluded.hash, "
+        "scheme=excluded.scheme;";
 
-    sqlite3_stmt* stmtRaw = nullptr;
-    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmtRaw, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("sqlite3_prepare_v2(storeMaster): ")
-                                 + sqlite3_errmsg(m_db));
-    }
-    std::unique_ptr<sqlite3_stmt, StmtCloser> stmt(stmtRaw);
+    StmtHandle stmt = cachedStmt(StmtId::StoreMaster, sql);
+    StmtReset reset(stmt);
 
-    rc = sqlite3_bind_blob(stmt.get(), 1, salt.data(), static_cast<int>(salt.size()), SQLITE_TRANSIENT);
+    int rc = sqlite3_bind_blob(stmt, 1, salt.data(), static_cast<int>(salt.size()), SQLITE_TRANSIENT);
     if (rc != SQLITE_OK) throw std::runtime_error(std::string("bind salt: ") + sqlite3_errmsg(m_db));
 
-    rc = sqlite3_bind_blob(stmt.get(), 2, hash.data(), static_cast<int>(hash.size()), SQLITE_TRANSIENT);
+    rc = sqlite3_bind_blob(stmt, 2, hash.data(), static_cast<int>(hash.size()), SQLITE_TRANSIENT);
     if (rc != SQLITE_OK) throw std::runtime_error(std::string("bind hash: ") + sqlite3_errmsg(m_db));
 
-    rc = sqlite3_step(stmt.get());
+    rc = sqlite3_bind_int(stmt, 3, scheme);
+    if (rc != SQLITE_OK) throw std::runtime_error(std::string("bind scheme: ") + sqlite3_errmsg(m_db));
+
+    rc = sqlite3_step(stmt);
     if (rc != SQLITE_DONE) {
         throw std::runtime_error(std::string("step storeMaster: ") + sqlite3_errmsg(m_db));
     }
@@ -156,20 +546,15 @@ void DatabaseManager::storeMaster(const std::vector<std::uint8_t>& salt,
 std::optional<std::pair<std::vector<std::uint8_t>, std::vector<std::uint8_t>>>
 DatabaseManager::loadMaster() const {
     const char* sql = "SELECT salt, hash FROM master_auth WHERE id = 1;";
-    sqlite3_stmt* stmtRaw = nullptr;
-    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmtRaw, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("sqlite3_prepare_v2(loadMaster): ")
-                                 + sqlite3_errmsg(m_db));
-    }
-    std::unique_ptr<sqlite3_stmt, StmtCloser> stmt(stmtRaw);
+    StmtHandle stmt = cachedStmt(StmtId::LoadMaster, sql);
+    StmtReset reset(stmt);
 
-    rc = sqlite3_step(stmt.get());
+    int rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
-        const void* saltPtr = sqlite3_column_blob(stmt.get(), 0);
-        int saltBytes = sqlite3_column_bytes(stmt.get(), 0);
-        const void* hashPtr = sqlite3_column_blob(stmt.get(), 1);
-        int hashBytes = sqlite3_column_bytes(stmt.get(), 1);
+        const void* saltPtr = sqlite3_column_blob(stmt, 0);
+        int saltBytes = sqlite3_column_bytes(stmt, 0);
+        const void* hashPtr = sqlite3_column_blob(stmt, 1);
+        int hashBytes = sqlite3_column_bytes(stmt, 1);
 
         std::vector<std::uint8_t> saltVec, hashVec;
         if (saltPtr && saltBytes > 0) {
@@ -188,6 +573,21 @@ DatabaseManager::loadMaster() const {
     }
 }
 
+std::optional<int> DatabaseManager::loadMasterScheme() const {
+    const char* sql = "SELECT scheme FROM master_auth WHERE id = 1;";
+    StmtHandle stmt = cachedStmt(StmtId::LoadMasterScheme, sql);
+    StmtReset reset(stmt);
+
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        return sqlite3_column_int(stmt, 0);
+    } else if (rc == SQLITE_DONE) {
+        return std::nullopt;
+    } else {
+        throw std::runtime_error(std::string("sqlite3_step(loadMasterScheme): ") + sqlite3_errmsg(m_db));
+    }
+}
+
 // ---- App settings (KDF salt at id=1)
 
 void DatabaseManager::storeKdfSalt(const std::vector<std::uint8_t>& kdfSalt) {
@@ -199,21 +599,16 @@ void DatabaseManager::storeKdfSalt(const std::vector<std::uint8_t>& kdfSalt) {
         "INSERT INTO app_settings (id, kdf_salt) VALUES (1, ?) "
         "ON CONFLICT(id) DO UPDATE SET kdf_salt=excluded.kdf_salt;";
 
-    sqlite3_stmt* stmtRaw = nullptr;
-    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmtRaw, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("sqlite3_prepare_v2(storeKdfSalt): ")
-                                 + sqlite3_errmsg(m_db));
-    }
-    std::unique_ptr<sqlite3_stmt, StmtCloser> stmt(stmtRaw);
+    StmtHandle stmt = cachedStmt(StmtId::StoreKdfSalt, sql);
+    StmtReset reset(stmt);
 
-    rc = sqlite3_bind_blob(stmt.get(), 1, kdfSalt.data(),
+    int rc = sqlite3_bind_blob(stmt, 1, kdfSalt.data(),
                            static_cast<int>(kdfSalt.size()), SQLITE_TRANSIENT);
     if (rc != SQLITE_OK) {
         throw std::runtime_error(std::string("bind kdf_salt: ") + sqlite3_errmsg(m_db));
     }
 
-    rc = sqlite3_step(stmt.get());
+    rc = sqlite3_step(stmt);
     if (rc != SQLITE_DONE) {
         throw std::runtime_error(std::string("step storeKdfSalt: ") + sqlite3_errmsg(m_db));
     }
@@ -221,18 +616,13 @@ void DatabaseManager::storeKdfSalt(const std::vector<std::uint8_t>& kdfSalt) {
 
 std::optional<std::vector<std::uint8_t>> DatabaseManager::loadKdfSalt() const {
     const char* sql = "SELECT kdf_salt FROM app_settings WHERE id = 1;";
-    sqlite3_stmt* stmtRaw = nullptr;
-    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmtRaw, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("sqlite3_prepare_v2(loadKdfSalt): ")
-                                 + sqlite3_errmsg(m_db));
-    }
-    std::unique_ptr<sqlite3_stmt, StmtCloser> stmt(stmtRaw);
+    StmtHandle stmt = cachedStmt(StmtId::LoadKdfSalt, sql);
+    StmtReset reset(stmt);
 
-    rc = sqlite3_step(stmt.get());
+    int rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
-        const void* ptr = sqlite3_column_blob(stmt.get(), 0);
-        int nbytes = sqlite3_column_bytes(stmt.get(), 0);
+        const void* ptr = sqlite3_column_blob(stmt, 0);
+        int nbytes = sqlite3_column_bytes(stmt, 0);
         std::vector<std::uint8_t> salt;
         if (ptr && nbytes > 0) {
             const auto* b = static_cast<const std::uint8_t*>(ptr);
@@ -246,6 +636,54 @@ std::optional<std::vector<std::uint8_t>> DatabaseManager::loadKdfSalt() const {
     }
 }
 
+void DatabaseManager::storeKdfParams(const KdfParams& params) {
+    params.validate();
+
+    const char* sql =
+        "UPDATE app_settings SET kdf_t_cost = ?, kdf_m_cost_kib = ?, kdf_parallelism = ? "
+        "WHERE id = 1;";
+
+    StmtHandle stmt = cachedStmt(StmtId::StoreKdfParams, sql);
+    StmtReset reset(stmt);
+
+    if (sqlite3_bind_int64(stmt, 1, params.tCost) != SQLITE_OK ||
+        sqlite3_bind_int64(stmt, 2, params.mCostKiB) != SQLITE_OK ||
+        sqlite3_bind_int64(stmt, 3, params.parallelism) != SQLITE_OK) {
+        throw std::runtime_error(std::string("bind kdf params: ") + sqlite3_errmsg(m_db));
+    }
+
+    int rc = sqlite3_step(stmt);
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(std::string("step storeKdfParams: ") + sqlite3_errmsg(m_db));
+    }
+    if (sqlite3_changes(m_db) != 1) {
+        throw std::logic_error("storeKdfParams: no app_settings row (store kdf_salt first)");
+    }
+}
+
+std::optional<KdfParams> DatabaseManager::loadKdfParams() const {
+    const char* sql =
+        "SELECT kdf_t_cost, kdf_m_cost_kib, kdf_parallelism FROM app_settings WHERE id = 1;";
+    StmtHandle stmt = cachedStmt(StmtId::LoadKdfParams, sql);
+    StmtReset reset(stmt);
+
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        auto column = [stmt](int i) -> std::uint32_t {
+            const sqlite3_int64 v = sqlite3_column_int64(stmt, i);
+            if (v < 0 || v > UINT32_MAX) throw std::runtime_error("loadKdfParams: value out of range");
+            return static_cast<std::uint32_t>(v);
+        };
+        KdfParams params{ column(0), column(1), column(2) };
+        params.validate();
+        return params;
+    } else if (rc == SQLITE_DONE) {
+        return std::nullopt;
+    } else {
+        throw std::runtime_error(std::string("sqlite3_step(loadKdfParams): ") + sqlite3_errmsg(m_db));
+    }
+}
+
 // --------- Encrypted credentials CRUD ---------
 
 int DatabaseManager::addCredential(const std::string& service,
@@ -254,37 +692,106 @@ int DatabaseManager::addCredential(const std::string& service,
                                    const std::vector<std::uint8_t>& iv,
                                    const std::string& notes)
 {
-    const char* sql = R"SQL(
-        INSERT INTO credentials(service, username, encrypted_password, iv, notes, created_at)
-        VALUES(?, ?, ?, ?, ?, ?);
-    )SQL";
+    StmtHandle stmt = cachedStmt(StmtId::AddCredential, kInsertCredentialSql);
+    StmtReset reset(stmt);
+
+    const std::string ts = iso8601UtcNow();
+    if (!m_hasFts) {
+        const int id = insertCredential(stmt, service, username, encPassword, iv, notes, ts);
+        notifyUpsert(id, service, username, ts);
+        return id;
+    }
 
-    sqlite3_stmt* stmtRaw = nullptr;
-    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmtRaw, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("prepare insert credential failed: ")
-                                 + sqlite3_errmsg(m_db));
+    // Row + index entry (or deferral mark) commit together
+    const bool ownTxn = !inTransaction();
+    if (ownTxn) beginTransaction();
+    try {
+        if (m_ftsDeferred) markFtsDeferred();
+        const int id = insertCredential(stmt, service, username, encPassword, iv, notes, ts);
+        if (!m_ftsDeferred) indexFullText(id, id);
+        notifyUpsert(id, service, username, ts);
+        if (ownTxn) commit();
+        return id;
+    } catch (...) {
+        if (ownTxn) {
+            try { rollback(); } catch (...) {}
+        }
+        throw;
+    }
+}
+
+std::vector<int> DatabaseManager::addCredentials(std::span<const NewCredential> rows,
+                                                 std::size_t batchSize)
+{
+    if (batchSize == 0) {
+        throw std::invalid_argument("addCredentials: batchSize must be > 0");
+    }
+
+    std::vector<int> ids;
+    ids.reserve(rows.size());
+    if (rows.empty()) return ids;
+
+    // Join the caller's transaction if one is open; otherwise commit per chunk
+    const bool ownTxn = !inTransaction();
+
+    StmtHandle stmt = cachedStmt(StmtId::AddCredential, kInsertCredentialSql);
+    StmtReset reset(stmt);
+
+    const std::string now = iso8601UtcNow();
+    std::size_t i = 0;
+    while (i < rows.size()) {
+        const std::size_t end = ownTxn ? std::min(rows.size(), i + batchSize) : rows.size();
+        const std::size_t chunkStart = i;
+        if (ownTxn) beginTransaction();
+        try {
+            if (m_hasFts && m_ftsDeferred) markFtsDeferred();
+            for (; i < end; ++i) {
+                const NewCredential& r = rows[i];
+                const std::string& createdAt = r.created_at.empty() ? now : r.created_at;
+                ids.push_back(insertCredential(stmt, r.service, r.username,
+                                               r.enc_password, r.iv, r.notes, createdAt));
+                sqlite3_reset(stmt);
+                notifyUpsert(ids.back(), r.service, r.username, createdAt);
+            }
+            // One index statement per chunk (see initFullTextIndex)
+            if (m_hasFts && !m_ftsDeferred) indexFullText(ids[chunkStart], ids.back());
+            if (ownTxn) commit();
+        } catch (...) {
+            if (ownTxn) {
+                try { rollback(); } catch (...) {}
+            }
+            throw;
+        }
     }
-    std::unique_ptr<sqlite3_stmt, StmtCloser> stmt(stmtRaw);
+    return ids;
+}
 
+// Bind one row into the (cached) insert statement and step it.
+// Values are bound SQLITE_STATIC: they outlive the step, so nothing is copied.
+int DatabaseManager::insertCredential(sqlite3_stmt* stmt,
+                                      const std::string& service,
+                                      const std::string& username,
+                                      const std::vector<std::uint8_t>& encPassword,
+                                      const std::vector<std::uint8_t>& iv,
+                                      const std::string& notes,
+                                      const std::string& createdAt)
+{
     auto bind_ok = [&](int code, const char* what) {
         if (code != SQLITE_OK) {
             throw std::runtime_error(std::string(what) + ": " + sqlite3_errmsg(m_db));
         }
     };
 
-    bind_ok(sqlite3_bind_text(stmt.get(), 1, service.c_str(),  -1, SQLITE_TRANSIENT),  "bind service");
-    bind_ok(sqlite3_bind_text(stmt.get(), 2, username.c_str(), -1, SQLITE_TRANSIENT),  "bind username");
-    bind_ok(sqlite3_bind_blob(stmt.get(), 3, encPassword.data(),
-                              static_cast<int>(encPassword.size()), SQLITE_TRANSIENT), "bind encPassword");
-    bind_ok(sqlite3_bind_blob(stmt.get(), 4, iv.data(),
-                              static_cast<int>(iv.size()),          SQLITE_TRANSIENT), "bind iv");
-    bind_ok(sqlite3_bind_text(stmt.get(), 5, notes.c_str(),     -1, SQLITE_TRANSIENT), "bind notes");
-
-    const std::string ts = now_utc_iso8601();
-    bind_ok(sqlite3_bind_text(stmt.get(), 6, ts.c_str(), -1, SQLITE_TRANSIENT), "bind created_at");
+    bind_ok(sqlite3_bind_text(stmt, 1, service.c_str(),  -1, SQLITE_STATIC),  "bind service");
+    bind_ok(sqlite3_bind_text(stmt, 2, username.c_str(), -1, SQLITE_STATIC),  "bind username");
+    bind_ok(sqlite3_bind_blob(stmt, 3, encPassword.data(),
+                              static_cast<int>(encPassword.size()), SQLITE_STATIC), "bind encPassword");
+    bind_ok(sqlite3_bind_blob(stmt, 4, iv.data(),
+                              static_cast<int>(iv.size()),          SQLITE_STATIC), "bind iv");
+    bind_ok(sqlite3_bind_text(stmt, 5, notes.c_str(),     -1, SQLITE_STATIC), "bind notes");
+    bind_ok(sqlite3_bind_text(stmt, 6, createdAt.c_str(), -1, SQLITE_STATIC), "bind created_at");
 
-    rc = sqlite3_step(stmt.get());
+    int rc = sqlite3_step(stmt);
     if (rc != SQLITE_DONE) {
         throw std::runtime_error(std::string("insert credential step failed: ")
                                  + sqlite3_errmsg(m_db));
@@ -300,42 +807,37 @@ std::optional<Credential> DatabaseManager::getCredentialById(int id) const {
         FROM credentials WHERE id = ?;
     )SQL";
 
-    sqlite3_stmt* stmtRaw = nullptr;
-    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmtRaw, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("prepare getCredentialById failed: ")
-                                 + sqlite3_errmsg(m_db));
-    }
-    std::unique_ptr<sqlite3_stmt, StmtCloser> stmt(stmtRaw);
+    StmtHandle stmt = cachedStmt(StmtId::GetCredentialById, sql);
+    StmtReset reset(stmt);
 
-    rc = sqlite3_bind_int(stmt.get(), 1, id);
+    int rc = sqlite3_bind_int(stmt, 1, id);
     if (rc != SQLITE_OK) {
         throw std::runtime_error(std::string("bind id failed: ") + sqlite3_errmsg(m_db));
     }
 
-    rc = sqlite3_step(stmt.get());
+    rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
         Credential c{};
-        c.id       = sqlite3_column_int(stmt.get(), 0);
-        c.service  = read_text_nullable(stmt.get(), 1);
-        c.username = read_text_nullable(stmt.get(), 2);
+        c.id       = sqlite3_column_int(stmt, 0);
+        c.service  = read_text_nullable(stmt, 1);
+        c.username = read_text_nullable(stmt, 2);
 
-        const void* encPtr = sqlite3_column_blob(stmt.get(), 3);
-        int encLen = sqlite3_column_bytes(stmt.get(), 3);
+        const void* encPtr = sqlite3_column_blob(stmt, 3);
+        int encLen = sqlite3_column_bytes(stmt, 3);
         if (encPtr && encLen > 0) {
             const auto* p = static_cast<const std::uint8_t*>(encPtr);
             c.enc_password.assign(p, p + encLen);
         }
 
-        const void* ivPtr = sqlite3_column_blob(stmt.get(), 4);
-        int ivLen = sqlite3_column_bytes(stmt.get(), 4);
+        const void* ivPtr = sqlite3_column_blob(stmt, 4);
+        int ivLen = sqlite3_column_bytes(stmt, 4);
         if (ivPtr && ivLen > 0) {
             const auto* p = static_cast<const std::uint8_t*>(ivPtr);
             c.iv.assign(p, p + ivLen);
         }
 
-        c.notes      = read_text_nullable(stmt.get(), 5);
-        c.created_at = read_text_nullable(stmt.get(), 6);
+        c.notes      = read_text_nullable(stmt, 5);
+        c.created_at = read_text_nullable(stmt, 6);
 
         return c;
     } else if (rc == SQLITE_DONE) {
@@ -346,50 +848,93 @@ std::optional<Credential> DatabaseManager::getCredentialById(int id) const {
     }
 }
 
-std::vector<Credential> DatabaseManager::searchByService(const std::string& query) const {
+std::optional<CredentialMeta> DatabaseManager::getCredentialMeta(int id) const {
     const char* sql = R"SQL(
-        SELECT id, service, username, encrypted_password, iv, notes, created_at
-        FROM credentials WHERE service LIKE ? ESCAPE '\'
-        ORDER BY created_at DESC, id DESC;
+        SELECT id, service, username, notes, created_at
+        FROM credentials WHERE id = ?;
     )SQL";
 
-    sqlite3_stmt* stmtRaw = nullptr;
-    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmtRaw, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("prepare searchByService failed: ")
+    StmtHandle stmt = cachedStmt(StmtId::GetCredentialMeta, sql);
+    StmtReset reset(stmt);
+
+    if (sqlite3_bind_int(stmt, 1, id) != SQLITE_OK) {
+        throw std::runtime_error(std::string("bind id failed: ") + sqlite3_errmsg(m_db));
+    }
+
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_DONE) return std::nullopt;
+    if (rc != SQLITE_ROW) {
+        throw std::runtime_error(std::string("step getCredentialMeta failed: ")
                                  + sqlite3_errmsg(m_db));
     }
-    std::unique_ptr<sqlite3_stmt, StmtCloser> stmt(stmtRaw);
+    CredentialMeta m{};
+    m.id         = sqlite3_column_int(stmt, 0);
+    m.service    = read_text_nullable(stmt, 1);
+    m.username   = read_text_nullable(stmt, 2);
+    m.notes      = read_text_nullable(stmt, 3);
+    m.created_at = read_text_nullable(stmt, 4);
+    return m;
+}
 
-    std::string pattern = "%" + escape_like(query) + "%";
-    rc = sqlite3_bind_text(stmt.get(), 1, pattern.c_str(), -1, SQLITE_TRANSIENT);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("bind pattern failed: ") + sqlite3_errmsg(m_db));
+bool DatabaseManager::readSecret(int id, const CredentialVisitor& visit) const {
+    // Same column layout as the scans so visitRows can hand out views
+    const char* sql = R"SQL(
+        SELECT id, service, username, encrypted_password, iv, '', created_at
+        FROM credentials WHERE id = ?;
+    )SQL";
+
+    StmtHandle stmt = cachedStmt(StmtId::ReadSecret, sql);
+    StmtReset reset(stmt);
+
+    if (sqlite3_bind_int(stmt, 1, id) != SQLITE_OK) {
+        throw std::runtime_error(std::string("bind id failed: ") + sqlite3_errmsg(m_db));
     }
+    return visitRows(stmt, visit, "readSecret") == 1;
+}
+
+std::vector<Credential> DatabaseManager::searchByService(const std::string& query) const {
+    const char* sql = R"SQL(
+        SELECT id, service, username, encrypted_password, iv, notes, created_at
+        FROM credentials WHERE service LIKE ? ESCAPE '\'
+        ORDER BY created_at DESC, id DESC;
+    )SQL";
+    const char* ftsSql = R"SQL(
+        SELECT id, service, username, encrypted_password, iv, notes, created_at
+        FROM credentials
+        WHERE id IN (SELECT rowid FROM credentials_fts WHERE credentials_fts MATCH ?)
+        ORDER BY created_at DESC, id DESC;
+    )SQL";
+
+    const bool fts = useFullText(query);
+    StmtHandle stmt = fts ? cachedStmt(StmtId::SearchByServiceFts, ftsSql)
+                           : cachedStmt(StmtId::SearchByService, sql);
+    StmtReset reset(stmt);
+    bind_search(m_db, stmt, 1, query, kSearchService, fts);
 
+    int rc;
     std::vector<Credential> out;
-    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
         Credential c{};
-        c.id       = sqlite3_column_int(stmt.get(), 0);
-        c.service  = read_text_nullable(stmt.get(), 1);
-        c.username = read_text_nullable(stmt.get(), 2);
+        c.id       = sqlite3_column_int(stmt, 0);
+        c.service  = read_text_nullable(stmt, 1);
+        c.username = read_text_nullable(stmt, 2);
 
-        const void* encPtr = sqlite3_column_blob(stmt.get(), 3);
-        int encLen = sqlite3_column_bytes(stmt.get(), 3);
+        const void* encPtr = sqlite3_column_blob(stmt, 3);
+        int encLen = sqlite3_column_bytes(stmt, 3);
         if (encPtr && encLen > 0) {
             const auto* p = static_cast<const std::uint8_t*>(encPtr);
             c.enc_password.assign(p, p + encLen);
         }
 
-        const void* ivPtr = sqlite3_column_blob(stmt.get(), 4);
-        int ivLen = sqlite3_column_bytes(stmt.get(), 4);
+        const void* ivPtr = sqlite3_column_blob(stmt, 4);
+        int ivLen = sqlite3_column_bytes(stmt, 4);
         if (ivPtr && ivLen > 0) {
             const auto* p = static_cast<const std::uint8_t*>(ivPtr);
             c.iv.assign(p, p + ivLen);
         }
 
-        c.notes      = read_text_nullable(stmt.get(), 5);
-        c.created_at = read_text_nullable(stmt.get(), 6);
+        c.notes      = read_text_nullable(stmt, 5);
+        c.created_at = read_text_nullable(stmt, 6);
 
         out.push_back(std::move(c));
     }
@@ -412,13 +957,8 @@ void DatabaseManager::updateCredential(int id,
         WHERE id = ?;
     )SQL";
 
-    sqlite3_stmt* stmtRaw = nullptr;
-    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmtRaw, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("prepare updateCredential failed: ")
-                                 + sqlite3_errmsg(m_db));
-    }
-    std::unique_ptr<sqlite3_stmt, StmtCloser> stmt(stmtRaw);
+    StmtHandle stmt = cachedStmt(StmtId::UpdateCredential, sql);
+    StmtReset reset(stmt);
 
     auto bind_ok = [&](int code, const char* what) {
         if (code != SQLITE_OK) {
@@ -426,42 +966,105 @@ void DatabaseManager::updateCredential(int id,
         }
     };
 
-    bind_ok(sqlite3_bind_text(stmt.get(), 1, newUsername.c_str(), -1, SQLITE_TRANSIENT), "bind username");
-    bind_ok(sqlite3_bind_blob(stmt.get(), 2, newEncPassword.data(),
+    bind_ok(sqlite3_bind_text(stmt, 1, newUsername.c_str(), -1, SQLITE_TRANSIENT), "bind username");
+    bind_ok(sqlite3_bind_blob(stmt, 2, newEncPassword.data(),
                               static_cast<int>(newEncPassword.size()), SQLITE_TRANSIENT), "bind enc");
-    bind_ok(sqlite3_bind_blob(stmt.get(), 3, newIv.data(),
+    bind_ok(sqlite3_bind_blob(stmt, 3, newIv.data(),
                               static_cast<int>(newIv.size()),          SQLITE_TRANSIENT), "bind iv");
-    bind_ok(sqlite3_bind_text(stmt.get(), 4, newNotes.c_str(), -1, SQLITE_TRANSIENT), "bind notes");
-    bind_ok(sqlite3_bind_int (stmt.get(), 5, id), "bind id");
+    bind_ok(sqlite3_bind_text(stmt, 4, newNotes.c_str(), -1, SQLITE_TRANSIENT), "bind notes");
+    bind_ok(sqlite3_bind_int (stmt, 5, id), "bind id");
 
-    rc = sqlite3_step(stmt.get());
+    int rc = sqlite3_step(stmt);
     if (rc != SQLITE_DONE) {
         throw std::runtime_error(std::string("updateCredential step failed: ")
                                  + sqlite3_errmsg(m_db));
     }
+    if (m_observer && sqlite3_changes(m_db) > 0) notifyReload(id);
 }
 
 void DatabaseManager::deleteCredential(int id) {
     const char* sql = "DELETE FROM credentials WHERE id = ?;";
 
-    sqlite3_stmt* stmtRaw = nullptr;
-    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmtRaw, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("prepare deleteCredential failed: ")
-                                 + sqlite3_errmsg(m_db));
-    }
-    std::unique_ptr<sqlite3_stmt, StmtCloser> stmt(stmtRaw);
+    StmtHandle stmt = cachedStmt(StmtId::DeleteCredential, sql);
+    StmtReset reset(stmt);
 
-    rc = sqlite3_bind_int(stmt.get(), 1, id);
+    int rc = sqlite3_bind_int(stmt, 1, id);
     if (rc != SQLITE_OK) {
         throw std::runtime_error(std::string("bind id failed: ") + sqlite3_errmsg(m_db));
     }
 
-    rc = sqlite3_step(stmt.get());
+    rc = sqlite3_step(stmt);
     if (rc != SQLITE_DONE) {
         throw std::runtime_error(std::string("deleteCredential step failed: ")
                                  + sqlite3_errmsg(m_db));
     }
+    if (sqlite3_changes(m_db) > 0) notifyErase(id);
+}
+
+void DatabaseManager::updateSecrets(std::span<const SecretUpdate> updates) {
+    if (updates.empty()) return;
+
+    const char* sql = "UPDATE credentials SET encrypted_password = ?, iv = ? WHERE id = ?;";
+
+    StmtHandle stmt = cachedStmt(StmtId::UpdateSecret, sql);
+    StmtReset reset(stmt);
+
+    const bool ownTxn = !inTransaction();
+    if (ownTxn) beginTransaction();
+    try {
+        for (const SecretUpdate& u : updates) {
+            if (sqlite3_bind_blob(stmt, 1, u.enc_password.data(),
+                                  static_cast<int>(u.enc_password.size()), SQLITE_STATIC) != SQLITE_OK ||
+                sqlite3_bind_blob(stmt, 2, u.iv.data(),
+                                  static_cast<int>(u.iv.size()), SQLITE_STATIC) != SQLITE_OK ||
+                sqlite3_bind_int(stmt, 3, u.id) != SQLITE_OK) {
+                throw std::runtime_error(std::string("bind updateSecrets failed: ")
+                                         + sqlite3_errmsg(m_db));
+            }
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                throw std::runtime_error(std::string("updateSecrets step failed: ")
+                                         + sqlite3_errmsg(m_db));
+            }
+            sqlite3_reset(stmt);
+        }
+        if (ownTxn) commit();
+    } catch (...) {
+        if (ownTxn) {
+            try { rollback(); } catch (...) {}
+        }
+        throw;
+    }
+}
+
+std::size_t DatabaseManager::countCredentials() const {
+    const char* sql = "SELECT COUNT(*) FROM credentials;";
+
+    StmtHandle stmt = cachedStmt(StmtId::CountCredentials, sql);
+    StmtReset reset(stmt);
+
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        throw std::runtime_error(std::string("step countCredentials failed: ")
+                                 + sqlite3_errmsg(m_db));
+    }
+    return static_cast<std::size_t>(sqlite3_column_int64(stmt, 0));
+}
+
+std::vector<std::string> DatabaseManager::quickCheck() const {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(m_db, "PRAGMA quick_check;", -1, &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error(std::string("prepare quick_check: ") + sqlite3_errmsg(m_db));
+    }
+    std::vector<std::string> problems;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        std::string line = read_text_nullable(stmt, 0);
+        if (line != "ok") problems.push_back(std::move(line));
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(std::string("step quick_check: ") + sqlite3_errmsg(m_db));
+    }
+    return problems;
 }
 
 // ---- Test helper and transactions ----
@@ -469,30 +1072,295 @@ void DatabaseManager::deleteCredential(int id) {
 void DatabaseManager::test_updateCreatedAt(int id, const std::string& createdAt) {
     // Safer: bind instead of string concatenation
     const char* sql = "UPDATE credentials SET created_at = ? WHERE id = ?;";
-    sqlite3_stmt* stmtRaw = nullptr;
-    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmtRaw, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("prepare test_updateCreatedAt failed: ")
-                                 + sqlite3_errmsg(m_db));
-    }
-    std::unique_ptr<sqlite3_stmt, StmtCloser> stmt(stmtRaw);
+    StmtHandle stmt = cachedStmt(StmtId::UpdateCreatedAt, sql);
+    StmtReset reset(stmt);
 
-    rc = sqlite3_bind_text(stmt.get(), 1, createdAt.c_str(), -1, SQLITE_TRANSIENT);
+    int rc = sqlite3_bind_text(stmt, 1, createdAt.c_str(), -1, SQLITE_TRANSIENT);
     if (rc != SQLITE_OK) throw std::runtime_error(std::string("bind ts failed: ") + sqlite3_errmsg(m_db));
 
-    rc = sqlite3_bind_int(stmt.get(), 2, id);
+    rc = sqlite3_bind_int(stmt, 2, id);
     if (rc != SQLITE_OK) throw std::runtime_error(std::string("bind id failed: ") + sqlite3_errmsg(m_db));
 
-    rc = sqlite3_step(stmt.get());
+    rc = sqlite3_step(stmt);
     if (rc != SQLITE_DONE) {
         throw std::runtime_error(std::string("step test_updateCreatedAt failed: ")
                                  + sqlite3_errmsg(m_db));
     }
+    if (m_observer && sqlite3_changes(m_db) > 0) notifyReload(id);
 }
 
-void DatabaseManager::beginTransaction() { exec("BEGIN IMMEDIATE;"); }
-void DatabaseManager::commit()           { exec("COMMIT;"); }
-void DatabaseManager::rollback()         { exec("ROLLBACK;"); }
+std::string DatabaseManager::test_pragma(const std::string& name) const {
+    // Pragma names can't be bound; callers pass constants
+    const std::string sql = "PRAGMA " + name + ";";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error(std::string("prepare test_pragma: ") + sqlite3_errmsg(m_db));
+    }
+    const int rc = sqlite3_step(stmt);
+    std::string value = rc == SQLITE_ROW ? read_text_nullable(stmt, 0) : std::string{};
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_ROW) {
+        throw std::runtime_error(std::string("step test_pragma: ") + sqlite3_errmsg(m_db));
+    }
+    return value;
+}
+
+void DatabaseManager::beginTransaction() {
+    EPM_TIMED("sql.begin");
+    exec("BEGIN IMMEDIATE;");
+}
+bool DatabaseManager::inTransaction() const { return sqlite3_get_autocommit(m_db) == 0; }
+
+void DatabaseManager::commit() {
+    {
+        EPM_TIMED("sql.commit");
+        exec("COMMIT;");
+    }
+    // Swap out first so an observer that writes back can't see a half-flushed queue
+    std::vector<PendingChange> pending;
+    pending.swap(m_pending);
+    if (!m_observer) return;
+    for (const PendingChange& c : pending) {
+        if (c.erased) m_observer->credentialErased(c.id);
+        else m_observer->credentialUpserted(c.id, c.service, c.username, c.createdAt);
+    }
+}
+
+void DatabaseManager::rollback() {
+    m_pending.clear();
+    EPM_TIMED("sql.rollback");
+    exec("ROLLBACK;");
+}
+
+// ---- Change notification ----
+
+void DatabaseManager::setObserver(CredentialObserver* observer) {
+    m_observer = observer;
+    m_pending.clear();
+}
+
+void DatabaseManager::notifyUpsert(int id, const std::string& service,
+                                   const std::string& username, const std::string& createdAt) {
+    if (!m_observer) return;
+    if (inTransaction()) m_pending.push_back({id, false, service, username, createdAt});
+    else m_observer->credentialUpserted(id, service, username, createdAt);
+}
+
+void DatabaseManager::notifyErase(int id) {
+    if (!m_observer) return;
+    if (inTransaction()) m_pending.push_back({id, true, {}, {}, {}});
+    else m_observer->credentialErased(id);
+}
+
+void DatabaseManager::notifyReload(int id) {
+    if (auto meta = getCredentialMeta(id)) {
+        notifyUpsert(id, meta->service, meta->username, meta->created_at);
+    }
+}
+
+// ---- Streaming scans ----
+
+// Columns must be: id, service, username, encrypted_password, iv, notes, created_at
+std::size_t DatabaseManager::visitRows(sqlite3_stmt* stmt, const CredentialVisitor& visit,
+                                       const char* what) const {
+    std::size_t n = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        CredentialView v{};
+        v.id           = sqlite3_column_int(stmt, 0);
+        v.service      = view_text(stmt, 1);
+        v.username     = view_text(stmt, 2);
+        v.enc_password = view_blob(stmt, 3);
+        v.iv           = view_blob(stmt, 4);
+        v.notes        = view_text(stmt, 5);
+        v.created_at   = view_text(stmt, 6);
+        visit(v);
+        ++n;
+    }
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(std::string("step ") + what + " failed: "
+                                 + sqlite3_errmsg(m_db));
+    }
+    return n;
+}
+
+std::size_t DatabaseManager::forEachCredential(const CredentialVisitor& visit,
+                                               int afterId, int limit) const {
+    // Rowid order needs no sort, so SQLite streams straight off the table
+    const char* sql = R"SQL(
+        SELECT id, service, username, encrypted_password, iv, notes, created_at
+        FROM credentials WHERE id > ?
+        ORDER BY id
+        LIMIT ?;
+    )SQL";
+
+    StmtHandle stmt = cachedStmt(StmtId::ForEachCredential, sql);
+    StmtReset reset(stmt);
+
+    if (sqlite3_bind_int(stmt, 1, afterId) != SQLITE_OK ||
+        sqlite3_bind_int(stmt, 2, limit) != SQLITE_OK) {
+        throw std::runtime_error(std::string("bind forEachCredential failed: ")
+                                 + sqlite3_errmsg(m_db));
+    }
+    return visitRows(stmt, visit, "forEachCredential");
+}
+
+std::size_t DatabaseManager::forEachByService(const std::string& query,
+                                              const CredentialVisitor& visit) const {
+    const char* sql = R"SQL(
+        SELECT id, service, username, encrypted_password, iv, notes, created_at
+        FROM credentials WHERE service LIKE ? ESCAPE '\'
+        ORDER BY created_at DESC, id DESC;
+    )SQL";
+    const char* ftsSql = R"SQL(
+        SELECT id, service, username, encrypted_password, iv, notes, created_at
+        FROM credentials
+        WHERE id IN (SELECT rowid FROM credentials_fts WHERE credentials_fts MATCH ?)
+        ORDER BY created_at DESC, id DESC;
+    )SQL";
+
+    const bool fts = useFullText(query);
+    StmtHandle stmt = fts ? cachedStmt(StmtId::ForEachByServiceFts, ftsSql)
+                           : cachedStmt(StmtId::ForEachByService, sql);
+    StmtReset reset(stmt);
+    bind_search(m_db, stmt, 1, query, kSearchService, fts);
+    return visitRows(stmt, visit, "forEachByService");
+}
+
+std::vector<CredentialMeta> DatabaseManager::searchCredentials(const std::string& query,
+                                                               unsigned fields,
+                                                               int limit) const {
+    fields &= kSearchAll;
+    if (fields == 0) throw std::invalid_argument("searchCredentials: no fields selected");
+
+    // Field tier first (service > username > notes), computed with LIKE on
+    // the matched rows only. Within a tier the index uses rank, i.e. bm25
+    // with the column weights set when it was created.
+    const char* ftsSql = R"SQL(
+        SELECT c.id, c.service, c.username, c.notes, c.created_at,
+               (CASE WHEN (?3 & 1) != 0 AND c.service  LIKE ?4 ESCAPE '\' THEN 4 ELSE 0 END) +
+               (CASE WHEN (?3 & 2) != 0 AND c.username LIKE ?4 ESCAPE '\' THEN 2 ELSE 0 END) +
+               (CASE WHEN (?3 & 4) != 0 AND c.notes    LIKE ?4 ESCAPE '\' THEN 1 ELSE 0 END) AS tier
+        FROM credentials_fts JOIN credentials c ON c.id = credentials_fts.rowid
+        WHERE credentials_fts MATCH ?1
+        ORDER BY tier DESC, rank, c.id DESC
+        LIMIT ?2;
+    )SQL";
+    const char* likeSql = R"SQL(
+        SELECT id, service, username, notes, created_at,
+               (CASE WHEN (?3 & 1) != 0 AND service  LIKE ?1 ESCAPE '\' THEN 4 ELSE 0 END) +
+               (CASE WHEN (?3 & 2) != 0 AND username LIKE ?1 ESCAPE '\' THEN 2 ELSE 0 END) +
+               (CASE WHEN (?3 & 4) != 0 AND notes    LIKE ?1 ESCAPE '\' THEN 1 ELSE 0 END) AS tier
+        FROM credentials
+        WHERE tier > 0
+        ORDER BY tier DESC, id DESC
+        LIMIT ?2;
+    )SQL";
+
+    const bool fts = useFullText(query);
+    StmtHandle stmt = fts ? cachedStmt(StmtId::SearchFts, ftsSql)
+                           : cachedStmt(StmtId::SearchLike, likeSql);
+    StmtReset reset(stmt);
+    bind_search(m_db, stmt, 1, query, fields, fts);
+    if (fts) bind_search(m_db, stmt, 4, query, fields, /*fts=*/false);
+    if (sqlite3_bind_int(stmt, 2, limit) != SQLITE_OK ||
+        sqlite3_bind_int(stmt, 3, static_cast<int>(fields)) != SQLITE_OK) {
+        throw std::runtime_error(std::string("bind searchCredentials failed: ") + sqlite3_errmsg(m_db));
+    }
+
+    std::vector<CredentialMeta> out;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        CredentialMeta m{};
+        m.id         = sqlite3_column_int(stmt, 0);
+        m.service    = read_text_nullable(stmt, 1);
+        m.username   = read_text_nullable(stmt, 2);
+        m.notes      = read_text_nullable(stmt, 3);
+        m.created_at = read_text_nullable(stmt, 4);
+        out.push_back(std::move(m));
+    }
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(std::string("step searchCredentials failed: ")
+                                 + sqlite3_errmsg(m_db));
+    }
+    return out;
+}
+
+// ---- Paged listing ----
+
+CredentialPage DatabaseManager::listCredentials(const std::optional<ListCursor>& after,
+                                                int limit, unsigned columns) const {
+    if (limit <= 0) throw std::invalid_argument("listCredentials: limit must be > 0");
+
+    // Brief variants are answered from idx_credentials_created alone. The
+    // cursor condition is split into "same created_at, smaller id" and
+    // "older created_at" so both halves are index seeks; a row value
+    // (created_at, id) < (?, ?) would only seek on created_at and then walk
+    // every row sharing it (a whole import has one timestamp).
+    static const char* const kSql[4] = {
+        R"SQL(
+        SELECT id, created_at, service, username FROM credentials
+        ORDER BY created_at DESC, id DESC LIMIT ?3;
+    )SQL",
+        R"SQL(
+        SELECT id, created_at, service, username FROM credentials
+        WHERE created_at = ?1 AND id < ?2
+        UNION ALL
+        SELECT id, created_at, service, username FROM credentials
+        WHERE created_at < ?1
+        ORDER BY created_at DESC, id DESC LIMIT ?3;
+    )SQL",
+        R"SQL(
+        SELECT id, created_at, service, username, notes FROM credentials
+        ORDER BY created_at DESC, id DESC LIMIT ?3;
+    )SQL",
+        R"SQL(
+        SELECT id, created_at, service, username, notes FROM credentials
+        WHERE created_at = ?1 AND id < ?2
+        UNION ALL
+        SELECT id, created_at, service, username, notes FROM credentials
+        WHERE created_at < ?1
+        ORDER BY created_at DESC, id DESC LIMIT ?3;
+    )SQL",
+    };
+    const bool notes = (columns & kListNotes) != 0;
+    const int variant = (notes ? 2 : 0) + (after ? 1 : 0);
+    static constexpr StmtId kIds[4] = {
+        StmtId::ListFirst, StmtId::ListAfter, StmtId::ListFirstNotes, StmtId::ListAfterNotes,
+    };
+
+    StmtHandle stmt = cachedStmt(kIds[variant], kSql[variant]);
+    StmtReset reset(stmt);
+
+    if ((after && (sqlite3_bind_text(stmt, 1, after->created_at.c_str(), -1, SQLITE_STATIC) != SQLITE_OK ||
+                   sqlite3_bind_int(stmt, 2, after->id) != SQLITE_OK)) ||
+        sqlite3_bind_int(stmt, 3, limit) != SQLITE_OK) {
+        throw std::runtime_error(std::string("bind listCredentials failed: ") + sqlite3_errmsg(m_db));
+    }
+
+    CredentialPage page;
+    page.rows.reserve(static_cast<std::size_t>(limit));
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        CredentialMeta m{};
+        m.id         = sqlite3_column_int(stmt, 0);
+        m.created_at = read_text_nullable(stmt, 1);
+        if (columns & kListService)  m.service  = read_text_nullable(stmt, 2);
+        if (columns & kListUsername) m.username = read_text_nullable(stmt, 3);
+        if (notes)                   m.notes    = read_text_nullable(stmt, 4);
+        page.rows.push_back(std::move(m));
+    }
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(std::string("step listCredentials failed: ")
+                                 + sqlite3_errmsg(m_db));
+    }
+
+    // A short page is the last one
+    if (page.rows.size() == static_cast<std::size_t>(limit)) {
+        page.next = ListCursor{ page.rows.back().created_at, page.rows.back().id };
+    }
+    return page;
+}
 
 // ---- Bulk fetch used by change-master ----
 
@@ -503,37 +1371,33 @@ std::vector<CredentialRow> DatabaseManager::getAllCredentials() const {
         ORDER BY created_at DESC, id DESC;
     )SQL";
 
-    sqlite3_stmt* stmtRaw = nullptr;
-    int rc = sqlite3_prepare_v2(m_db, sql, -1, &stmtRaw, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error(std::string("prepare getAllCredentials failed: ")
-                                 + sqlite3_errmsg(m_db));
-    }
-    std::unique_ptr<sqlite3_stmt, StmtCloser> stmt(stmtRaw);
+    StmtHandle stmt = cachedStmt(StmtId::GetAllCredentials, sql);
+    StmtReset reset(stmt);
 
+    int rc = SQLITE_OK;
     std::vector<CredentialRow> out;
-    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
         CredentialRow r{};
-        r.id        = sqlite3_column_int(stmt.get(), 0);
-        r.service   = read_text_nullable(stmt.get(), 1);
-        r.username  = read_text_nullable(stmt.get(), 2);
+        r.id        = sqlite3_column_int(stmt, 0);
+        r.service   = read_text_nullable(stmt, 1);
+        r.username  = read_text_nullable(stmt, 2);
 
-        const void* encPtr = sqlite3_column_blob(stmt.get(), 3);
-        int encLen = sqlite3_column_bytes(stmt.get(), 3);
+        const void* encPtr = sqlite3_column_blob(stmt, 3);
+        int encLen = sqlite3_column_bytes(stmt, 3);
         if (encPtr && encLen > 0) {
             const auto* p = static_cast<const std::uint8_t*>(encPtr);
             r.enc_password.assign(p, p + encLen);
         }
 
-        const void* ivPtr = sqlite3_column_blob(stmt.get(), 4);
-        int ivLen = sqlite3_column_bytes(stmt.get(), 4);
+        const void* ivPtr = sqlite3_column_blob(stmt, 4);
+        int ivLen = sqlite3_column_bytes(stmt, 4);
         if (ivPtr && ivLen > 0) {
             const auto* p = static_cast<const std::uint8_t*>(ivPtr);
             r.iv.assign(p, p + ivLen);
         }
 
-        r.created_at = read_text_nullable(stmt.get(), 5);
-        r.notes      = read_text_nullable(stmt.get(), 6);
+        r.created_at = read_text_nullable(stmt, 5);
+        r.notes      = read_text_nullable(stmt, 6);
 
         out.push_back(std::move(r));
     }
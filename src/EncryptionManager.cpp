@@ -1,25 +1,32 @@
 #include "EncryptionManager.hpp"
+#include "Instrumentation.hpp"
 
 #include <openssl/evp.h>
 #include <openssl/rand.h>
 #include <argon2.h>
+#include <openssl/crypto.h>
 #include <stdexcept>
 #include <cstring>
 #include <memory>
+#include <mutex>
 
-std::vector<std::uint8_t> EncryptionManager::deriveKey(
-    const std::string& masterPassword,
-    const std::vector<std::uint8_t>& kdfSalt
+secure_vector EncryptionManager::deriveKey(
+    std::string_view masterPassword,
+    std::span<const std::uint8_t> kdfSalt,
+    const KdfParams& params
 ) {
+    EPM_TIMED("kdf.deriveKey");
     if (kdfSalt.size() != 16) {
         throw std::invalid_argument("deriveKey: kdfSalt must be 16 bytes");
     }
-    std::vector<std::uint8_t> key(KEY_LEN);
+    params.validate();
+    secure_vector key(KEY_LEN);
 
+    // argon2id_hash_raw fills the p lanes with p threads
     int rc = argon2id_hash_raw(
-        T_COST,
-        M_COST_KiB,
-        PARALLELISM,
+        params.tCost,
+        params.mCostKiB,
+        params.parallelism,
         masterPassword.data(), masterPassword.size(),
         const_cast<std::uint8_t*>(kdfSalt.data()), kdfSalt.size(),
         key.data(), key.size()
@@ -31,114 +38,344 @@ std::vector<std::uint8_t> EncryptionManager::deriveKey(
     return key;
 }
 
-EncryptionManager::EncryptionManager(const std::vector<std::uint8_t>& key)
-: m_key(key)
+// ---- Keyed context pool ----
+
+struct EncryptionManager::CtxPool {
+    std::mutex mutex;
+    std::vector<EVP_CIPHER_CTX*> enc; // idle contexts keyed for encryption
+    std::vector<EVP_CIPHER_CTX*> dec; // idle contexts keyed for decryption
+
+    ~CtxPool() {
+        // EVP_CIPHER_CTX_free cleanses the expanded key schedule
+        for (auto* c : enc) EVP_CIPHER_CTX_free(c);
+        for (auto* c : dec) EVP_CIPHER_CTX_free(c);
+    }
+};
+
+// Borrows a keyed context for one operation. Only contexts that finished an
+// operation cleanly go back to the pool; anything else is freed.
+class EncryptionManager::CtxLease {
+public:
+    CtxLease(CtxPool& pool, bool forEncrypt, const std::uint8_t* key)
+        : m_pool(pool), m_list(forEncrypt ? pool.enc : pool.dec)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_pool.mutex);
+            if (!m_list.empty()) {
+                m_ctx = m_list.back();
+                m_list.pop_back();
+                return;
+            }
+        }
+
+        // Pool empty: build a new context and expand the key once
+        m_ctx = EVP_CIPHER_CTX_new();
+        if (!m_ctx) throw std::runtime_error("EVP_CIPHER_CTX_new failed");
+
+        const int okCipher = forEncrypt
+            ? EVP_EncryptInit_ex(m_ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr)
+            : EVP_DecryptInit_ex(m_ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr);
+        if (okCipher != 1) {
+            EVP_CIPHER_CTX_free(m_ctx);
+            throw std::runtime_error(forEncrypt ? "EncryptInit cipher failed" : "DecryptInit cipher failed");
+        }
+        if (EVP_CIPHER_CTX_ctrl(m_ctx, EVP_CTRL_GCM_SET_IVLEN, IV_LEN, nullptr) != 1) {
+            EVP_CIPHER_CTX_free(m_ctx);
+            throw std::runtime_error("SET_IVLEN failed");
+        }
+        const int okKey = forEncrypt
+            ? EVP_EncryptInit_ex(m_ctx, nullptr, nullptr, key, nullptr)
+            : EVP_DecryptInit_ex(m_ctx, nullptr, nullptr, key, nullptr);
+        if (okKey != 1) {
+            EVP_CIPHER_CTX_free(m_ctx);
+            throw std::runtime_error(forEncrypt ? "EncryptInit key failed" : "DecryptInit key failed");
+        }
+    }
+
+    ~CtxLease() {
+        if (!m_ctx) return;
+        if (m_clean) {
+            std::lock_guard<std::mutex> lock(m_pool.mutex);
+            m_list.push_back(m_ctx);
+        } else {
+            EVP_CIPHER_CTX_free(m_ctx);
+        }
+    }
+
+    CtxLease(const CtxLease&) = delete;
+    CtxLease& operator=(const CtxLease&) = delete;
+
+    EVP_CIPHER_CTX* get() const { return m_ctx; }
+    void markClean() { m_clean = true; }
+
+private:
+    CtxPool&                      m_pool;
+    std::vector<EVP_CIPHER_CTX*>& m_list;
+    EVP_CIPHER_CTX*               m_ctx = nullptr;
+    bool                          m_clean = false;
+};
+
+EncryptionManager::EncryptionManager(std::span<const std::uint8_t> key)
+: m_key(key.begin(), key.end()), m_pool(std::make_unique<CtxPool>())
 {
     if (m_key.size() != KEY_LEN) {
         throw std::invalid_argument("EncryptionManager: key must be 32 bytes");
     }
 }
 
-EncryptionManager::EncResult EncryptionManager::encrypt(
-    const std::vector<std::uint8_t>& plaintext,
-    const std::vector<std::uint8_t>& aad
-) const {
-    EncResult out;
-    out.iv.resize(IV_LEN);
-    if (RAND_bytes(out.iv.data(), static_cast<int>(out.iv.size())) != 1) {
-        throw std::runtime_error("encrypt: RAND_bytes(IV) failed");
-    }
+// m_key's allocator zeroizes the key when it is freed
+EncryptionManager::~EncryptionManager() = default;
+EncryptionManager::EncryptionManager(EncryptionManager&&) noexcept = default;
+EncryptionManager& EncryptionManager::operator=(EncryptionManager&&) noexcept = default;
 
-    // allocate: ciphertext same size as plaintext + 16B tag (final resize after Final)
-    out.encAndTag.resize(plaintext.size() + TAG_LEN);
+// ---- Per-record GCM steps on an already keyed context ----
 
-    // ctx with RAII deleter
-    EVP_CIPHER_CTX* raw = EVP_CIPHER_CTX_new();
-    if (!raw) throw std::runtime_error("EVP_CIPHER_CTX_new failed");
-    std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> ctx(raw, &EVP_CIPHER_CTX_free);
+namespace {
+    constexpr std::size_t kGcmIvLen  = EncryptionManager::kIvLen;
+    constexpr std::size_t kGcmTagLen = EncryptionManager::kTagLen;
 
-    if (EVP_EncryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, nullptr, nullptr) != 1)
-        throw std::runtime_error("EncryptInit cipher failed");
-    if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN, IV_LEN, nullptr) != 1)
-        throw std::runtime_error("SET_IVLEN failed");
-    if (EVP_EncryptInit_ex(ctx.get(), nullptr, nullptr, m_key.data(), out.iv.data()) != 1)
-        throw std::runtime_error("EncryptInit key/iv failed");
+    // iv -> AAD -> data -> tag. Returns bytes written (ciphertext || tag).
+    std::size_t sealWith(EVP_CIPHER_CTX* ctx,
+                         const std::uint8_t* iv,
+                         std::span<const std::uint8_t> plaintext,
+                         std::span<const std::uint8_t> aad,
+                         std::uint8_t* out)
+    {
+        // pre-keyed ctx: only the IV changes per call
+        if (EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, iv) != 1)
+            throw std::runtime_error("EncryptInit iv failed");
 
-    int len = 0;
-    if (!aad.empty()) {
-        if (EVP_EncryptUpdate(ctx.get(), nullptr, &len, aad.data(), static_cast<int>(aad.size())) != 1)
-            throw std::runtime_error("EncryptUpdate AAD failed");
-    }
+        int len = 0;
+        if (!aad.empty()) {
+            if (EVP_EncryptUpdate(ctx, nullptr, &len, aad.data(), static_cast<int>(aad.size())) != 1)
+                throw std::runtime_error("EncryptUpdate AAD failed");
+        }
+
+        int outLen1 = 0;
+        if (EVP_EncryptUpdate(ctx, out, &outLen1,
+                              plaintext.data(), static_cast<int>(plaintext.size())) != 1) {
+            throw std::runtime_error("EncryptUpdate data failed");
+        }
 
-    int outLen1 = 0;
-    if (EVP_EncryptUpdate(ctx.get(),
-                          out.encAndTag.data(), &outLen1,
-                          plaintext.data(), static_cast<int>(plaintext.size())) != 1) {
-        throw std::runtime_error("EncryptUpdate data failed");
+        int outLen2 = 0;
+        if (EVP_EncryptFinal_ex(ctx, out + outLen1, &outLen2) != 1) {
+            throw std::runtime_error("EncryptFinal failed");
+        }
+
+        // GCM is a stream mode: ciphertext length == plaintext length, tag follows
+        const std::size_t cLen = static_cast<std::size_t>(outLen1 + outLen2);
+        if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, kGcmTagLen, out + cLen) != 1)
+            throw std::runtime_error("GET_TAG failed");
+        return cLen + kGcmTagLen;
     }
 
-    int outLen2 = 0;
-    if (EVP_EncryptFinal_ex(ctx.get(), out.encAndTag.data() + outLen1, &outLen2) != 1) {
-        throw std::runtime_error("EncryptFinal failed");
+    // Returns false (and wipes out) on tag mismatch; throws on API errors.
+    // encAndTag must hold at least the tag; out at least the ciphertext.
+    bool openWith(EVP_CIPHER_CTX* ctx,
+                  const std::uint8_t* iv,
+                  std::span<const std::uint8_t> encAndTag,
+                  std::span<const std::uint8_t> aad,
+                  std::uint8_t* out,
+                  std::size_t& outLen)
+    {
+        const std::size_t cLen = encAndTag.size() - kGcmTagLen;
+        const std::uint8_t* ciphertext = encAndTag.data();
+        const std::uint8_t* tag        = encAndTag.data() + cLen;
+
+        // pre-keyed ctx: only the IV changes per call
+        if (EVP_DecryptInit_ex(ctx, nullptr, nullptr, nullptr, iv) != 1)
+            throw std::runtime_error("DecryptInit iv failed");
+
+        int len = 0;
+        if (!aad.empty()) {
+            if (EVP_DecryptUpdate(ctx, nullptr, &len, aad.data(), static_cast<int>(aad.size())) != 1)
+                throw std::runtime_error("DecryptUpdate AAD failed");
+        }
+
+        int pLen1 = 0;
+        if (EVP_DecryptUpdate(ctx, out, &pLen1, ciphertext, static_cast<int>(cLen)) != 1)
+            throw std::runtime_error("DecryptUpdate data failed");
+
+        if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, kGcmTagLen, const_cast<std::uint8_t*>(tag)) != 1)
+            throw std::runtime_error("SET_TAG failed");
+
+        int pLen2 = 0;
+        if (EVP_DecryptFinal_ex(ctx, out + pLen1, &pLen2) != 1) {
+            // A failed tag check leaves the context reusable; the IV is reset on next use
+            OPENSSL_cleanse(out, cLen);
+            outLen = 0;
+            return false;
+        }
+        outLen = static_cast<std::size_t>(pLen1 + pLen2);
+        return true;
     }
+}
+
+// ---- Allocation-free core ----
 
-    std::uint8_t tag[TAG_LEN];
-    if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_GET_TAG, TAG_LEN, tag) != 1)
-        throw std::runtime_error("GET_TAG failed");
+std::size_t EncryptionManager::encrypt(
+    std::span<const std::uint8_t> plaintext,
+    std::span<const std::uint8_t> aad,
+    std::span<std::uint8_t> ivOut,
+    std::span<std::uint8_t> encAndTagOut
+) const {
+    EPM_TIMED("aes.encrypt");
+    if (ivOut.size() != IV_LEN) {
+        throw std::invalid_argument("encrypt: IV buffer must be 12 bytes");
+    }
+    if (encAndTagOut.size() < sealedSize(plaintext.size())) {
+        throw std::invalid_argument("encrypt: output buffer too small");
+    }
 
-    out.encAndTag.resize(static_cast<std::size_t>(outLen1 + outLen2) + TAG_LEN);
-    std::memcpy(out.encAndTag.data() + (out.encAndTag.size() - TAG_LEN), tag, TAG_LEN);
+    if (RAND_bytes(ivOut.data(), static_cast<int>(ivOut.size())) != 1) {
+        throw std::runtime_error("encrypt: RAND_bytes(IV) failed");
+    }
 
-    return out;
+    CtxLease ctx(*m_pool, /*forEncrypt=*/true, m_key.data());
+    const std::size_t n = sealWith(ctx.get(), ivOut.data(), plaintext, aad, encAndTagOut.data());
+    ctx.markClean();
+    return n;
 }
 
-std::vector<std::uint8_t> EncryptionManager::decrypt(
-    const std::vector<std::uint8_t>& iv,
-    const std::vector<std::uint8_t>& encAndTag,
-    const std::vector<std::uint8_t>& aad
+std::size_t EncryptionManager::decrypt(
+    std::span<const std::uint8_t> iv,
+    std::span<const std::uint8_t> encAndTag,
+    std::span<const std::uint8_t> aad,
+    std::span<std::uint8_t> plaintextOut
 ) const {
+    EPM_TIMED("aes.decrypt");
     if (iv.size() != IV_LEN) {
         throw std::invalid_argument("decrypt: IV must be 12 bytes");
     }
     if (encAndTag.size() < TAG_LEN) {
         throw std::invalid_argument("decrypt: input too short");
     }
+    if (plaintextOut.size() < encAndTag.size() - TAG_LEN) {
+        throw std::invalid_argument("decrypt: output buffer too small");
+    }
 
-    const std::size_t cLen = encAndTag.size() - TAG_LEN;
-    const std::uint8_t* ciphertext = encAndTag.data();
-    const std::uint8_t* tag        = encAndTag.data() + cLen;
+    CtxLease ctx(*m_pool, /*forEncrypt=*/false, m_key.data());
+    std::size_t n = 0;
+    const bool ok = openWith(ctx.get(), iv.data(), encAndTag, aad, plaintextOut.data(), n);
+    ctx.markClean();
+    if (!ok) throw std::runtime_error("GCM tag verification failed");
+    return n;
+}
 
-    std::vector<std::uint8_t> plaintext(cLen);
+// ---- Batch API: one lease, one RAND_bytes, one arena ----
 
-    EVP_CIPHER_CTX* raw = EVP_CIPHER_CTX_new();
-    if (!raw) throw std::runtime_error("EVP_CIPHER_CTX_new failed");
-    std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> ctx(raw, &EVP_CIPHER_CTX_free);
+void EncryptionManager::encryptBatch(
+    std::span<const std::span<const std::uint8_t>> plaintexts,
+    std::span<const std::span<const std::uint8_t>> aads,
+    SealedBatch& out
+) const {
+    EPM_TIMED("aes.encryptBatch");
+    if (!aads.empty() && aads.size() != plaintexts.size()) {
+        throw std::invalid_argument("encryptBatch: aads must be empty or match plaintexts");
+    }
+    const std::size_t n = plaintexts.size();
+
+    // Size everything up front; clear() keeps capacity across calls
+    std::size_t total = 0;
+    for (const auto& pt : plaintexts) total += sealedSize(pt.size());
+    out.ivs.resize(n * IV_LEN);
+    out.arena.resize(total);
+    out.offsets.resize(n + 1);
+    if (n == 0) { out.offsets[0] = 0; return; }
 
-    if (EVP_DecryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, nullptr, nullptr) != 1)
-        throw std::runtime_error("DecryptInit cipher failed");
-    if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN, IV_LEN, nullptr) != 1)
-        throw std::runtime_error("SET_IVLEN failed");
-    if (EVP_DecryptInit_ex(ctx.get(), nullptr, nullptr, m_key.data(), iv.data()) != 1)
-        throw std::runtime_error("DecryptInit key/iv failed");
+    if (RAND_bytes(out.ivs.data(), static_cast<int>(out.ivs.size())) != 1) {
+        throw std::runtime_error("encryptBatch: RAND_bytes(IV) failed");
+    }
 
-    int len = 0;
-    if (!aad.empty()) {
-        if (EVP_DecryptUpdate(ctx.get(), nullptr, &len, aad.data(), static_cast<int>(aad.size())) != 1)
-            throw std::runtime_error("DecryptUpdate AAD failed");
+    CtxLease ctx(*m_pool, /*forEncrypt=*/true, m_key.data());
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        out.offsets[i] = pos;
+        const auto aad = aads.empty() ? std::span<const std::uint8_t>{} : aads[i];
+        pos += sealWith(ctx.get(), out.ivs.data() + i * IV_LEN, plaintexts[i], aad,
+                        out.arena.data() + pos);
     }
+    out.offsets[n] = pos;
+    ctx.markClean();
+}
 
-    int pLen1 = 0;
-    if (EVP_DecryptUpdate(ctx.get(), plaintext.data(), &pLen1, ciphertext, static_cast<int>(cLen)) != 1)
-        throw std::runtime_error("DecryptUpdate data failed");
+std::size_t EncryptionManager::decryptBatch(
+    std::span<const std::span<const std::uint8_t>> ivs,
+    std::span<const std::span<const std::uint8_t>> encAndTags,
+    std::span<const std::span<const std::uint8_t>> aads,
+    OpenedBatch& out
+) const {
+    EPM_TIMED("aes.decryptBatch");
+    const std::size_t n = encAndTags.size();
+    if (ivs.size() != n) {
+        throw std::invalid_argument("decryptBatch: ivs must match encAndTags");
+    }
+    if (!aads.empty() && aads.size() != n) {
+        throw std::invalid_argument("decryptBatch: aads must be empty or match encAndTags");
+    }
 
-    if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_TAG, TAG_LEN, const_cast<std::uint8_t*>(tag)) != 1)
-        throw std::runtime_error("SET_TAG failed");
+    std::size_t total = 0;
+    for (const auto& c : encAndTags) total += c.size() > TAG_LEN ? c.size() - TAG_LEN : 0;
+    out.wipe();
+    out.arena.resize(total);
+    out.offsets.resize(n + 1);
+    out.ok.assign(n, 0);
 
-    int pLen2 = 0;
-    if (EVP_DecryptFinal_ex(ctx.get(), plaintext.data() + pLen1, &pLen2) != 1) {
-        throw std::runtime_error("GCM tag verification failed");
+    std::size_t failures = 0;
+    CtxLease ctx(*m_pool, /*forEncrypt=*/false, m_key.data());
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        out.offsets[i] = pos;
+        // Malformed records fail like a bad tag instead of aborting the batch
+        if (ivs[i].size() != IV_LEN || encAndTags[i].size() < TAG_LEN) {
+            ++failures;
+            continue;
+        }
+        const auto aad = aads.empty() ? std::span<const std::uint8_t>{} : aads[i];
+        std::size_t len = 0;
+        if (openWith(ctx.get(), ivs[i].data(), encAndTags[i], aad, out.arena.data() + pos, len)) {
+            out.ok[i] = 1;
+            pos += len;
+        } else {
+            ++failures;
+        }
     }
+    out.offsets[n] = pos;
+    ctx.markClean();
+    return failures;
+}
+
+void EncryptionManager::OpenedBatch::wipe() {
+    // Keeps the capacity for reuse, so clear the bytes by hand
+    if (!arena.empty()) OPENSSL_cleanse(arena.data(), arena.size());
+    arena.clear();
+    offsets.clear();
+    ok.clear();
+}
+
+// ---- Vector convenience API (thin wrappers) ----
 
-    plaintext.resize(static_cast<std::size_t>(pLen1 + pLen2));
+EncryptionManager::EncResult EncryptionManager::encrypt(
+    std::span<const std::uint8_t> plaintext,
+    std::span<const std::uint8_t> aad
+) const {
+    EncResult out;
+    out.iv.resize(IV_LEN);
+    out.encAndTag.resize(sealedSize(plaintext.size()));
+    encrypt(plaintext, aad, std::span<std::uint8_t>(out.iv), std::span<std::uint8_t>(out.encAndTag));
+    return out;
+}
+
+secure_vector EncryptionManager::decrypt(
+    std::span<const std::uint8_t> iv,
+    std::span<const std::uint8_t> encAndTag,
+    std::span<const std::uint8_t> aad
+) const {
+    if (encAndTag.size() < TAG_LEN) {
+        throw std::invalid_argument("decrypt: input too short");
+    }
+    secure_vector plaintext(encAndTag.size() - TAG_LEN);
+    const std::size_t n = decrypt(iv, encAndTag, aad, std::span<std::uint8_t>(plaintext));
+    plaintext.resize(n);
     return plaintext;
 }
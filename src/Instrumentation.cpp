@@ -0,0 +1,149 @@
+#include "Instrumentation.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+
+namespace instrumentation {
+
+std::size_t Histogram::bucketOf(std::uint64_t ns) noexcept {
+    ns = std::min<std::uint64_t>(ns, (std::uint64_t{1} << kMaxBits) - 1);
+    if (ns < kSubBuckets) return static_cast<std::size_t>(ns);
+    // Keep the top kSubBits+1 bits: [16, 32) << shift
+    const unsigned shift = static_cast<unsigned>(std::bit_width(ns)) - 1 - kSubBits;
+    return shift * kSubBuckets + static_cast<std::size_t>(ns >> shift);
+}
+
+std::uint64_t Histogram::bucketUpperBound(std::size_t bucket) noexcept {
+    if (bucket < 2 * kSubBuckets) return bucket; // exact below 32 ns
+    const unsigned shift = static_cast<unsigned>(bucket / kSubBuckets) - 1;
+    const std::uint64_t sub = bucket - shift * kSubBuckets;
+    return ((sub + 1) << shift) - 1;
+}
+
+void Histogram::record(std::uint64_t ns) noexcept {
+    m_buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_totalNs.fetch_add(ns, std::memory_order_relaxed);
+    std::uint64_t seen = m_maxNs.load(std::memory_order_relaxed);
+    while (ns > seen && !m_maxNs.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+}
+
+void Histogram::reset() noexcept {
+    for (auto& b : m_buckets) b.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_totalNs.store(0, std::memory_order_relaxed);
+    m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t Histogram::percentile(double q) const {
+    // Sum the buckets rather than trusting m_count: concurrent records may
+    // have bumped one but not yet the other
+    std::uint64_t total = 0;
+    for (const auto& b : m_buckets) total += b.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+
+    const auto rank = static_cast<std::uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(total));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen > rank || seen == total) {
+            return std::min(bucketUpperBound(i), m_maxNs.load(std::memory_order_relaxed));
+        }
+    }
+    return m_maxNs.load(std::memory_order_relaxed);
+}
+
+Histogram::Summary Histogram::summary() const {
+    Summary s;
+    s.name    = m_name;
+    s.count   = count();
+    s.totalNs = m_totalNs.load(std::memory_order_relaxed);
+    s.maxNs   = m_maxNs.load(std::memory_order_relaxed);
+    s.p50Ns   = percentile(0.50);
+    s.p90Ns   = percentile(0.90);
+    s.p99Ns   = percentile(0.99);
+    return s;
+}
+
+namespace {
+    // Histograms are never destroyed, so references handed out stay valid
+    // through static destruction (a dump at exit, timers in other statics)
+    struct Registry {
+        std::mutex mu;
+        std::deque<Histogram> all;
+    };
+
+    Registry& registry() {
+        static Registry* r = new Registry();
+        return *r;
+    }
+
+    std::string format_ns(std::uint64_t ns) {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(1);
+        if (ns < 1000)              os << ns << " ns";
+        else if (ns < 1000000)      os << ns / 1e3 << " us";
+        else if (ns < 1000000000)   os << ns / 1e6 << " ms";
+        else                        os << ns / 1e9 << " s";
+        return os.str();
+    }
+}
+
+Histogram& histogram(std::string_view name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    for (Histogram& h : r.all) {
+        if (h.name() == name) return h;
+    }
+    return r.all.emplace_back(std::string(name));
+}
+
+std::vector<Histogram::Summary> snapshot() {
+    Registry& r = registry();
+    std::vector<Histogram::Summary> out;
+    {
+        std::lock_guard<std::mutex> lock(r.mu);
+        for (const Histogram& h : r.all) {
+            if (h.count() > 0) out.push_back(h.summary());
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+        return a.totalNs > b.totalNs;
+    });
+    return out;
+}
+
+void resetAll() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mu);
+    for (Histogram& h : r.all) h.reset();
+}
+
+void dump(std::ostream& out) {
+    if (!kEnabled) {
+        out << "Latency stats: built without instrumentation (EPM_INSTRUMENTATION=OFF).\n";
+        return;
+    }
+    const auto rows = snapshot();
+    if (rows.empty()) {
+        out << "Latency stats: nothing recorded yet.\n";
+        return;
+    }
+    out << std::left << std::setw(34) << "operation" << std::right
+        << std::setw(9) << "count" << std::setw(11) << "total"
+        << std::setw(11) << "p50" << std::setw(11) << "p90"
+        << std::setw(11) << "p99" << std::setw(11) << "max" << "\n";
+    for (const auto& s : rows) {
+        out << std::left << std::setw(34) << s.name << std::right
+            << std::setw(9) << s.count << std::setw(11) << format_ns(s.totalNs)
+            << std::setw(11) << format_ns(s.p50Ns) << std::setw(11) << format_ns(s.p90Ns)
+            << std::setw(11) << format_ns(s.p99Ns) << std::setw(11) << format_ns(s.maxNs) << "\n";
+    }
+}
+
+} // namespace instrumentation
@@ -0,0 +1,345 @@
+#include "Json.hpp"
+
+#include <openssl/crypto.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace json {
+
+namespace {
+    void wipe(Value& v) {
+        if (auto* s = std::get_if<std::string>(&v)) OPENSSL_cleanse(s->data(), s->size());
+    }
+
+    class Parser {
+    public:
+        explicit Parser(std::string_view s) : m_s(s) {}
+
+        // Values may be secrets ("password"): a map that is never handed to
+        // the caller, or a value a repeated key replaces, is wiped first
+        Object object() {
+            Object obj;
+            try {
+                skipWs();
+                expect('{');
+                skipWs();
+                if (peek() == '}') {
+                    ++m_pos;
+                } else {
+                    for (;;) {
+                        skipWs();
+                        std::string k = string();
+                        skipWs();
+                        expect(':');
+                        skipWs();
+                        Value v = value();
+                        const auto it = obj.find(k);
+                        if (it != obj.end()) {
+                            wipe(it->second);
+                            it->second = std::move(v);
+                        } else {
+                            obj.emplace(std::move(k), std::move(v));
+                        }
+                        skipWs();
+                        if (peek() == ',') { ++m_pos; continue; }
+                        expect('}');
+                        break;
+                    }
+                }
+                skipWs();
+                if (m_pos != m_s.size()) fail("trailing characters");
+            } catch (...) {
+                wipeValues(obj);
+                throw;
+            }
+            return obj;
+        }
+
+    private:
+        std::string_view m_s;
+        std::size_t m_pos = 0;
+
+        [[noreturn]] void fail(const char* what) const {
+            throw std::invalid_argument(std::string("json: ") + what + " at offset "
+                                        + std::to_string(m_pos));
+        }
+        char peek() const { return m_pos < m_s.size() ? m_s[m_pos] : '\0'; }
+        void expect(char c) {
+            if (peek() != c) fail((std::string("expected '") + c + "'").c_str());
+            ++m_pos;
+        }
+        void skipWs() {
+            while (m_pos < m_s.size() &&
+                   (m_s[m_pos] == ' ' || m_s[m_pos] == '\t' || m_s[m_pos] == '\r' || m_s[m_pos] == '\n'))
+                ++m_pos;
+        }
+        bool literal(std::string_view word) {
+            if (m_s.substr(m_pos, word.size()) != word) return false;
+            m_pos += word.size();
+            return true;
+        }
+
+        Value value() {
+            const char c = peek();
+            if (c == '"') return string();
+            if (c == '{' || c == '[') fail("nested values are not supported");
+            if (literal("null"))  return nullptr;
+            if (literal("true"))  return true;
+            if (literal("false")) return false;
+            if (c == '-' || (c >= '0' && c <= '9')) return number();
+            fail("unexpected character");
+        }
+
+        double number() {
+            const std::size_t start = m_pos;
+            if (peek() == '-') ++m_pos;
+            auto digits = [&] {
+                const std::size_t d = m_pos;
+                while (peek() >= '0' && peek() <= '9') ++m_pos;
+                if (m_pos == d) fail("bad number");
+            };
+            digits();
+            if (peek() == '.') { ++m_pos; digits(); }
+            if (peek() == 'e' || peek() == 'E') {
+                ++m_pos;
+                if (peek() == '+' || peek() == '-') ++m_pos;
+                digits();
+            }
+            const std::string text(m_s.substr(start, m_pos - start));
+            const double v = std::strtod(text.c_str(), nullptr);
+            // 1e999 overflows to inf, which has no JSON spelling to echo back
+            if (!std::isfinite(v)) fail("number out of range");
+            return v;
+        }
+
+        unsigned hex4() {
+            if (m_pos + 4 > m_s.size()) fail("bad \\u escape");
+            unsigned v = 0;
+            for (int i = 0; i < 4; ++i) {
+                const char h = m_s[m_pos++];
+                v <<= 4;
+                if (h >= '0' && h <= '9')      v |= static_cast<unsigned>(h - '0');
+                else if (h >= 'a' && h <= 'f') v |= static_cast<unsigned>(h - 'a' + 10);
+                else if (h >= 'A' && h <= 'F') v |= static_cast<unsigned>(h - 'A' + 10);
+                else fail("bad \\u escape");
+            }
+            return v;
+        }
+
+        static void appendUtf8(std::string& out, unsigned cp) {
+            if (cp < 0x80) {
+                out += static_cast<char>(cp);
+            } else if (cp < 0x800) {
+                out += static_cast<char>(0xC0 | (cp >> 6));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            } else if (cp < 0x10000) {
+                out += static_cast<char>(0xE0 | (cp >> 12));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (cp >> 18));
+                out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+        }
+
+        // Offset of the quote that ends the string starting at m_pos
+        std::size_t stringEnd() const {
+            std::size_t i = m_pos;
+            while (i < m_s.size() && m_s[i] != '"') i += m_s[i] == '\\' ? 2 : 1;
+            return i < m_s.size() ? i : m_s.size();
+        }
+
+        std::string string() {
+            expect('"');
+            // Escapes only shrink, so this never grows: a password value can't
+            // leave a copy behind in a buffer freed by reallocation
+            std::string out;
+            out.reserve(stringEnd() - m_pos);
+            try {
+                stringBody(out);
+            } catch (...) {
+                OPENSSL_cleanse(out.data(), out.size());
+                throw;
+            }
+            return out;
+        }
+
+        void stringBody(std::string& out) {
+            for (;;) {
+                if (m_pos >= m_s.size()) fail("unterminated string");
+                const char c = m_s[m_pos++];
+                if (c == '"') return;
+                if (static_cast<unsigned char>(c) < 0x20) fail("control character in string");
+                if (c != '\\') { out += c; continue; }
+                if (m_pos >= m_s.size()) fail("unterminated string");
+                switch (m_s[m_pos++]) {
+                case '"':  out += '"';  break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/';  break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    unsigned cp = hex4();
+                    if (cp >= 0xD800 && cp < 0xDC00) {
+                        if (!literal("\\u")) fail("unpaired surrogate");
+                        const unsigned lo = hex4();
+                        if (lo < 0xDC00 || lo >= 0xE000) fail("unpaired surrogate");
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    } else if (cp >= 0xDC00 && cp < 0xE000) {
+                        fail("unpaired surrogate");
+                    }
+                    appendUtf8(out, cp);
+                    break;
+                }
+                default: fail("bad escape");
+                }
+            }
+        }
+    };
+
+    const Value* find(const Object& obj, std::string_view key) {
+        const auto it = obj.find(key);
+        if (it == obj.end() || std::holds_alternative<std::nullptr_t>(it->second)) return nullptr;
+        return &it->second;
+    }
+
+    [[noreturn]] void wrong_type(std::string_view key, const char* want) {
+        throw std::invalid_argument("\"" + std::string(key) + "\" must be " + want);
+    }
+}
+
+void wipeValues(Object& obj) {
+    for (auto& [key, v] : obj) wipe(v);
+}
+
+Object parseObject(std::string_view text) {
+    return Parser(text).object();
+}
+
+std::optional<std::string_view> getString(const Object& obj, std::string_view key) {
+    const Value* v = find(obj, key);
+    if (!v) return std::nullopt;
+    if (const auto* s = std::get_if<std::string>(v)) return std::string_view(*s);
+    wrong_type(key, "a string");
+}
+
+std::optional<std::int64_t> getInt(const Object& obj, std::string_view key) {
+    const Value* v = find(obj, key);
+    if (!v) return std::nullopt;
+    const auto* d = std::get_if<double>(v);
+    // Integral and exactly representable (|x| <= 2^53)
+    if (!d || std::trunc(*d) != *d || std::fabs(*d) > 9007199254740992.0) wrong_type(key, "an integer");
+    return static_cast<std::int64_t>(*d);
+}
+
+std::optional<bool> getBool(const Object& obj, std::string_view key) {
+    const Value* v = find(obj, key);
+    if (!v) return std::nullopt;
+    if (const auto* b = std::get_if<bool>(v)) return *b;
+    wrong_type(key, "true or false");
+}
+
+namespace {
+    template <class Out>
+    void append_string(Out& out, std::string_view s) {
+        out += '"';
+        for (const char c : s) {
+            switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                    out += buf;
+                } else {
+                    out += c;
+                }
+            }
+        }
+        out += '"';
+    }
+
+    template <class Out>
+    void append_value(Out& out, const Value& v) {
+        if (std::holds_alternative<std::nullptr_t>(v)) {
+            out += "null";
+        } else if (const auto* b = std::get_if<bool>(&v)) {
+            out += *b ? "true" : "false";
+        } else if (const auto* d = std::get_if<double>(&v)) {
+            if (std::trunc(*d) == *d && std::fabs(*d) <= 9007199254740992.0) {
+                out += std::to_string(static_cast<std::int64_t>(*d));
+            } else {
+                char buf[32];
+                std::snprintf(buf, sizeof(buf), "%.17g", *d);
+                out += buf;
+            }
+        } else {
+            append_string(out, std::get<std::string>(v));
+        }
+    }
+}
+
+void appendString(std::string& out, std::string_view s)   { append_string(out, s); }
+void appendString(secure_string& out, std::string_view s) { append_string(out, s); }
+void appendValue(std::string& out, const Value& v)        { append_value(out, v); }
+void appendValue(secure_string& out, const Value& v)      { append_value(out, v); }
+
+template <class Out>
+void BasicObjectWriter<Out>::key(std::string_view k) {
+    if (!m_first) m_out += ',';
+    m_first = false;
+    append_string(m_out, k);
+    m_out += ':';
+}
+
+template <class Out>
+BasicObjectWriter<Out>& BasicObjectWriter<Out>::str(std::string_view k, std::string_view value) {
+    key(k);
+    append_string(m_out, value);
+    return *this;
+}
+
+template <class Out>
+BasicObjectWriter<Out>& BasicObjectWriter<Out>::num(std::string_view k, std::int64_t value) {
+    key(k);
+    m_out += std::to_string(value);
+    return *this;
+}
+
+template <class Out>
+BasicObjectWriter<Out>& BasicObjectWriter<Out>::boolean(std::string_view k, bool value) {
+    key(k);
+    m_out += value ? "true" : "false";
+    return *this;
+}
+
+template <class Out>
+BasicObjectWriter<Out>& BasicObjectWriter<Out>::value(std::string_view k, const Value& v) {
+    key(k);
+    append_value(m_out, v);
+    return *this;
+}
+
+template <class Out>
+BasicObjectWriter<Out>& BasicObjectWriter<Out>::raw(std::string_view k, std::string_view json) {
+    key(k);
+    m_out += json;
+    return *this;
+}
+
+template class BasicObjectWriter<std::string>;
+template class BasicObjectWriter<secure_string>;
+
+} // namespace json
@@ -0,0 +1,63 @@
+#include "LazyCredential.hpp"
+#include "CredentialAad.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+SecretRef::SecretRef(SecretRef&& other) noexcept
+    : m_db(other.m_db), m_enc(other.m_enc), m_id(other.m_id),
+      m_plain(std::move(other.m_plain)), m_revealed(other.m_revealed) {
+    other.m_plain.clear();
+    other.m_revealed = false;
+}
+
+SecretRef& SecretRef::operator=(SecretRef&& other) noexcept {
+    if (this != &other) {
+        forget();
+        m_db = other.m_db;
+        m_enc = other.m_enc;
+        m_id = other.m_id;
+        m_plain = std::move(other.m_plain);
+        m_revealed = other.m_revealed;
+        other.m_plain.clear();
+        other.m_revealed = false;
+    }
+    return *this;
+}
+
+std::string_view SecretRef::reveal() const {
+    if (!m_revealed) {
+        std::vector<std::uint8_t> aad;
+        const bool found = m_db->readSecret(m_id, [&](const CredentialView& row) {
+            makeCredentialAad(aad, row.service, row.username, row.created_at);
+            // Sized for the ciphertext; decrypt() rejects anything shorter than a tag
+            m_plain.resize(row.enc_password.size());
+            try {
+                m_plain.resize(m_enc->decrypt(row.iv, row.enc_password, aad, m_plain));
+            } catch (...) {
+                secure_vector().swap(m_plain);
+                throw;
+            }
+        });
+        if (!found) {
+            throw std::runtime_error("credential " + std::to_string(m_id) + " not found");
+        }
+        m_revealed = true;
+    }
+    return { reinterpret_cast<const char*>(m_plain.data()), m_plain.size() };
+}
+
+void SecretRef::forget() noexcept {
+    // Releasing the buffer is what wipes it (see SecureAllocator); clear()
+    // would keep it
+    secure_vector().swap(m_plain);
+    m_revealed = false;
+}
+
+std::optional<LazyCredential> LazyCredential::load(const DatabaseManager& db,
+                                                   const EncryptionManager& enc, int id) {
+    auto meta = db.getCredentialMeta(id);
+    if (!meta) return std::nullopt;
+    return LazyCredential{ std::move(*meta), SecretRef(db, enc, id) };
+}
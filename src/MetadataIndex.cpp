@@ -0,0 +1,346 @@
+#include "MetadataIndex.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define EPM_INDEX_SSE2 1
+#else
+#define EPM_INDEX_SSE2 0
+#endif
+
+namespace {
+    char fold(char ch) {
+        return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch - 'A' + 'a') : ch;
+    }
+
+    void append_folded(std::string& out, std::string_view in) {
+        for (char ch : in) out.push_back(fold(ch));
+    }
+
+    bool is_word_char(char ch) {
+        return (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9')
+            || static_cast<unsigned char>(ch) >= 0x80;
+    }
+
+    // First occurrence of `needle` in [hay, end). With SSE2, 16 candidate
+    // starts at a time are kept only if both the first and the last needle
+    // byte line up, so memcmp runs on few false positives even when every
+    // record shares common letters. Otherwise memchr (vectorized by the C
+    // library) finds the first byte.
+    const char* find_bytes(const char* hay, const char* end, std::string_view needle) {
+        const std::size_t n = needle.size();
+        if (static_cast<std::size_t>(end - hay) < n) return nullptr;
+        const char* lastStart = end - n;
+#if EPM_INDEX_SSE2
+        if (n >= 2) {
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last  = _mm_set1_epi8(needle[n - 1]);
+            for (; lastStart - hay >= 15; hay += 16) {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + n - 1));
+                auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+                    _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+                while (mask) {
+                    const char* c = hay + std::countr_zero(mask);
+                    if (std::memcmp(c + 1, needle.data() + 1, n - 2) == 0) return c;
+                    mask &= mask - 1;
+                }
+            }
+        }
+#endif
+        while (hay <= lastStart) {
+            const void* p = std::memchr(hay, needle[0], static_cast<std::size_t>(lastStart - hay) + 1);
+            if (!p) return nullptr;
+            const char* c = static_cast<const char*>(p);
+            if (std::memcmp(c + 1, needle.data() + 1, n - 1) == 0) return c;
+            hay = c + 1;
+        }
+        return nullptr;
+    }
+
+    bool starts_with(std::string_view s, std::string_view prefix) {
+        return s.size() >= prefix.size() && std::memcmp(s.data(), prefix.data(), prefix.size()) == 0;
+    }
+
+    constexpr int kNoMatch = std::numeric_limits<int>::min();
+
+    // Subsequence score in the spirit of fzf v1: find the leftmost match
+    // end, walk back to the tightest window, then reward consecutive runs
+    // and word starts and charge for gaps.
+    int subsequence_score(std::string_view q, std::string_view s) {
+        std::size_t qi = 0, end = 0;
+        for (std::size_t i = 0; i < s.size() && qi < q.size(); ++i) {
+            if (s[i] == q[qi]) { ++qi; end = i; }
+        }
+        if (qi < q.size()) return kNoMatch;
+
+        std::size_t start = end;
+        for (std::size_t i = end + 1, k = q.size(); i-- > 0 && k > 0;) {
+            if (s[i] == q[k - 1]) { --k; start = i; }
+        }
+
+        int score = 0;
+        std::size_t prev = std::string_view::npos;
+        qi = 0;
+        for (std::size_t i = start; i <= end && qi < q.size(); ++i) {
+            if (s[i] != q[qi]) continue;
+            score += 16;
+            if (prev != std::string_view::npos && prev + 1 == i) score += 8;
+            if (i == 0 || !is_word_char(s[i - 1])) score += 10;
+            prev = i;
+            ++qi;
+        }
+        score -= static_cast<int>(end - start + 1 - q.size()); // gaps
+        score -= static_cast<int>(std::min<std::size_t>(start, 10));
+        return score;
+    }
+
+    // Scratch reused across records: three rolling rows of the DP table
+    // (OSA looks back two rows) and byte counts for the cheap pre-check
+    struct DistanceRows {
+        std::vector<int> prev2, prev, cur;
+        std::array<int, 256> counts{};
+    };
+
+    // Smallest optimal-string-alignment distance (edits + adjacent swaps)
+    // between `q` and any prefix of `s`, or -1 if it exceeds `maxDist`
+    int prefix_edit_distance(std::string_view q, std::string_view s, int maxDist,
+                             DistanceRows& rows) {
+        const std::size_t m = q.size();
+        const std::size_t n = std::min(s.size(), m + static_cast<std::size_t>(maxDist));
+
+        // Each edit supplies at most one query byte the window lacks, so that
+        // count is a lower bound on the distance and rules out most records
+        // before the O(m*n) table.
+        int missing = 0;
+        for (std::size_t j = 0; j < n; ++j) ++rows.counts[static_cast<unsigned char>(s[j])];
+        for (char ch : q) {
+            int& c = rows.counts[static_cast<unsigned char>(ch)];
+            if (c > 0) --c; else ++missing;
+        }
+        for (std::size_t j = 0; j < n; ++j) rows.counts[static_cast<unsigned char>(s[j])] = 0;
+        if (missing > maxDist) return -1;
+
+        std::vector<int>& prev2 = rows.prev2;
+        std::vector<int>& prev  = rows.prev;
+        std::vector<int>& cur   = rows.cur;
+        prev2.assign(n + 1, 0);
+        prev.resize(n + 1);
+        cur.resize(n + 1);
+        for (std::size_t j = 0; j <= n; ++j) prev[j] = static_cast<int>(j);
+        for (std::size_t i = 1; i <= m; ++i) {
+            cur[0] = static_cast<int>(i);
+            int rowMin = cur[0];
+            for (std::size_t j = 1; j <= n; ++j) {
+                const int cost = q[i - 1] == s[j - 1] ? 0 : 1;
+                int d = std::min({ prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + cost });
+                if (i > 1 && j > 1 && q[i - 1] == s[j - 2] && q[i - 2] == s[j - 1]) {
+                    d = std::min(d, prev2[j - 2] + 1);
+                }
+                cur[j] = d;
+                rowMin = std::min(rowMin, d);
+            }
+            if (rowMin > maxDist) return -1;
+            std::swap(prev2, prev);
+            std::swap(prev, cur);
+        }
+        int best = maxDist + 1;
+        for (std::size_t j = 0; j <= n; ++j) best = std::min(best, prev[j]);
+        return best <= maxDist ? best : -1;
+    }
+
+    // Typos tolerated for a query of this length
+    int max_typos(std::size_t queryLen) {
+        return queryLen >= 8 ? 2 : queryLen >= 4 ? 1 : 0;
+    }
+
+    // Ranking: service hits first, then the mode's local score
+    constexpr int kServiceTier = 1 << 20;
+}
+
+MetadataIndex MetadataIndex::build(const DatabaseManager& db) {
+    MetadataIndex index;
+    const std::size_t n = db.countCredentials();
+    index.m_ids.reserve(n);
+    index.m_foldOff.reserve(n);
+    index.m_textOff.reserve(n);
+    index.m_serviceLen.reserve(n);
+    index.m_userLen.reserve(n);
+    index.m_createdLen.reserve(n);
+    index.m_alive.reserve(n);
+    index.m_slotById.reserve(n);
+
+    db.forEachCredential([&](const CredentialView& row) {
+        index.upsert(row.id, row.service, row.username, row.created_at);
+    });
+    return index;
+}
+
+void MetadataIndex::upsert(int id, std::string_view service, std::string_view username,
+                           std::string_view createdAt) {
+    auto it = m_slotById.find(id);
+    if (it != m_slotById.end()) kill(it->second);
+    append(id, service, username, createdAt);
+    compactIfSparse();
+}
+
+void MetadataIndex::erase(int id) {
+    auto it = m_slotById.find(id);
+    if (it == m_slotById.end()) return;
+    kill(it->second);
+    m_slotById.erase(it);
+    compactIfSparse();
+}
+
+void MetadataIndex::append(int id, std::string_view service, std::string_view username,
+                           std::string_view createdAt) {
+    constexpr std::size_t kMaxArena = std::numeric_limits<std::uint32_t>::max();
+    if (m_text.size() + service.size() + username.size() + createdAt.size() > kMaxArena ||
+        m_folded.size() + service.size() + username.size() + 2 > kMaxArena) {
+        throw std::length_error("MetadataIndex: text arena full");
+    }
+
+    const auto slot = static_cast<std::uint32_t>(m_ids.size());
+    m_ids.push_back(id);
+    m_foldOff.push_back(static_cast<std::uint32_t>(m_folded.size()));
+    m_textOff.push_back(static_cast<std::uint32_t>(m_text.size()));
+    m_serviceLen.push_back(static_cast<std::uint32_t>(service.size()));
+    m_userLen.push_back(static_cast<std::uint32_t>(username.size()));
+    m_createdLen.push_back(static_cast<std::uint32_t>(createdAt.size()));
+    m_alive.push_back(1);
+
+    // \0 separators keep a substring match from spanning two fields
+    append_folded(m_folded, service);
+    m_folded.push_back('\0');
+    append_folded(m_folded, username);
+    m_folded.push_back('\0');
+
+    m_text.append(service);
+    m_text.append(username);
+    m_text.append(createdAt);
+
+    m_slotById[id] = slot;
+}
+
+void MetadataIndex::kill(std::uint32_t slot) {
+    m_alive[slot] = 0;
+    ++m_dead;
+}
+
+// Rebuild the arenas once more than half of the slots are dead
+void MetadataIndex::compactIfSparse() {
+    if (m_dead < 1024 || m_dead * 2 < m_ids.size()) return;
+
+    MetadataIndex fresh;
+    fresh.m_slotById.reserve(m_slotById.size());
+    for (std::uint32_t slot = 0; slot < m_ids.size(); ++slot) {
+        if (!m_alive[slot]) continue;
+        const Hit h = hitFor(slot, 0);
+        fresh.append(h.id, h.service, h.username, h.created_at);
+    }
+    *this = std::move(fresh);
+}
+
+MetadataIndex::Hit MetadataIndex::hitFor(std::uint32_t slot, int score) const {
+    const char* text = m_text.data() + m_textOff[slot];
+    const std::uint32_t s = m_serviceLen[slot], u = m_userLen[slot];
+    return Hit{ m_ids[slot],
+                std::string_view(text, s),
+                std::string_view(text + s, u),
+                std::string_view(text + s + u, m_createdLen[slot]),
+                score };
+}
+
+std::vector<MetadataIndex::Hit> MetadataIndex::search(std::string_view query, Mode mode,
+                                                      std::size_t limit) const {
+    std::string q;
+    q.reserve(query.size());
+    append_folded(q, query);
+    if (q.empty() || limit == 0 || q.find('\0') != std::string::npos) return {};
+
+    struct Scored { int score; std::uint32_t slot; };
+    std::vector<Scored> scored;
+
+    switch (mode) {
+    case Mode::Prefix:
+        for (std::uint32_t slot = 0; slot < m_ids.size(); ++slot) {
+            if (!m_alive[slot]) continue;
+            // Shorter fields are closer matches
+            if (starts_with(foldedService(slot), q)) {
+                scored.push_back({ kServiceTier - static_cast<int>(std::min(m_serviceLen[slot], 0xFFFFu)), slot });
+            } else if (starts_with(foldedUser(slot), q)) {
+                scored.push_back({ -static_cast<int>(std::min(m_userLen[slot], 0xFFFFu)), slot });
+            }
+        }
+        break;
+
+    case Mode::Substring: {
+        // One pass over the whole arena; the first hit in a record is its
+        // best (service before username, earliest position), so jump to
+        // the next record after it.
+        const char* base = m_folded.data();
+        const char* end  = base + m_folded.size();
+        const char* at   = base;
+        while (const char* hit = find_bytes(at, end, q)) {
+            const auto pos = static_cast<std::uint32_t>(hit - base);
+            const auto next = std::upper_bound(m_foldOff.begin(), m_foldOff.end(), pos);
+            const auto slot = static_cast<std::uint32_t>(next - m_foldOff.begin() - 1);
+            at = next == m_foldOff.end() ? end : base + *next;
+            if (!m_alive[slot]) continue;
+
+            const std::uint32_t rel = pos - m_foldOff[slot];
+            const bool inService = rel < m_serviceLen[slot];
+            const std::uint32_t fieldPos = inService ? rel : rel - m_serviceLen[slot] - 1;
+            const std::uint32_t fieldLen = inService ? m_serviceLen[slot] : m_userLen[slot];
+            const int local = -4 * static_cast<int>(std::min(fieldPos, 0xFFFFu))
+                              - static_cast<int>(std::min(fieldLen, 0xFFFFu));
+            scored.push_back({ (inService ? kServiceTier : 0) + local, slot });
+        }
+        break;
+    }
+
+    case Mode::Fuzzy: {
+        const int maxDist = max_typos(q.size());
+        DistanceRows rows;
+        for (std::uint32_t slot = 0; slot < m_ids.size(); ++slot) {
+            if (!m_alive[slot]) continue;
+            const std::string_view service = foldedService(slot);
+
+            int best = subsequence_score(q, service);
+            if (maxDist > 0) {
+                const int d = prefix_edit_distance(q, service, maxDist, rows);
+                // A typo'd prefix ranks below any clean subsequence of the same length
+                if (d >= 0) best = std::max(best, 8 * static_cast<int>(q.size()) - 12 * d);
+            }
+            if (best != kNoMatch) {
+                scored.push_back({ kServiceTier + best, slot });
+                continue;
+            }
+            const int user = subsequence_score(q, foldedUser(slot));
+            if (user != kNoMatch) scored.push_back({ user, slot });
+        }
+        break;
+    }
+    }
+
+    // Best first; ties go to the shorter service, then the older id
+    auto better = [&](const Scored& a, const Scored& b) {
+        if (a.score != b.score) return a.score > b.score;
+        if (m_serviceLen[a.slot] != m_serviceLen[b.slot]) return m_serviceLen[a.slot] < m_serviceLen[b.slot];
+        return m_ids[a.slot] < m_ids[b.slot];
+    };
+    const std::size_t keep = std::min(limit, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + static_cast<std::ptrdiff_t>(keep),
+                      scored.end(), better);
+
+    std::vector<Hit> out;
+    out.reserve(keep);
+    for (std::size_t i = 0; i < keep; ++i) out.push_back(hitFor(scored[i].slot, scored[i].score));
+    return out;
+}
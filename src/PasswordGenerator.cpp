@@ -0,0 +1,229 @@
+#include "PasswordGenerator.hpp"
+
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <istream>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+    constexpr std::string_view kUpper     = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    constexpr std::string_view kLower     = "abcdefghijklmnopqrstuvwxyz";
+    constexpr std::string_view kDigits    = "0123456789";
+    constexpr std::string_view kSymbols   = "!@#$%^&*()-_=+[]{};:,.?/";
+    constexpr std::string_view kAmbiguous = "0O1lI";
+
+    // RAND_bytes output buffered per thread: one call per 4 KiB instead of
+    // one per password. Handed-out bytes are wiped by scrub().
+    class RandomPool {
+    public:
+        ~RandomPool() { OPENSSL_cleanse(m_buf.data(), m_buf.size()); }
+
+        // Between 1 and `max` unread bytes, marked used
+        std::span<const std::uint8_t> take(std::size_t max) {
+            if (m_pos == m_buf.size()) refill();
+            const std::size_t n = std::min(max, m_buf.size() - m_pos);
+            const std::span<const std::uint8_t> out(m_buf.data() + m_pos, n);
+            m_pos += n;
+            return out;
+        }
+
+        // Uniform in [0, n), n > 0 (Lemire's multiply-and-reject)
+        std::uint32_t uniform(std::uint32_t n) {
+            std::uint64_t m = static_cast<std::uint64_t>(u32()) * n;
+            if (static_cast<std::uint32_t>(m) < n) {
+                const std::uint32_t threshold = (0u - n) % n;
+                while (static_cast<std::uint32_t>(m) < threshold) {
+                    m = static_cast<std::uint64_t>(u32()) * n;
+                }
+            }
+            return static_cast<std::uint32_t>(m >> 32);
+        }
+
+        void scrub() {
+            OPENSSL_cleanse(m_buf.data() + m_clean, m_pos - m_clean);
+            m_clean = m_pos;
+        }
+
+    private:
+        std::uint32_t u32() {
+            std::uint32_t v = 0;
+            for (int shift = 0; shift < 32;) {
+                for (const std::uint8_t b : take(static_cast<std::size_t>(32 - shift) / 8)) {
+                    v |= static_cast<std::uint32_t>(b) << shift;
+                    shift += 8;
+                }
+            }
+            return v;
+        }
+
+        void refill() {
+            if (RAND_bytes(m_buf.data(), static_cast<int>(m_buf.size())) != 1) {
+                throw std::runtime_error("RAND_bytes failed in PasswordGenerator");
+            }
+            m_pos = 0;
+            m_clean = 0;
+        }
+
+        std::array<std::uint8_t, 4096> m_buf{};
+        std::size_t m_pos   = m_buf.size(); // next unread byte
+        std::size_t m_clean = m_buf.size(); // bytes before this are wiped or unread
+    };
+
+    RandomPool& pool() {
+        thread_local RandomPool p;
+        return p;
+    }
+}
+
+void PasswordPolicy::validate() const {
+    if (!upper && !lower && !digits && !symbols) {
+        throw std::invalid_argument("PasswordPolicy: no character class enabled");
+    }
+    if ((minUpper && !upper) || (minLower && !lower) || (minDigits && !digits) ||
+        (minSymbols && !symbols)) {
+        throw std::invalid_argument("PasswordPolicy: minimum set for a disabled class");
+    }
+    if (length > UINT32_MAX) throw std::invalid_argument("PasswordPolicy: length too large");
+    // Each minimum is checked alone first, so the sum below can't wrap
+    for (const std::size_t m : { minUpper, minLower, minDigits, minSymbols }) {
+        if (m > length) throw std::invalid_argument("PasswordPolicy: minimums exceed length");
+    }
+    if (minUpper + minLower + minDigits + minSymbols > length) {
+        throw std::invalid_argument("PasswordPolicy: minimums exceed length");
+    }
+}
+
+PasswordGenerator::PasswordGenerator(const PasswordPolicy& policy) : m_length(policy.length) {
+    policy.validate();
+
+    auto strip = [&](std::string_view cls) {
+        std::string s(cls);
+        if (policy.excludeAmbiguous) {
+            std::erase_if(s, [](char c) { return kAmbiguous.find(c) != std::string_view::npos; });
+        }
+        return s;
+    };
+    const struct { bool on; std::size_t min; std::string_view chars; } classes[] = {
+        { policy.upper,   policy.minUpper,   kUpper },
+        { policy.lower,   policy.minLower,   kLower },
+        { policy.digits,  policy.minDigits,  kDigits },
+        { policy.symbols, policy.minSymbols, kSymbols },
+    };
+
+    std::string all;
+    for (const auto& c : classes) {
+        if (!c.on) continue;
+        const std::string chars = strip(c.chars);
+        all += chars;
+        if (c.min > 0) m_required.push_back(ClassDraw{ makeTable(chars), c.min });
+    }
+    m_all = makeTable(all);
+}
+
+PasswordGenerator::PasswordGenerator(std::vector<std::string> wordlist, const PassphrasePolicy& policy)
+    : m_words(std::move(wordlist)), m_phrase(policy) {
+    std::sort(m_words.begin(), m_words.end());
+    m_words.erase(std::unique(m_words.begin(), m_words.end()), m_words.end());
+    std::erase(m_words, std::string{});
+    if (m_words.size() < 2 || m_words.size() > UINT32_MAX) {
+        throw std::invalid_argument("PasswordGenerator: wordlist needs at least two distinct words");
+    }
+    if (policy.words == 0) throw std::invalid_argument("PassphrasePolicy: words must be at least 1");
+}
+
+PasswordGenerator::CharTable PasswordGenerator::makeTable(const std::string& alphabet) {
+    CharTable t;
+    t.size = alphabet.size();
+    t.bound = static_cast<unsigned>(256 - 256 % t.size);
+    for (unsigned b = 0; b < t.bound; ++b) t.lut[b] = alphabet[b % t.size];
+    return t;
+}
+
+// Rejection sampling without a branch per byte: every byte is written, and
+// the cursor only moves past the accepted ones. Never takes more bytes than
+// slots left, so the write stays in bounds. An SSSE3 version (compare
+// against `bound`, compact accepted bytes with a shuffle table, then look
+// them up) ran at about half this speed: the lookup stays one byte at a
+// time either way, and this loop already has no branch to remove.
+void PasswordGenerator::fill(const CharTable& table, char* out, std::size_t n) {
+    RandomPool& rng = pool();
+    std::size_t k = 0;
+    while (k < n) {
+        for (const std::uint8_t b : rng.take(n - k)) {
+            out[k] = table.lut[b];
+            k += b < table.bound;
+        }
+    }
+}
+
+void PasswordGenerator::append(std::string& out) const {
+    RandomPool& rng = pool();
+    if (!m_words.empty()) {
+        for (std::size_t i = 0; i < m_phrase.words; ++i) {
+            if (i > 0) out += m_phrase.separator;
+            const std::size_t start = out.size();
+            out += m_words[rng.uniform(static_cast<std::uint32_t>(m_words.size()))];
+            if (m_phrase.capitalize) {
+                out[start] = static_cast<char>(std::toupper(static_cast<unsigned char>(out[start])));
+            }
+        }
+        return;
+    }
+
+    const std::size_t start = out.size();
+    out.resize(start + m_length);
+    char* p = out.data() + start;
+    std::size_t pos = 0;
+    for (const ClassDraw& c : m_required) {
+        fill(c.table, p + pos, c.count);
+        pos += c.count;
+    }
+    fill(m_all, p + pos, m_length - pos);
+    if (!m_required.empty()) {
+        // Fisher-Yates, so the required characters land anywhere
+        for (std::size_t i = m_length; i > 1; --i) {
+            std::swap(p[i - 1], p[rng.uniform(static_cast<std::uint32_t>(i))]);
+        }
+    }
+}
+
+std::string PasswordGenerator::generate() const {
+    std::string out;
+    append(out);
+    pool().scrub();
+    return out;
+}
+
+std::vector<std::string> PasswordGenerator::generateMany(std::size_t n) const {
+    std::vector<std::string> out(n);
+    for (std::string& s : out) append(s);
+    pool().scrub();
+    return out;
+}
+
+double PasswordGenerator::entropyBits() const {
+    if (!m_words.empty()) return static_cast<double>(m_phrase.words) * std::log2(m_words.size());
+    return static_cast<double>(m_length) * std::log2(m_all.size);
+}
+
+std::vector<std::string> readWordlist(std::istream& in) {
+    std::vector<std::string> words;
+    std::unordered_set<std::string> seen;
+    std::string line, field, last;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        last.clear();
+        while (fields >> field) last = std::move(field);
+        if (!last.empty() && seen.insert(last).second) words.push_back(last);
+    }
+    return words;
+}
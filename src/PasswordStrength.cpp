@@ -0,0 +1,320 @@
+#include "PasswordStrength.hpp"
+
+#include <openssl/crypto.h>
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+    constexpr std::size_t kMaxAnalysed = 128; // longer tails count as brute force
+
+    // Most common passwords and password words, most frequent first (rank = index + 1)
+    constexpr std::string_view kCommon[] = {
+        "123456", "password", "12345678", "qwerty", "123456789", "12345", "1234", "111111",
+        "1234567", "dragon", "123123", "baseball", "abc123", "football", "monkey", "letmein",
+        "696969", "shadow", "master", "666666", "qwertyuiop", "123321", "mustang", "1234567890",
+        "michael", "654321", "superman", "1qaz2wsx", "7777777", "121212", "000000", "qazwsx",
+        "123qwe", "killer", "trustno1", "jordan", "jennifer", "zxcvbnm", "asdfgh", "hunter",
+        "buster", "soccer", "harley", "batman", "andrew", "tigger", "sunshine", "iloveyou",
+        "2000", "charlie", "robert", "thomas", "hockey", "ranger", "daniel", "starwars",
+        "klaster", "112233", "george", "computer", "michelle", "jessica", "pepper", "1111",
+        "zxcvbn", "555555", "11111111", "131313", "freedom", "777777", "pass", "maggie",
+        "159753", "aaaaaa", "ginger", "princess", "joshua", "cheese", "amanda", "summer",
+        "love", "ashley", "nicole", "chelsea", "biteme", "matthew", "access", "yankees",
+        "987654321", "dallas", "austin", "thunder", "taylor", "matrix", "welcome", "admin",
+        "login", "hello", "secret", "whatever", "flower", "cookie", "orange", "purple",
+        "silver", "winter", "spring", "autumn", "family", "friends", "forever", "angel",
+        "baby", "diamond", "eagle", "falcon", "heaven", "jasmine", "justin", "lakers",
+        "liverpool", "arsenal", "madison", "mercedes", "merlin", "money", "mother", "naruto",
+        "oliver", "phoenix", "player", "please", "rainbow", "samantha", "sophie", "sparky",
+        "tennis", "tiger", "wizard", "yellow", "banana", "chocolate", "pokemon", "hannah",
+        "lovely", "cowboy", "gateway", "google", "internet", "samsung", "apple", "changeme",
+        "default", "guest", "root", "test", "office", "company", "business", "house",
+        "home", "music", "monday", "friday", "sunday", "january", "december", "july",
+        "august", "october", "november", "september", "april", "march", "june", "ninja",
+        "blue", "green", "red", "black", "white", "dog", "cat", "god", "sex", "qwe", "asd",
+    };
+
+    constexpr std::string_view kRows[] = {
+        "qwertyuiop", "asdfghjkl", "zxcvbnm", "!@#$%^&*()",
+    };
+
+    char lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+    bool is_upper(char c) { return c >= 'A' && c <= 'Z'; }
+    bool is_lower(char c) { return c >= 'a' && c <= 'z'; }
+    bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+    // Lowercase with common l33t substitutions undone
+    char unleet(char c) {
+        switch (c) {
+            case '0': return 'o';
+            case '1': case '!': return 'i';
+            case '3': return 'e';
+            case '4': case '@': return 'a';
+            case '5': case '$': return 's';
+            case '7': return 't';
+            default:  return lower(c);
+        }
+    }
+
+    // Row and column of each key in kRows (look up lowercased); row -1 if absent
+    struct KeyPos {
+        int row = -1;
+        int col = 0;
+    };
+
+    using KeyTable = std::array<KeyPos, 256>;
+
+    const KeyTable& key_table() {
+        static const KeyTable table = [] {
+            KeyTable t{};
+            for (std::size_t r = 0; r < std::size(kRows); ++r) {
+                for (std::size_t k = 0; k < kRows[r].size(); ++k) {
+                    t[static_cast<unsigned char>(kRows[r][k])] = KeyPos{ static_cast<int>(r), static_cast<int>(k) };
+                }
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    struct Entry {
+        std::string key;       // normalised (unleet), reversed for reversed entries
+        std::string_view word; // as listed
+        int rank;
+        bool reversed;
+    };
+
+    // Every word normalised, forwards and (4+ chars) reversed, sorted by key.
+    // Bitsets over the first two and (hashed) three bytes reject most
+    // positions outright; the rest compare against a handful of candidates.
+    struct Dictionary {
+        std::vector<Entry> entries;
+        std::vector<std::uint16_t> prefixes; // prefix_of(entries[i].key), compact for searching
+        std::bitset<65536> prefix;
+        std::bitset<65536> trigram; // hashed first three bytes: rejects most prefix hits
+
+        static std::size_t prefix_of(char a, char b) {
+            return static_cast<unsigned char>(a) << 8 | static_cast<unsigned char>(b);
+        }
+        static std::size_t trigram_of(char a, char b, char c) {
+            return (prefix_of(a, b) * 31 + static_cast<unsigned char>(c)) & 0xffff;
+        }
+        static std::size_t prefix_of(std::string_view k) { return prefix_of(k[0], k[1]); }
+
+        Dictionary() {
+            for (std::size_t i = 0; i < std::size(kCommon); ++i) {
+                const std::string_view w = kCommon[i];
+                std::string k(w.size(), '\0');
+                std::transform(w.begin(), w.end(), k.begin(), unleet);
+                if (w.size() >= 4) {
+                    entries.push_back(Entry{ std::string(k.rbegin(), k.rend()), w, static_cast<int>(i) + 1, true });
+                }
+                entries.push_back(Entry{ std::move(k), w, static_cast<int>(i) + 1, false });
+            }
+            // Duplicate keys keep their best rank
+            std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+                return std::tie(a.key, a.reversed) < std::tie(b.key, b.reversed);
+            });
+            entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+                return a.key == b.key && a.reversed == b.reversed;
+            }), entries.end());
+            for (const Entry& e : entries) {
+                prefixes.push_back(static_cast<std::uint16_t>(prefix_of(e.key)));
+                prefix.set(prefixes.back());
+                trigram.set(trigram_of(e.key[0], e.key[1], e.key[2]));
+            }
+        }
+
+        // Entries whose key starts with a, b (contiguous: keys are sorted),
+        // or none when no key starts with a, b, c
+        std::span<const Entry> candidates(char a, char b, char c) const {
+            const std::size_t p = prefix_of(a, b);
+            if (!prefix.test(p) || !trigram.test(trigram_of(a, b, c))) return {};
+            const auto lo = std::lower_bound(prefixes.begin(), prefixes.end(), p);
+            const auto hi = std::upper_bound(lo, prefixes.end(), p);
+            return { entries.data() + (lo - prefixes.begin()), static_cast<std::size_t>(hi - lo) };
+        }
+    };
+
+    const Dictionary& dictionary() {
+        static const Dictionary d;
+        return d;
+    }
+
+    double log2d(double x) { return std::log2(std::max(x, 1.0)); }
+
+    // Bits for the capitalisation and l33t spelling of a matched word
+    double variation_bits(std::string_view original, std::string_view word) {
+        std::size_t upper = 0, leet = 0;
+        for (std::size_t k = 0; k < original.size(); ++k) {
+            if (is_upper(original[k])) ++upper;
+            if (lower(original[k]) != lower(word[k])) ++leet;
+        }
+        double bits = static_cast<double>(std::min<std::size_t>(leet, 4));
+        if (upper == original.size() || (upper == 1 && is_upper(original[0]))) bits += 1;
+        else bits += static_cast<double>(upper);
+        return bits;
+    }
+
+    double char_pool_bits(std::string_view s) {
+        bool up = false, low = false, dig = false, sym = false, other = false;
+        for (const char c : s) {
+            if (is_upper(c)) up = true;
+            else if (is_lower(c)) low = true;
+            else if (is_digit(c)) dig = true;
+            else if (static_cast<unsigned char>(c) < 0x80) sym = true;
+            else other = true;
+        }
+        const int pool = (up ? 26 : 0) + (low ? 26 : 0) + (dig ? 10 : 0) + (sym ? 33 : 0) + (other ? 100 : 0);
+        return log2d(pool);
+    }
+
+    double class_size(char c) {
+        if (is_upper(c) || is_lower(c)) return 26;
+        if (is_digit(c)) return 10;
+        return 33;
+    }
+
+    bool same_class(char a, char b) {
+        return (is_lower(a) && is_lower(b)) || (is_upper(a) && is_upper(b)) || (is_digit(a) && is_digit(b));
+    }
+
+    // Cheapest split of `pw` (at most kMaxAnalysed chars) into patterns and
+    // brute-forced characters; each pattern costs one extra bit for its kind.
+    // `context` is already split into tokens (see estimateStrength).
+    double analyse(std::string_view pw, std::span<const std::string_view> context, int depth) {
+        const std::size_t n = pw.size();
+        if (n == 0) return 0;
+        const Dictionary& dict = dictionary();
+        const KeyTable& keys = key_table();
+        auto key_at = [&](char c) { return keys[static_cast<unsigned char>(lower(c))]; };
+        const double bf = char_pool_bits(pw);
+
+        std::array<char, kMaxAnalysed> norm{};
+        std::transform(pw.begin(), pw.end(), norm.begin(), unleet);
+        const std::string_view nv(norm.data(), n);
+
+        std::array<double, kMaxAnalysed + 1> best;
+        best.fill(1e9);
+        best[0] = 0;
+        auto relax = [&](std::size_t i, std::size_t j, double bits) {
+            best[j] = std::min(best[j], best[i] + bits + 1);
+        };
+
+        for (std::size_t i = 0; i < n; ++i) {
+            best[i + 1] = std::min(best[i + 1], best[i] + bf);
+            const std::size_t left = n - i;
+
+            // Dictionary words, forwards and reversed
+            if (left >= 3) {
+                for (const Entry& e : dict.candidates(nv[i], nv[i + 1], nv[i + 2])) {
+                    const std::size_t len = e.key.size();
+                    if (len > left || nv.compare(i, len, e.key) != 0) continue;
+                    relax(i, i + len, log2d(e.rank + 1.0)
+                                      + (e.reversed ? 1 : variation_bits(pw.substr(i, len), e.word)));
+                }
+            }
+
+            // Words the attacker knows about this entry (service, username)
+            for (const std::string_view token : context) {
+                if (token.size() > left) continue;
+                bool match = true;
+                for (std::size_t k = 0; k < token.size() && match; ++k) {
+                    match = nv[i + k] == unleet(token[k]);
+                }
+                if (match) relax(i, i + token.size(), 1 + variation_bits(pw.substr(i, token.size()), token));
+            }
+
+            if (left >= 3) {
+                // Runs: abc, 987, XYZ
+                const int delta = pw[i + 1] - pw[i];
+                if ((delta == 1 || delta == -1) && same_class(pw[i], pw[i + 1])) {
+                    std::size_t len = 2;
+                    while (len < left && pw[i + len] - pw[i + len - 1] == delta
+                           && same_class(pw[i + len - 1], pw[i + len])) ++len;
+                    if (len >= 3) {
+                        const double base = std::string_view("aAzZ019").find(pw[i]) != std::string_view::npos
+                                          ? 4 : class_size(pw[i]);
+                        relax(i, i + len, log2d(base * static_cast<double>(len)) + (delta < 0 ? 1 : 0));
+                    }
+                }
+
+                // Keyboard rows: qwerty, lkjh, !@#$ (the second key fixes the direction)
+                const KeyPos first = key_at(pw[i]), second = key_at(pw[i + 1]);
+                const int dir = second.col - first.col;
+                if (first.row >= 0 && second.row == first.row && (dir == 1 || dir == -1)) {
+                    std::size_t len = 2;
+                    while (len < left) {
+                        const KeyPos k = key_at(pw[i + len]);
+                        if (k.row != first.row || k.col != first.col + dir * static_cast<int>(len)) break;
+                        ++len;
+                    }
+                    if (len >= 4) relax(i, i + len, log2d(40.0 * static_cast<double>(len)) + (dir < 0 ? 1 : 0));
+                }
+
+                // Repeats: aaaa, then whole blocks (abcabc) priced by their content
+                std::size_t same = 1;
+                while (same < left && pw[i + same] == pw[i]) ++same;
+                if (same >= 3) relax(i, i + same, log2d(class_size(pw[i]) * static_cast<double>(same)));
+                if (depth == 0) {
+                    for (std::size_t p = 2; 2 * p <= left; ++p) {
+                        if (pw[i + p] != pw[i]) continue;
+                        std::size_t reps = 1;
+                        while ((reps + 1) * p <= left
+                               && pw.substr(i + reps * p, p) == pw.substr(i, p)) ++reps;
+                        if (reps >= 2) {
+                            relax(i, i + reps * p, analyse(pw.substr(i, p), context, depth + 1)
+                                                   + log2d(static_cast<double>(reps)));
+                        }
+                    }
+                }
+            }
+
+            // Years 1900-2049
+            if (left >= 4 && is_digit(pw[i]) && is_digit(pw[i + 1]) && is_digit(pw[i + 2]) && is_digit(pw[i + 3])) {
+                const int year = (pw[i] - '0') * 1000 + (pw[i + 1] - '0') * 100 + (pw[i + 2] - '0') * 10 + (pw[i + 3] - '0');
+                if (year >= 1900 && year <= 2049) relax(i, i + 4, log2d(150));
+            }
+        }
+        OPENSSL_cleanse(norm.data(), n); // lowercased copy of the secret
+        return best[n];
+    }
+}
+
+StrengthEstimate estimateStrength(std::string_view password, std::span<const std::string_view> context) {
+    // Split the context into alphanumeric runs of 3+ once, not per position
+    std::array<std::string_view, 16> tokens;
+    std::size_t nTokens = 0;
+    for (const std::string_view ctx : context) {
+        for (std::size_t a = 0; a < ctx.size() && nTokens < tokens.size();) {
+            std::size_t b = a;
+            while (b < ctx.size() && (is_lower(lower(ctx[b])) || is_digit(ctx[b]))) ++b;
+            if (b - a >= 3) tokens[nTokens++] = ctx.substr(a, b - a);
+            a = b + 1;
+        }
+    }
+
+    const std::string_view head = password.substr(0, kMaxAnalysed);
+    StrengthEstimate e;
+    e.bits = analyse(head, std::span<const std::string_view>(tokens.data(), nTokens), 0)
+           + static_cast<double>(password.size() - head.size()) * char_pool_bits(password);
+    e.score = e.bits < 28 ? 0 : e.bits < 36 ? 1 : e.bits < 60 ? 2 : e.bits < 80 ? 3 : 4;
+    return e;
+}
+
+const char* strengthLabel(int score) {
+    switch (score) {
+        case 0:  return "very weak";
+        case 1:  return "weak";
+        case 2:  return "fair";
+        case 3:  return "strong";
+        default: return "very strong";
+    }
+}
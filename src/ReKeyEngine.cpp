@@ -0,0 +1,125 @@
+#include "ReKeyEngine.hpp"
+
+#include "CredentialAad.hpp"
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    // One row as read from the DB: everything needed to decrypt it
+    struct Job {
+        int id;
+        std::vector<std::uint8_t> aad;
+        std::vector<std::uint8_t> enc;
+        std::vector<std::uint8_t> iv;
+    };
+
+    struct Batch {
+        std::vector<Job>          jobs;
+        std::vector<SecretUpdate> out;
+    };
+
+    // Worker side: old key -> plaintext -> new key, same AAD.
+    // Both directions go through the batch API: one context lease each and a
+    // single RAND_bytes call for all new IVs.
+    void reKeyBatch(Batch& b, const EncryptionManager& from, const EncryptionManager& to) {
+        using Bytes = std::span<const std::uint8_t>;
+        const std::size_t n = b.jobs.size();
+        std::vector<Bytes> ivs(n), encs(n), aads(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            ivs[i]  = b.jobs[i].iv;
+            encs[i] = b.jobs[i].enc;
+            aads[i] = b.jobs[i].aad;
+        }
+
+        EncryptionManager::OpenedBatch plain;
+        if (from.decryptBatch(ivs, encs, aads, plain) != 0) {
+            for (std::size_t i = 0; i < n; ++i) {
+                if (!plain.ok[i]) {
+                    throw std::runtime_error("re-key: credential " + std::to_string(b.jobs[i].id)
+                                             + ": GCM tag verification failed");
+                }
+            }
+        }
+
+        std::vector<Bytes> pts(n);
+        for (std::size_t i = 0; i < n; ++i) pts[i] = plain.plaintext(i);
+
+        EncryptionManager::SealedBatch sealed;
+        to.encryptBatch(pts, aads, sealed);
+        plain.wipe(); // scrub plaintext asap
+
+        b.out.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            SecretUpdate& u = b.out[i];
+            u.id = b.jobs[i].id;
+            u.iv.assign(sealed.iv(i).begin(), sealed.iv(i).end());
+            u.enc_password.assign(sealed.sealed(i).begin(), sealed.sealed(i).end());
+        }
+        b.jobs.clear();
+        b.jobs.shrink_to_fit();
+    }
+}
+
+ReKeyEngine::ReKeyEngine(DatabaseManager& db,
+                         const EncryptionManager& from,
+                         const EncryptionManager& to,
+                         ReKeyOptions options)
+    : m_db(db), m_from(from), m_to(to), m_options(options)
+{
+    if (m_options.batchSize == 0) {
+        throw std::invalid_argument("ReKeyEngine: batchSize must be > 0");
+    }
+}
+
+std::size_t ReKeyEngine::run(const ReKeyProgress& progress) {
+    if (!m_db.inTransaction()) {
+        throw std::logic_error("ReKeyEngine::run must be called inside a transaction");
+    }
+
+    const std::size_t total = m_db.countCredentials();
+    const int batchLimit = static_cast<int>(
+        std::min<std::size_t>(m_options.batchSize, static_cast<std::size_t>(INT32_MAX)));
+
+    std::size_t done = 0;
+
+    // Writer side: batches are retired in read order, so ids stay ascending
+    auto retire = [&](std::unique_ptr<Batch> b) {
+        m_db.updateSecrets(b->out);
+        done += b->out.size();
+        if (progress) progress(done, total);
+    };
+    OrderedPipeline<Batch> pipeline(m_options.threads, m_options.maxInFlight, retire);
+
+    int afterId = 0;
+    for (;;) {
+        auto batch = std::make_unique<Batch>();
+        batch->jobs.reserve(m_options.batchSize);
+
+        // Rows > afterId were not touched yet, so reading ahead of the
+        // pending writes is safe.
+        m_db.forEachCredential([&](const CredentialView& v) {
+            Job j;
+            j.id = v.id;
+            makeCredentialAad(j.aad, v.service, v.username, v.created_at);
+            j.enc.assign(v.enc_password.begin(), v.enc_password.end());
+            j.iv.assign(v.iv.begin(), v.iv.end());
+            batch->jobs.push_back(std::move(j));
+            afterId = v.id;
+        }, afterId, batchLimit);
+
+        if (batch->jobs.empty()) break;
+        pipeline.submit(std::move(batch), [this](Batch& b) { reKeyBatch(b, m_from, m_to); });
+    }
+    pipeline.finish();
+
+    return done;
+}
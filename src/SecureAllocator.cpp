@@ -0,0 +1,176 @@
+#include "SecureAllocator.hpp"
+
+#include <openssl/crypto.h>
+
+#include <array>
+#include <mutex>
+
+#if defined(_WIN32)
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+namespace {
+    constexpr std::size_t kArenaSize = 64 * 1024;
+    constexpr std::size_t kMinBlock  = 32;
+    // 32, 64, ..., 4096
+    constexpr std::size_t kClasses   = 8;
+    static_assert(kMinBlock << (kClasses - 1) == secure_memory::kMaxPooled);
+
+    std::size_t class_of(std::size_t bytes) {
+        std::size_t c = 0;
+        while ((kMinBlock << c) < bytes) ++c;
+        return c;
+    }
+
+    std::size_t page_size() {
+#if defined(_WIN32)
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        return si.dwPageSize;
+#else
+        return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    // Map, lock and hide `bytes` (a page multiple). Returns nullptr on failure.
+    void* map_locked(std::size_t bytes, bool& locked) {
+#if defined(_WIN32)
+        void* p = VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (!p) return nullptr;
+        locked = VirtualLock(p, bytes) != 0;
+#else
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return nullptr;
+  #if defined(MADV_DONTDUMP)
+        madvise(p, bytes, MADV_DONTDUMP);
+  #endif
+        locked = mlock(p, bytes) == 0;
+#endif
+        return p;
+    }
+
+    void unmap(void* p, std::size_t bytes) noexcept {
+#if defined(_WIN32)
+        VirtualUnlock(p, bytes);
+        VirtualFree(p, 0, MEM_RELEASE);
+#else
+        munlock(p, bytes);
+        munmap(p, bytes);
+#endif
+    }
+
+    struct FreeBlock { FreeBlock* next; };
+
+    // Process-wide pool. Arenas are never unmapped: the pool only grows to
+    // the peak number of live small secrets.
+    struct Pool {
+        std::mutex mu;
+        std::array<FreeBlock*, kClasses> freeLists{};
+        char*       bump = nullptr;  // unused tail of the newest arena
+        std::size_t bumpLeft = 0;
+        std::size_t pageSize = page_size();
+        secure_memory::Stats stats;
+
+        void* map(std::size_t bytes) {
+            bool locked = false;
+            void* p = map_locked(bytes, locked);
+            if (!p) throw std::bad_alloc();
+            ++stats.mappings;
+            stats.bytesMapped += bytes;
+            if (!locked) ++stats.lockFailures;
+            return p;
+        }
+
+        std::size_t largeSize(std::size_t bytes) const {
+            return (bytes + pageSize - 1) / pageSize * pageSize;
+        }
+    };
+
+    // Leaked on purpose so secrets in static objects can still be freed
+    // during program exit
+    Pool& pool() {
+        static Pool* p = new Pool;
+        return *p;
+    }
+}
+
+namespace secure_memory {
+
+void* allocate(std::size_t bytes) {
+    if (bytes == 0) bytes = 1;
+    Pool& pl = pool();
+    std::lock_guard<std::mutex> lock(pl.mu);
+
+    if (bytes > kMaxPooled) {
+        const std::size_t size = pl.largeSize(bytes);
+        void* p = pl.map(size);
+        pl.stats.bytesInUse += size;
+        return p;
+    }
+
+    const std::size_t c = class_of(bytes);
+    const std::size_t blockSize = kMinBlock << c;
+    pl.stats.bytesInUse += blockSize;
+    if (FreeBlock* b = pl.freeLists[c]) {
+        pl.freeLists[c] = b->next;
+        b->next = nullptr; // handed out all-zero
+        return b;
+    }
+    // Blocks are carved from the arena tail. Every size is a multiple of
+    // kMinBlock, so every block is kMinBlock-aligned.
+    if (pl.bumpLeft < blockSize) {
+        // Park the leftover tail on the free lists before starting a new arena
+        for (std::size_t k = kClasses; k-- > 0;) {
+            while (pl.bumpLeft >= (kMinBlock << k)) {
+                auto* fb = reinterpret_cast<FreeBlock*>(pl.bump);
+                fb->next = pl.freeLists[k];
+                pl.freeLists[k] = fb;
+                pl.bump += kMinBlock << k;
+                pl.bumpLeft -= kMinBlock << k;
+            }
+        }
+        pl.bump = static_cast<char*>(pl.map(kArenaSize));
+        pl.bumpLeft = kArenaSize;
+    }
+    void* p = pl.bump;
+    pl.bump += blockSize;
+    pl.bumpLeft -= blockSize;
+    return p;
+}
+
+void deallocate(void* p, std::size_t bytes) noexcept {
+    if (!p) return;
+    if (bytes == 0) bytes = 1;
+    Pool& pl = pool();
+
+    if (bytes > kMaxPooled) {
+        const std::size_t size = pl.largeSize(bytes);
+        OPENSSL_cleanse(p, size);
+        unmap(p, size);
+        std::lock_guard<std::mutex> lock(pl.mu);
+        pl.stats.bytesInUse  -= size;
+        pl.stats.bytesMapped -= size;
+        return;
+    }
+
+    const std::size_t c = class_of(bytes);
+    const std::size_t blockSize = kMinBlock << c;
+    // Wipe outside the lock; the block is still ours
+    OPENSSL_cleanse(p, blockSize);
+    std::lock_guard<std::mutex> lock(pl.mu);
+    auto* fb = static_cast<FreeBlock*>(p);
+    fb->next = pl.freeLists[c];
+    pl.freeLists[c] = fb;
+    pl.stats.bytesInUse -= blockSize;
+}
+
+Stats stats() {
+    Pool& pl = pool();
+    std::lock_guard<std::mutex> lock(pl.mu);
+    return pl.stats;
+}
+
+} // namespace secure_memory
@@ -0,0 +1,51 @@
+#include "ThreadPool.hpp"
+
+#include <utility>
+
+std::size_t ThreadPool::resolveThreads(std::size_t requested) {
+    if (requested > 0) return requested;
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    const std::size_t n = resolveThreads(threads);
+    m_workers.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        m_workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& t : m_workers) t.join();
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> job) {
+    std::packaged_task<void()> task(std::move(job));
+    std::future<void> fut = task.get_future();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+    return fut;
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+            if (m_jobs.empty()) return; // stopping and drained
+            task = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        task(); // exceptions are captured into the future
+    }
+}
@@ -0,0 +1,132 @@
+#include "VaultAudit.hpp"
+#include "CredentialAad.hpp"
+#include "PasswordStrength.hpp"
+
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+    // HMAC-SHA256 truncated to 128 bits: collisions stay out of reach at any
+    // vault size, and the table holds half the bytes
+    using Digest = std::array<std::uint8_t, 16>;
+
+    struct DigestHash {
+        std::size_t operator()(const Digest& d) const noexcept {
+            std::uint64_t h;
+            std::memcpy(&h, d.data(), sizeof(h));
+            return static_cast<std::size_t>(h);
+        }
+    };
+
+    using MacPtr = std::unique_ptr<EVP_MAC_CTX, decltype(&EVP_MAC_CTX_free)>;
+
+    // Keyed once; each chunk works on its own copy
+    MacPtr make_hmac(std::span<const std::uint8_t> key) {
+        std::unique_ptr<EVP_MAC, decltype(&EVP_MAC_free)>
+            mac(EVP_MAC_fetch(nullptr, "HMAC", nullptr), &EVP_MAC_free);
+        if (!mac) throw std::runtime_error("auditVault: HMAC unavailable");
+        MacPtr ctx(EVP_MAC_CTX_new(mac.get()), &EVP_MAC_CTX_free);
+        char digest[] = "SHA256";
+        const OSSL_PARAM params[] = {
+            OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0),
+            OSSL_PARAM_construct_end(),
+        };
+        if (!ctx || EVP_MAC_init(ctx.get(), key.data(), key.size(), params) != 1) {
+            throw std::runtime_error("auditVault: HMAC init failed");
+        }
+        return ctx;
+    }
+
+    // Re-initialising with no key keeps the key already set
+    Digest keyed_hash(EVP_MAC_CTX* ctx, std::string_view password) {
+        std::uint8_t out[EVP_MAX_MD_SIZE];
+        std::size_t outLen = 0;
+        if (EVP_MAC_init(ctx, nullptr, 0, nullptr) != 1
+            || EVP_MAC_update(ctx, reinterpret_cast<const unsigned char*>(password.data()), password.size()) != 1
+            || EVP_MAC_final(ctx, out, &outLen, sizeof(out)) != 1 || outLen < sizeof(Digest)) {
+            throw std::runtime_error("auditVault: HMAC failed");
+        }
+        Digest d;
+        std::memcpy(d.data(), out, d.size());
+        return d;
+    }
+
+    struct FirstUse {
+        int id;
+        int group = -1; // index into AuditReport::reused once a second row shares it
+    };
+}
+
+std::string iso8601DaysAgo(int days) {
+    return iso8601Utc(std::time(nullptr) - static_cast<std::time_t>(days) * 86400);
+}
+
+AuditReport auditVault(const DatabaseManager& db, const EncryptionManager& enc,
+                       const AuditOptions& options) {
+    secure_vector key(32);
+    if (RAND_bytes(key.data(), static_cast<int>(key.size())) != 1) {
+        throw std::runtime_error("RAND_bytes failed for audit key");
+    }
+    const MacPtr proto = make_hmac(key);
+
+    AuditReport report;
+    std::unordered_map<Digest, FirstUse, DigestHash> seen;
+    seen.reserve(db.countCredentials());
+    std::mutex mu;
+
+    report.failed = scanDecryptedUnordered(db, enc, [&](std::span<const PlainRow> rows) {
+        MacPtr mac(EVP_MAC_CTX_dup(proto.get()), &EVP_MAC_CTX_free);
+        if (!mac) throw std::runtime_error("auditVault: HMAC copy failed");
+
+        // Everything that touches plaintext happens here, outside the lock
+        std::vector<std::pair<Digest, int>> digests;
+        std::vector<WeakFinding> weak;
+        std::vector<OldFinding> old;
+        digests.reserve(rows.size());
+        for (const PlainRow& r : rows) {
+            if (!options.oldBefore.empty() && r.created_at < options.oldBefore) {
+                old.push_back(OldFinding{ r.id, std::string(r.created_at) });
+            }
+            if (!r.ok) continue;
+            const std::string_view context[] = { r.service, r.username };
+            const StrengthEstimate s = estimateStrength(r.password, context);
+            if (s.score < options.weakBelow) weak.push_back(WeakFinding{ r.id, s.score, s.bits });
+            digests.emplace_back(keyed_hash(mac.get(), r.password), r.id);
+        }
+
+        const std::lock_guard<std::mutex> lock(mu);
+        report.rows += rows.size();
+        report.weak.insert(report.weak.end(), weak.begin(), weak.end());
+        report.old.insert(report.old.end(), std::make_move_iterator(old.begin()),
+                          std::make_move_iterator(old.end()));
+        for (const auto& [d, id] : digests) {
+            const auto [it, fresh] = seen.try_emplace(d, FirstUse{ id });
+            if (fresh) continue;
+            FirstUse& first = it->second;
+            if (first.group < 0) {
+                first.group = static_cast<int>(report.reused.size());
+                report.reused.push_back({ first.id });
+            }
+            report.reused[static_cast<std::size_t>(first.group)].push_back(id);
+        }
+    }, options.scan);
+
+    // Chunks finish in any order; present everything by id
+    auto byId = [](const auto& a, const auto& b) { return a.id < b.id; };
+    std::sort(report.weak.begin(), report.weak.end(), byId);
+    std::sort(report.old.begin(), report.old.end(), byId);
+    for (auto& g : report.reused) std::sort(g.begin(), g.end());
+    std::sort(report.reused.begin(), report.reused.end(),
+              [](const std::vector<int>& a, const std::vector<int>& b) { return a.front() < b.front(); });
+    return report;
+}
@@ -0,0 +1,97 @@
+#include "VaultDump.hpp"
+
+#include "Json.hpp"
+
+#include <openssl/crypto.h>
+
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    // Quoted only when needed, with "" for quotes (what read_csv_record expects)
+    void append_csv_field(std::string& out, std::string_view s) {
+        if (s.find_first_of(",\"\r\n") == std::string_view::npos) {
+            out.append(s);
+            return;
+        }
+        out += '"';
+        for (const char c : s) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        out += '"';
+    }
+
+    // Longest line a row can produce: JSON escapes a control byte as \u00XX
+    // (CSV at most doubles a byte); 128 covers keys, punctuation and the id
+    std::size_t line_bound(const PlainRow& r) {
+        return 6 * (r.service.size() + r.username.size() + r.password.size() +
+                    r.notes.size() + r.created_at.size()) + 128;
+    }
+}
+
+std::optional<DumpFormat> parseDumpFormat(std::string_view name) {
+    if (name == "csv")   return DumpFormat::Csv;
+    if (name == "jsonl") return DumpFormat::JsonLines;
+    return std::nullopt;
+}
+
+DumpStats dumpVault(const DatabaseManager& db, const EncryptionManager& enc,
+                    std::ostream& out, DumpFormat format, const ScanOptions& options) {
+    DumpStats stats;
+    // Reused, holds plaintext. It is reserved up front for each row and never
+    // grows while a row is built, so the only buffers it frees are wiped first
+    std::string line;
+    auto wipe = [&line] {
+        line.resize(line.capacity());
+        OPENSSL_cleanse(line.data(), line.size());
+    };
+
+    if (format == DumpFormat::Csv) out << "service,username,password,notes,created_at,id\n";
+
+    try {
+        stats.failed = scanDecrypted(db, enc, [&](const PlainRow& r) {
+            if (!r.ok) return;
+            const std::size_t bound = line_bound(r);
+            if (bound > line.capacity()) {
+                wipe();
+                line.reserve(bound);
+            }
+            line.clear();
+            if (format == DumpFormat::Csv) {
+                append_csv_field(line, r.service);
+                line += ',';
+                append_csv_field(line, r.username);
+                line += ',';
+                append_csv_field(line, r.password);
+                line += ',';
+                append_csv_field(line, r.notes);
+                line += ',';
+                line.append(r.created_at);
+                line += ',';
+                line += std::to_string(r.id);
+            } else {
+                json::ObjectWriter w(line);
+                w.num("id", r.id)
+                 .str("service", r.service)
+                 .str("username", r.username)
+                 .str("password", r.password)
+                 .str("notes", r.notes)
+                 .str("created_at", r.created_at);
+                w.close();
+            }
+            line += '\n';
+            out.write(line.data(), static_cast<std::streamsize>(line.size()));
+            if (!out) throw std::runtime_error("dump: write failed");
+            ++stats.rows;
+        }, options);
+    } catch (...) {
+        wipe();
+        throw;
+    }
+    wipe();
+    out.flush();
+    if (!out) throw std::runtime_error("dump: write failed");
+    return stats;
+}
@@ -0,0 +1,310 @@
+#include "VaultExport.hpp"
+
+#include "CredentialAad.hpp"
+#include "Instrumentation.hpp"
+
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+
+// Set by CMake when zstd is found
+#ifndef EPM_HAVE_ZSTD
+#define EPM_HAVE_ZSTD 0
+#endif
+#if EPM_HAVE_ZSTD
+  #include <zstd.h>
+#endif
+
+#include <array>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr char          kMagic[4]      = {'E', 'P', 'M', 'X'};
+    constexpr std::uint8_t  kVersion       = 1;
+    constexpr std::uint8_t  kFlagZstd      = 1u << 0;
+    constexpr std::size_t   kSaltLen       = 16;
+    constexpr std::size_t   kHeaderLen     = 4 + 1 + 1 + 2 + 3 * 4 + kSaltLen;
+    // Upper bound on one chunk, checked before anything is authenticated
+    constexpr std::uint32_t kMaxChunkBytes = 64u << 20;
+
+    using Header = std::array<std::uint8_t, kHeaderLen>;
+
+    void put_le32(std::uint8_t* p, std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+    }
+
+    std::uint32_t get_le32(const std::uint8_t* p) {
+        std::uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<std::uint32_t>(p[i]) << (8 * i);
+        return v;
+    }
+
+    // header || u64 index || final
+    std::vector<std::uint8_t> chunk_aad(const Header& header, std::uint64_t index, bool final) {
+        std::vector<std::uint8_t> aad(header.begin(), header.end());
+        for (int i = 0; i < 8; ++i) aad.push_back(static_cast<std::uint8_t>(index >> (8 * i)));
+        aad.push_back(final ? 1 : 0);
+        return aad;
+    }
+
+    void append_field(secure_vector& out, std::string_view s) {
+        const std::size_t at = out.size();
+        out.resize(at + 4);
+        put_le32(out.data() + at, static_cast<std::uint32_t>(s.size()));
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    std::string_view take_field(const secure_vector& in, std::size_t& pos) {
+        if (in.size() - pos < 4) throw std::runtime_error("export: malformed record");
+        const std::uint32_t n = get_le32(in.data() + pos);
+        pos += 4;
+        if (in.size() - pos < n) throw std::runtime_error("export: malformed record");
+        const std::string_view s(reinterpret_cast<const char*>(in.data() + pos), n);
+        pos += n;
+        return s;
+    }
+
+#if EPM_HAVE_ZSTD
+    void zstd_compress(const secure_vector& in, secure_vector& out) {
+        out.resize(ZSTD_compressBound(in.size()));
+        const std::size_t n = ZSTD_compress(out.data(), out.size(), in.data(), in.size(), 3);
+        if (ZSTD_isError(n)) throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(n));
+        out.resize(n);
+    }
+
+    void zstd_decompress(const secure_vector& in, secure_vector& out) {
+        const unsigned long long size = ZSTD_getFrameContentSize(in.data(), in.size());
+        if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN || size > kMaxChunkBytes) {
+            throw std::runtime_error("export: bad compressed chunk");
+        }
+        out.resize(static_cast<std::size_t>(size));
+        const std::size_t n = ZSTD_decompress(out.data(), out.size(), in.data(), in.size());
+        if (ZSTD_isError(n) || n != size) throw std::runtime_error("export: bad compressed chunk");
+    }
+#endif
+
+    // Seals and writes one chunk; `plain` is wiped and cleared for the next one
+    class ChunkWriter {
+    public:
+        ChunkWriter(std::ostream& out, const Header& header, secure_vector key, bool compress)
+            : m_out(out), m_header(header), m_enc(key), m_compress(compress) {}
+
+        void write(secure_vector& plain, bool final, ExportStats& stats) {
+            const secure_vector* body = &plain;
+#if EPM_HAVE_ZSTD
+            if (m_compress) {
+                zstd_compress(plain, m_packed);
+                body = &m_packed;
+            }
+#endif
+            const auto aad = chunk_aad(m_header, stats.chunks, final);
+            std::uint8_t prefix[4 + 1 + EncryptionManager::kIvLen];
+            m_sealed.resize(EncryptionManager::sealedSize(body->size()));
+            m_enc.encrypt(*body, aad, std::span(prefix + 5, EncryptionManager::kIvLen), m_sealed);
+            put_le32(prefix, static_cast<std::uint32_t>(m_sealed.size()));
+            prefix[4] = final ? 1 : 0;
+
+            m_out.write(reinterpret_cast<const char*>(prefix), sizeof(prefix));
+            m_out.write(reinterpret_cast<const char*>(m_sealed.data()),
+                        static_cast<std::streamsize>(m_sealed.size()));
+            if (!m_out) throw std::runtime_error("export: write failed");
+
+            stats.bytes += sizeof(prefix) + m_sealed.size();
+            ++stats.chunks;
+            // Releasing is what wipes secure memory; keep the capacity, wipe by hand
+            OPENSSL_cleanse(plain.data(), plain.size());
+            plain.clear();
+        }
+
+    private:
+        std::ostream&             m_out;
+        const Header&             m_header;
+        EncryptionManager         m_enc;
+        bool                      m_compress;
+        secure_vector             m_packed;
+        std::vector<std::uint8_t> m_sealed;
+    };
+}
+
+bool exportCompressionAvailable() {
+    return EPM_HAVE_ZSTD != 0;
+}
+
+ExportStats exportVault(const DatabaseManager& db, const EncryptionManager& vault,
+                        std::string_view passphrase, std::ostream& out,
+                        const ExportOptions& options) {
+    EPM_TIMED("export.vault");
+    options.kdf.validate();
+    if (options.chunkBytes == 0 || options.chunkBytes > kMaxChunkBytes / 2) {
+        throw std::invalid_argument("export: chunkBytes must be in [1, 32 MiB]");
+    }
+    if (options.compress && !exportCompressionAvailable()) {
+        throw std::invalid_argument("export: this build has no zstd support");
+    }
+
+    Header header{};
+    std::memcpy(header.data(), kMagic, 4);
+    header[4] = kVersion;
+    header[5] = options.compress ? kFlagZstd : 0;
+    put_le32(header.data() + 8,  options.kdf.tCost);
+    put_le32(header.data() + 12, options.kdf.mCostKiB);
+    put_le32(header.data() + 16, options.kdf.parallelism);
+    std::uint8_t* salt = header.data() + 20;
+    if (RAND_bytes(salt, static_cast<int>(kSaltLen)) != 1) {
+        throw std::runtime_error("RAND_bytes failed for export salt");
+    }
+
+    ChunkWriter writer(out, header,
+                       EncryptionManager::deriveKey(passphrase, {salt, kSaltLen}, options.kdf),
+                       options.compress);
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    if (!out) throw std::runtime_error("export: write failed");
+
+    ExportStats stats;
+    stats.bytes = header.size();
+    secure_vector plain;
+    plain.reserve(options.chunkBytes + 4096);
+    secure_vector secret;
+    std::vector<std::uint8_t> aad;
+
+    db.forEachCredential([&](const CredentialView& row) {
+        makeCredentialAad(aad, row.service, row.username, row.created_at);
+        secret.resize(row.enc_password.size());
+        secret.resize(vault.decrypt(row.iv, row.enc_password, aad, secret));
+
+        append_field(plain, row.service);
+        append_field(plain, row.username);
+        append_field(plain, row.notes);
+        append_field(plain, row.created_at);
+        append_field(plain, {reinterpret_cast<const char*>(secret.data()), secret.size()});
+        ++stats.records;
+        if (plain.size() >= options.chunkBytes) writer.write(plain, false, stats);
+    });
+    // Always ends with a final chunk, possibly empty, so truncation is detectable
+    writer.write(plain, true, stats);
+    out.flush();
+    if (!out) throw std::runtime_error("export: write failed");
+    return stats;
+}
+
+bool isVaultExport(std::istream& in) {
+    char magic[4] = {};
+    const auto start = in.tellg();
+    in.read(magic, sizeof(magic));
+    const bool match = in.gcount() == 4 && std::memcmp(magic, kMagic, 4) == 0;
+    in.clear();
+    in.seekg(start);
+    return match;
+}
+
+ExportStats importVault(DatabaseManager& db, const EncryptionManager& vault,
+                        std::string_view passphrase, std::istream& in) {
+    EPM_TIMED("import.vault");
+    Header header{};
+    in.read(reinterpret_cast<char*>(header.data()), header.size());
+    if (in.gcount() != static_cast<std::streamsize>(header.size()) ||
+        std::memcmp(header.data(), kMagic, 4) != 0) {
+        throw std::runtime_error("import: not an epm export");
+    }
+    if (header[4] != kVersion) {
+        throw std::runtime_error("import: unsupported export version " + std::to_string(header[4]));
+    }
+    const bool compressed = (header[5] & kFlagZstd) != 0;
+    if ((header[5] & ~kFlagZstd) != 0) throw std::runtime_error("import: unknown flags");
+    if (compressed && !exportCompressionAvailable()) {
+        throw std::runtime_error("import: file is zstd-compressed but this build has no zstd support");
+    }
+
+    KdfParams kdf;
+    kdf.tCost       = get_le32(header.data() + 8);
+    kdf.mCostKiB    = get_le32(header.data() + 12);
+    kdf.parallelism = get_le32(header.data() + 16);
+    try {
+        kdf.validate();
+    } catch (const std::invalid_argument& ex) {
+        throw std::runtime_error(std::string("import: corrupt header: ") + ex.what());
+    }
+    const EncryptionManager fileKey(
+        EncryptionManager::deriveKey(passphrase, {header.data() + 20, kSaltLen}, kdf));
+
+    ExportStats stats;
+    stats.bytes = header.size();
+    std::vector<std::uint8_t> sealed;
+    secure_vector plain, unpacked;
+    std::vector<NewCredential> rows;
+    std::vector<std::uint8_t> aad;
+
+    const bool ownTxn = !db.inTransaction();
+    if (ownTxn) db.beginTransaction();
+    try {
+        for (bool final = false; !final;) {
+            std::uint8_t prefix[4 + 1 + EncryptionManager::kIvLen];
+            in.read(reinterpret_cast<char*>(prefix), sizeof(prefix));
+            if (in.gcount() != static_cast<std::streamsize>(sizeof(prefix))) {
+                throw std::runtime_error("import: file is truncated");
+            }
+            const std::uint32_t len = get_le32(prefix);
+            final = prefix[4] == 1;
+            if (len < EncryptionManager::kTagLen || len > kMaxChunkBytes || prefix[4] > 1) {
+                throw std::runtime_error("import: corrupt chunk header");
+            }
+            sealed.resize(len);
+            in.read(reinterpret_cast<char*>(sealed.data()), len);
+            if (in.gcount() != static_cast<std::streamsize>(len)) {
+                throw std::runtime_error("import: file is truncated");
+            }
+            stats.bytes += sizeof(prefix) + len;
+
+            plain.resize(len);
+            try {
+                plain.resize(fileKey.decrypt(std::span(prefix + 5, EncryptionManager::kIvLen), sealed,
+                                             chunk_aad(header, stats.chunks, final), plain));
+            } catch (const std::runtime_error&) {
+                throw std::runtime_error(stats.chunks == 0
+                    ? "import: wrong passphrase or corrupt file"
+                    : "import: chunk " + std::to_string(stats.chunks) + " is corrupt or out of order");
+            }
+            ++stats.chunks;
+#if EPM_HAVE_ZSTD
+            if (compressed) {
+                zstd_decompress(plain, unpacked);
+                plain.swap(unpacked);
+            }
+#endif
+
+            // Re-seal each record under the vault key, same AAD fields
+            rows.clear();
+            for (std::size_t pos = 0; pos < plain.size();) {
+                NewCredential nc;
+                nc.service    = std::string(take_field(plain, pos));
+                nc.username   = std::string(take_field(plain, pos));
+                nc.notes      = std::string(take_field(plain, pos));
+                nc.created_at = std::string(take_field(plain, pos));
+                const std::string_view secret = take_field(plain, pos);
+                if (nc.service.empty() || nc.created_at.empty()) {
+                    throw std::runtime_error("import: malformed record");
+                }
+                sealCredential(vault, secret, nc.service, nc.username, nc.created_at,
+                               nc.iv, nc.enc_password, aad);
+                rows.push_back(std::move(nc));
+            }
+            OPENSSL_cleanse(plain.data(), plain.size());
+            OPENSSL_cleanse(unpacked.data(), unpacked.size());
+            stats.records += db.addCredentials(rows).size();
+        }
+        if (in.peek() != std::char_traits<char>::eof()) {
+            throw std::runtime_error("import: data after the final chunk");
+        }
+        if (ownTxn) db.commit();
+    } catch (...) {
+        if (ownTxn) {
+            try { db.rollback(); } catch (...) {}
+        }
+        throw;
+    }
+    return stats;
+}
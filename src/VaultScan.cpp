@@ -0,0 +1,181 @@
+#include "VaultScan.hpp"
+
+#include "CredentialAad.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    // A run of rows copied out of SQLite into flat buffers, then decrypted
+    // by one pool job. Reused across the scan so steady state allocates nothing.
+    struct Chunk {
+        static constexpr std::size_t kFields = 4; // service, username, notes, created_at
+
+        std::vector<int>           ids;
+        std::string                text;
+        std::vector<std::size_t>   textEnd;  // kFields end offsets per row
+        std::vector<std::uint8_t>  bytes;    // iv then ciphertext||tag, per row
+        std::vector<std::size_t>   ivStart, sealedStart, sealedEnd;
+        std::vector<std::uint8_t>  aads;
+        std::vector<std::size_t>   aadEnd;
+        EncryptionManager::OpenedBatch opened;
+        std::size_t                failed = 0;
+        std::vector<PlainRow>      rows;     // views into the buffers above
+
+        std::size_t size() const { return ids.size(); }
+
+        void clear() {
+            ids.clear();
+            text.clear();
+            textEnd.clear();
+            bytes.clear();
+            ivStart.clear();
+            sealedStart.clear();
+            sealedEnd.clear();
+        }
+
+        void append(const CredentialView& r) {
+            ids.push_back(r.id);
+            for (const std::string_view f : {r.service, r.username, r.notes, r.created_at}) {
+                text.append(f);
+                textEnd.push_back(text.size());
+            }
+            ivStart.push_back(bytes.size());
+            bytes.insert(bytes.end(), r.iv.begin(), r.iv.end());
+            sealedStart.push_back(bytes.size());
+            bytes.insert(bytes.end(), r.enc_password.begin(), r.enc_password.end());
+            sealedEnd.push_back(bytes.size());
+        }
+
+        std::string_view field(std::size_t row, std::size_t f) const {
+            const std::size_t k = row * kFields + f;
+            const std::size_t start = k == 0 ? 0 : textEnd[k - 1];
+            return std::string_view(text).substr(start, textEnd[k] - start);
+        }
+
+        std::span<const std::uint8_t> iv(std::size_t row) const {
+            return { bytes.data() + ivStart[row], sealedStart[row] - ivStart[row] };
+        }
+
+        std::span<const std::uint8_t> sealed(std::size_t row) const {
+            return { bytes.data() + sealedStart[row], sealedEnd[row] - sealedStart[row] };
+        }
+
+        // Worker side: rebuild each row's AAD and open the whole chunk at once
+        void decrypt(const EncryptionManager& enc) {
+            const std::size_t n = size();
+            aads.clear();
+            aadEnd.clear();
+            std::vector<std::uint8_t> one;
+            for (std::size_t i = 0; i < n; ++i) {
+                makeCredentialAad(one, field(i, 0), field(i, 1), field(i, 3));
+                aads.insert(aads.end(), one.begin(), one.end());
+                aadEnd.push_back(aads.size());
+            }
+
+            std::vector<std::span<const std::uint8_t>> ivSpans(n), sealedSpans(n), aadSpans(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::size_t start = i == 0 ? 0 : aadEnd[i - 1];
+                ivSpans[i]     = iv(i);
+                sealedSpans[i] = sealed(i);
+                aadSpans[i]    = { aads.data() + start, aadEnd[i] - start };
+            }
+            failed = enc.decryptBatch(ivSpans, sealedSpans, aadSpans, opened);
+        }
+
+        // After decrypt(): one PlainRow per row, viewing this chunk's buffers
+        void buildRows() {
+            rows.clear();
+            for (std::size_t i = 0; i < size(); ++i) {
+                const auto plain = opened.plaintext(i);
+                rows.push_back(PlainRow{
+                    ids[i], field(i, 0), field(i, 1), field(i, 2), field(i, 3), iv(i), sealed(i),
+                    { reinterpret_cast<const char*>(plain.data()), plain.size() }, opened.ok[i] != 0 });
+            }
+        }
+
+        void wipe() {
+            rows.clear();
+            opened.wipe();
+        }
+    };
+}
+
+namespace {
+    // Shared driver. Exactly one of `ordered` (rows on the calling thread, in
+    // id order) and `unordered` (whole chunks on the workers) is set.
+    std::size_t run_scan(const DatabaseManager& db, const EncryptionManager& enc,
+                         const PlainVisitor* ordered, const PlainChunkVisitor* unordered,
+                         const ScanOptions& options) {
+        if (options.chunkRows == 0 || options.chunkRows > static_cast<std::size_t>(INT32_MAX)) {
+            throw std::invalid_argument("scanDecrypted: chunkRows out of range");
+        }
+        std::vector<std::unique_ptr<Chunk>> spare;
+        std::size_t failed = 0;
+
+        auto deliver = [&](std::unique_ptr<Chunk> c) {
+            failed += c->failed;
+            if (ordered) {
+                try {
+                    c->buildRows();
+                    for (const PlainRow& r : c->rows) (*ordered)(r);
+                } catch (...) {
+                    c->wipe();
+                    throw;
+                }
+            }
+            c->wipe();
+            spare.push_back(std::move(c));
+        };
+        OrderedPipeline<Chunk> pipeline(options.threads, 0, deliver, [](Chunk& c) { c.wipe(); });
+
+        auto work = [&enc, unordered](Chunk& c) {
+            c.decrypt(enc);
+            if (!unordered) return;
+            try {
+                c.buildRows();
+                (*unordered)(std::span<const PlainRow>(c.rows));
+            } catch (...) {
+                c.wipe();
+                throw;
+            }
+            c.wipe();
+        };
+
+        int afterId = 0;
+        for (;;) {
+            std::unique_ptr<Chunk> c;
+            if (spare.empty()) {
+                c = std::make_unique<Chunk>();
+            } else {
+                c = std::move(spare.back());
+                spare.pop_back();
+            }
+            c->clear();
+
+            const std::size_t n = db.forEachCredential([&](const CredentialView& r) { c->append(r); },
+                                                       afterId, static_cast<int>(options.chunkRows));
+            if (n == 0) break;
+            afterId = c->ids.back();
+
+            pipeline.submit(std::move(c), work);
+            if (n < options.chunkRows) break;
+        }
+        pipeline.finish();
+        return failed;
+    }
+}
+
+std::size_t scanDecrypted(const DatabaseManager& db, const EncryptionManager& enc,
+                          const PlainVisitor& visit, const ScanOptions& options) {
+    return run_scan(db, enc, &visit, nullptr, options);
+}
+
+std::size_t scanDecryptedUnordered(const DatabaseManager& db, const EncryptionManager& enc,
+                                   const PlainChunkVisitor& visit, const ScanOptions& options) {
+    return run_scan(db, enc, nullptr, &visit, options);
+}
@@ -0,0 +1,246 @@
+#include "VaultUnlock.hpp"
+
+#include "AuthManager.hpp"
+#include "DatabaseManager.hpp"
+#include "Instrumentation.hpp"
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <openssl/rand.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+namespace {
+    constexpr std::size_t kSaltLen = 16;
+    constexpr std::size_t kKeyLen  = 32;
+
+    constexpr std::string_view kInfoEnc  = "epm/v2/enc";
+    constexpr std::string_view kInfoAuth = "epm/v2/auth";
+
+    // HKDF-SHA256 with an empty salt: the root is already uniformly random
+    secure_vector hkdf(std::span<const std::uint8_t> root, std::string_view info) {
+        std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)>
+            ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, nullptr), &EVP_PKEY_CTX_free);
+        if (!ctx) throw std::runtime_error("HKDF: EVP_PKEY_CTX_new_id failed");
+
+        secure_vector out(kKeyLen);
+        std::size_t outLen = out.size();
+        if (EVP_PKEY_derive_init(ctx.get()) != 1
+            || EVP_PKEY_CTX_set_hkdf_md(ctx.get(), EVP_sha256()) != 1
+            || EVP_PKEY_CTX_set1_hkdf_key(ctx.get(), root.data(), static_cast<int>(root.size())) != 1
+            || EVP_PKEY_CTX_add1_hkdf_info(ctx.get(),
+                   reinterpret_cast<const unsigned char*>(info.data()),
+                   static_cast<int>(info.size())) != 1
+            || EVP_PKEY_derive(ctx.get(), out.data(), &outLen) != 1
+            || outLen != kKeyLen) {
+            throw std::runtime_error("HKDF derive failed");
+        }
+        return out;
+    }
+
+    std::vector<std::uint8_t> randomSalt() {
+        std::vector<std::uint8_t> salt(kSaltLen);
+        if (RAND_bytes(salt.data(), static_cast<int>(salt.size())) != 1) {
+            throw std::runtime_error("RAND_bytes failed for kdf_salt");
+        }
+        return salt;
+    }
+
+    bool sameBytes(std::span<const std::uint8_t> a, std::span<const std::uint8_t> b) {
+        return a.size() == b.size() && CRYPTO_memcmp(a.data(), b.data(), a.size()) == 0;
+    }
+
+    // One Argon2id run; the root never outlives this call
+    MasterKeys deriveMasterKeys(std::string_view pw, std::span<const std::uint8_t> kdfSalt,
+                                const KdfParams& params) {
+        const secure_vector root = EncryptionManager::deriveKey(pw, kdfSalt, params);
+        return splitRootKey(root);
+    }
+
+    // Re-encrypt everything from `from` (if any) to `to`, then write the
+    // scheme-2 record. One transaction: committed on success, rolled back
+    // and rethrown on failure.
+    void commitSchemeTwo(DatabaseManager& db, const EncryptionManager* from,
+                         const EncryptionManager& to, const std::vector<std::uint8_t>& kdfSalt,
+                         const KdfParams& params, const MasterKeys& keys,
+                         const ReKeyProgress& progress) {
+        db.beginTransaction();
+        try {
+            if (from) ReKeyEngine(db, *from, to).run(progress);
+            db.storeKdfSalt(kdfSalt);
+            db.storeKdfParams(params);
+            // master_auth.salt mirrors kdf_salt; the verifier is salted through the root
+            db.storeMaster(kdfSalt, {keys.verifier.begin(), keys.verifier.end()},
+                           kMasterSchemeHkdf);
+            db.commit();
+        } catch (...) {
+            try { db.rollback(); } catch (...) {}
+            throw;
+        }
+    }
+
+    // Fresh kdf_salt and scheme-2 record for a vault with nothing encrypted yet
+    EncryptionManager startSchemeTwo(DatabaseManager& db, std::string_view pw,
+                                     const KdfParams& params) {
+        auto kdfSalt = randomSalt();
+        MasterKeys keys = deriveMasterKeys(pw, kdfSalt, params);
+        EncryptionManager enc(keys.encKey);
+        commitSchemeTwo(db, nullptr, enc, kdfSalt, params, keys, {});
+        return enc;
+    }
+
+    // Checks `pw` against the stored record. On success returns the K_enc
+    // the data is currently encrypted under (empty: nothing encrypted yet).
+    std::optional<secure_vector> verifyAndDeriveKey(DatabaseManager& db,
+                                                    std::string_view pw,
+                                                    int& schemeOut,
+                                                    KdfParams& paramsOut) {
+        auto master = db.loadMaster();
+        if (!master) throw std::runtime_error("No master record present");
+        schemeOut = db.loadMasterScheme().value_or(kMasterSchemeTwoHash);
+        paramsOut = db.loadKdfParams().value_or(KdfParams{});
+
+        if (schemeOut == kMasterSchemeHkdf) {
+            auto kdfSalt = db.loadKdfSalt();
+            if (!kdfSalt) throw std::runtime_error("Vault is missing its kdf_salt");
+            MasterKeys keys = deriveMasterKeys(pw, *kdfSalt, paramsOut);
+            if (!sameBytes(keys.verifier, master->second)) return std::nullopt;
+            return std::move(keys.encKey);
+        }
+        if (schemeOut == kMasterSchemeTwoHash) {
+            AuthManager auth;
+            if (!auth.verifyMasterPassword(pw, StoredAuth{ master->first, master->second })) {
+                return std::nullopt;
+            }
+            // The first run never wrote a kdf_salt; nothing is encrypted yet
+            auto kdfSalt = db.loadKdfSalt();
+            if (!kdfSalt) return secure_vector{};
+            return EncryptionManager::deriveKey(pw, *kdfSalt, paramsOut);
+        }
+        throw std::runtime_error("Unknown master_auth scheme " + std::to_string(schemeOut));
+    }
+}
+
+MasterKeys splitRootKey(std::span<const std::uint8_t> root) {
+    if (root.size() != kKeyLen) {
+        throw std::invalid_argument("splitRootKey: root must be 32 bytes");
+    }
+    MasterKeys keys;
+    keys.encKey   = hkdf(root, kInfoEnc);
+    keys.verifier = hkdf(root, kInfoAuth);
+    return keys;
+}
+
+KdfParams defaultKdfParams() {
+    KdfParams params;
+    params.parallelism = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+    return params;
+}
+
+EncryptionManager createVault(DatabaseManager& db, std::string_view masterPassword,
+                              const KdfParams& params) {
+    if (db.loadMaster()) throw std::logic_error("createVault: master record already exists");
+    return startSchemeTwo(db, masterPassword, params);
+}
+
+std::optional<EncryptionManager> unlockVault(DatabaseManager& db,
+                                             std::string_view masterPassword) {
+    EPM_TIMED("vault.unlock");
+    int scheme = 0;
+    KdfParams params;
+    auto key = verifyAndDeriveKey(db, masterPassword, scheme, params);
+    if (!key) return std::nullopt;
+    if (scheme == kMasterSchemeHkdf) return EncryptionManager(*key);
+
+    // No rows can fail to re-key, so switch to scheme 2 right away
+    if (key->empty()) return startSchemeTwo(db, masterPassword, params);
+
+    // Rows stay under the scheme-1 key until upgradeVault()
+    return EncryptionManager(*key);
+}
+
+std::optional<EncryptionManager> upgradeVault(DatabaseManager& db,
+                                              std::string_view masterPassword,
+                                              const ReKeyProgress& progress) {
+    int scheme = 0;
+    KdfParams params;
+    auto key = verifyAndDeriveKey(db, masterPassword, scheme, params);
+    if (!key) return std::nullopt;
+    if (scheme == kMasterSchemeHkdf) return EncryptionManager(*key);
+    if (key->empty()) return startSchemeTwo(db, masterPassword, params);
+
+    // Under the old kdf_salt the Argon2id root *is* the old K_enc, so the
+    // upgrade costs no extra KDF run, only a re-encryption.
+    auto kdfSalt = db.loadKdfSalt();
+    MasterKeys keys = splitRootKey(*key);
+    EncryptionManager oldEnc(*key);
+    EncryptionManager newEnc(keys.encKey);
+    commitSchemeTwo(db, &oldEnc, newEnc, *kdfSalt, params, keys, progress);
+    return newEnc;
+}
+
+std::optional<EncryptionManager> changeMasterPassword(DatabaseManager& db,
+                                                      std::string_view current,
+                                                      std::string_view next,
+                                                      const ReKeyProgress& progress,
+                                                      std::optional<KdfParams> newParams) {
+    if (next.empty()) throw std::invalid_argument("changeMasterPassword: empty password");
+    if (newParams) newParams->validate();
+
+    int scheme = 0;
+    KdfParams params;
+    auto oldKey = verifyAndDeriveKey(db, current, scheme, params);
+    if (!oldKey) return std::nullopt;
+    if (newParams) params = *newParams;
+
+    auto newSalt = randomSalt();
+    MasterKeys keys = deriveMasterKeys(next, newSalt, params);
+    EncryptionManager newEnc(keys.encKey);
+
+    // A scheme-1 vault without kdf_salt has nothing to re-encrypt
+    std::optional<EncryptionManager> oldEnc;
+    if (!oldKey->empty()) oldEnc.emplace(*oldKey);
+    commitSchemeTwo(db, oldEnc ? &*oldEnc : nullptr, newEnc, newSalt, params, keys, progress);
+    return newEnc;
+}
+
+KdfCalibration calibrateKdf(std::chrono::milliseconds target, std::uint32_t maxMemKiB) {
+    using Clock = std::chrono::steady_clock;
+    if (target.count() <= 0) throw std::invalid_argument("calibrateKdf: target must be > 0");
+    maxMemKiB = std::min(maxMemKiB, KdfParams::kMaxMCostKiB);
+
+    constexpr std::string_view probePw = "epm-calibration";
+    const std::vector<std::uint8_t> probeSalt(kSaltLen, 0xC5);
+    auto measure = [&](const KdfParams& p) {
+        auto t0 = Clock::now();
+        auto key = EncryptionManager::deriveKey(probePw, probeSalt, p);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - t0);
+        return std::max(elapsed, std::chrono::milliseconds(1));
+    };
+
+    KdfParams p;
+    p.parallelism = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    p.tCost = 1;
+    p.mCostKiB = std::max<std::uint32_t>(std::min<std::uint32_t>(64 * 1024, maxMemKiB),
+                                         8 * p.parallelism);
+
+    // Memory first: it is what makes GPU/ASIC guessing expensive
+    auto elapsed = measure(p);
+    while (elapsed * 2 <= target / 2 && p.mCostKiB <= maxMemKiB / 2) {
+        p.mCostKiB *= 2;
+        elapsed = measure(p);
+    }
+
+    // Then iterations; time grows about linearly with t
+    const auto perPass = elapsed;
+    p.tCost = static_cast<std::uint32_t>(std::clamp<long long>(
+        (target.count() + perPass.count() / 2) / perPass.count(), 1, KdfParams::kMaxTCost));
+    if (p.tCost > 1) elapsed = measure(p);
+
+    return { p, elapsed };
+}
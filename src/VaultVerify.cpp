@@ -0,0 +1,83 @@
+#include "VaultVerify.hpp"
+
+#include <array>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+    using IvKey = std::array<std::uint8_t, EncryptionManager::kIvLen>;
+
+    // IVs are random, so any 8 of their bytes already hash well
+    struct IvHash {
+        std::size_t operator()(const IvKey& iv) const noexcept {
+            std::uint64_t h;
+            std::memcpy(&h, iv.data(), sizeof(h));
+            std::uint32_t tail;
+            std::memcpy(&tail, iv.data() + sizeof(h), sizeof(tail));
+            return static_cast<std::size_t>(h ^ (static_cast<std::uint64_t>(tail) << 17));
+        }
+    };
+
+    bool digits(std::string_view s, std::size_t pos, std::size_t n) {
+        for (std::size_t i = pos; i < pos + n; ++i) {
+            if (s[i] < '0' || s[i] > '9') return false;
+        }
+        return true;
+    }
+
+    // Shape check only: what iso8601Utc / the DB default write
+    bool is_iso8601_utc(std::string_view s) {
+        return s.size() == 20 && digits(s, 0, 4) && s[4] == '-' && digits(s, 5, 2) && s[7] == '-'
+            && digits(s, 8, 2) && s[10] == 'T' && digits(s, 11, 2) && s[13] == ':'
+            && digits(s, 14, 2) && s[16] == ':' && digits(s, 17, 2) && s[19] == 'Z';
+    }
+}
+
+const char* verifyIssueName(VerifyIssue issue) {
+    switch (issue) {
+        case VerifyIssue::BadTag:          return "bad-tag";
+        case VerifyIssue::DuplicateIv:     return "duplicate-iv";
+        case VerifyIssue::BadIvLength:     return "bad-iv-length";
+        case VerifyIssue::ShortCiphertext: return "short-ciphertext";
+        case VerifyIssue::EmptyService:    return "empty-service";
+        case VerifyIssue::BadCreatedAt:    return "bad-created-at";
+    }
+    return "unknown";
+}
+
+VerifyReport verifyVault(const DatabaseManager& db, const EncryptionManager& enc,
+                         const ScanOptions& options) {
+    VerifyReport report;
+    report.storageErrors = db.quickCheck();
+
+    std::unordered_map<IvKey, int, IvHash> firstUse;
+    firstUse.reserve(db.countCredentials());
+
+    scanDecrypted(db, enc, [&](const PlainRow& r) {
+        ++report.rows;
+        auto flag = [&](VerifyIssue issue, int other = 0) {
+            report.findings.push_back(VerifyFinding{ r.id, issue, other });
+        };
+
+        bool wellFormed = true;
+        if (r.iv.size() != EncryptionManager::kIvLen) {
+            flag(VerifyIssue::BadIvLength);
+            wellFormed = false;
+        } else {
+            IvKey key;
+            std::memcpy(key.data(), r.iv.data(), key.size());
+            const auto [it, fresh] = firstUse.try_emplace(key, r.id);
+            if (!fresh) flag(VerifyIssue::DuplicateIv, it->second);
+        }
+        if (r.sealed.size() < EncryptionManager::kTagLen) {
+            flag(VerifyIssue::ShortCiphertext);
+            wellFormed = false;
+        }
+        if (r.service.empty()) flag(VerifyIssue::EmptyService);
+        if (!is_iso8601_utc(r.created_at)) flag(VerifyIssue::BadCreatedAt);
+        // A malformed row can't be opened either; report the cause only
+        if (!r.ok && wellFormed) flag(VerifyIssue::BadTag);
+    }, options);
+
+    return report;
+}
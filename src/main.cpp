@@ -1,19 +1,43 @@
 // src/main.cpp
 #include "DatabaseManager.hpp"
-#include "AuthManager.hpp"
 #include "EncryptionManager.hpp"
+#include "CredentialAad.hpp"
+#include "VaultUnlock.hpp"
+#include "MetadataIndex.hpp"
+#include "LazyCredential.hpp"
+#include "Instrumentation.hpp"
+#include "BatchRunner.hpp"
+#include "VaultExport.hpp"
+#include "VaultDump.hpp"
+#include "VaultVerify.hpp"
+#include "VaultAudit.hpp"
+#include "PasswordStrength.hpp"
 #include "console_io.hpp"
 #include "password_gen.hpp"
+#include "PasswordGenerator.hpp"
 
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <optional>
 #include <vector>
+#include <span>
+#include <memory>
+#include <chrono>
 #include <cstdint>
 #include <stdexcept>
+#include <streambuf>
 #include <limits>
-#include <openssl/rand.h>
+#include <algorithm>
+#include <cstdlib>
+
+#if !defined(_WIN32)
+  #include <cerrno>
+  #include <fcntl.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
 
 // ----- Small helpers -----
 
@@ -24,29 +48,59 @@ static std::string prompt_line(const std::string& message) {
     return s;
 }
 
-static std::vector<std::uint8_t> toBytes(const std::string& s) {
-    return { s.begin(), s.end() };
-}
-
-static std::vector<std::uint8_t> makeAAD(const Credential& c) {
-    std::string aad = c.service + "\n" + c.username + "\n" + c.created_at;
-    return toBytes(aad);
+// Echoed input that is still a secret (credential passwords)
+static secure_string prompt_secret(const std::string& message) {
+    std::cout << message << std::flush;
+    secure_string s;
+    std::getline(std::cin, s);
+    return s;
 }
 
-static std::vector<std::uint8_t> ensure_kdf_salt(DatabaseManager& db) {
-    if (auto s = db.loadKdfSalt()) return *s;
-    std::vector<std::uint8_t> salt(16);
-    if (RAND_bytes(salt.data(), static_cast<int>(salt.size())) != 1)
-        throw std::runtime_error("RAND_bytes failed for kdf_salt");
-    db.storeKdfSalt(salt);
-    return salt;
+static std::vector<std::uint8_t> makeAAD(const std::string& service,
+                                         const std::string& username,
+                                         const std::string& created_at) {
+    return makeCredentialAad(service, username, created_at);
 }
 
-static void print_row_brief(const Credential& c) {
-    std::cout << "  [" << c.id << "] " << c.service
-              << "  user=" << c.username
-              << "  created=" << c.created_at
-              << "  (encLen=" << c.enc_password.size() << ")\n";
+// Read one RFC 4180 CSV record (quoted fields, "" escapes, embedded newlines).
+// The third field (the password) is parsed straight into `password`, a secure
+// buffer the caller reuses across records; its slot in `fields` stays empty.
+// Returns false at end of input.
+static bool read_csv_record(std::istream& in, std::vector<std::string>& fields,
+                            secure_string& password) {
+    constexpr std::size_t kPasswordField = 2;
+    fields.clear();
+    password.clear();
+    if (in.peek() == std::char_traits<char>::eof()) return false;
+
+    std::string field;
+    auto put = [&](char c) {
+        if (fields.size() == kPasswordField) password.push_back(c);
+        else field.push_back(c);
+    };
+    bool quoted = false;
+    char ch;
+    while (in.get(ch)) {
+        if (quoted) {
+            if (ch == '"') {
+                if (in.peek() == '"') { put('"'); in.get(); }
+                else quoted = false;
+            } else {
+                put(ch);
+            }
+        } else if (ch == '"') {
+            quoted = true;
+        } else if (ch == ',') {
+            fields.push_back(std::move(field));
+            field.clear();
+        } else if (ch == '\n') {
+            break;
+        } else if (ch != '\r') {
+            put(ch);
+        }
+    }
+    fields.push_back(std::move(field));
+    return true;
 }
 
 // ----- Menu actions -----
@@ -54,38 +108,28 @@ static void print_row_brief(const Credential& c) {
 static void action_add(DatabaseManager& db, const EncryptionManager& enc) {
     std::string service  = prompt_line("Service: ");
     std::string username = prompt_line("Username: ");
-    std::string secret   = prompt_line("Password/Secret: ");
+    secure_string secret = prompt_secret("Password/Secret: ");
     std::string notes    = prompt_line("Notes (optional): ");
 
-    // Make the same ISO-8601 UTC timestamp format the DB uses (to keep AAD stable)
-    auto now_iso = []() -> std::string {
-        using namespace std::chrono;
-        auto now  = system_clock::now();
-        auto secs = time_point_cast<seconds>(now);
-        std::time_t t = system_clock::to_time_t(secs);
-        std::tm tm{};
-    #if defined(_WIN32)
-        gmtime_s(&tm, &t);
-    #else
-        gmtime_r(&t, &tm);
-    #endif
-        char buf[32];
-        std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
-        return std::string(buf);
-    }();
-
-    // Build AAD = service \n username \n created_at (same value we expect DB to store)
-    const std::string aad_str = service + "\n" + username + "\n" + now_iso;
-    const auto aad = toBytes(aad_str);
+    NewCredential nc;
+    nc.service    = service;
+    nc.username   = username;
+    nc.notes      = notes;
+    nc.created_at = iso8601UtcNow();
+
+    // Build AAD = service \n username \n created_at, and store that exact stamp
+    const auto aad = makeAAD(nc.service, nc.username, nc.created_at);
 
     // Encrypt the secret
-    auto encRes = enc.encrypt(toBytes(secret), aad);
+    auto encRes = enc.encrypt(asBytes(secret), aad);
+    nc.enc_password = std::move(encRes.encAndTag);
+    nc.iv           = std::move(encRes.iv);
 
     // Insert the row with the ciphertext and IV
-    int id = db.addCredential(service, username, encRes.encAndTag, encRes.iv, notes);
+    int id = db.addCredentials(std::span<const NewCredential>(&nc, 1)).front();
 
     // Optional: read back to confirm insert
-    if (auto row = db.getCredentialById(id)) {
+    if (db.getCredentialMeta(id)) {
         std::cout << "Added credential with id " << id << "\n";
     } else {
         std::cerr << "Error: inserted row not found!\n";
@@ -94,13 +138,40 @@ static void action_add(DatabaseManager& db, const EncryptionManager& enc) {
 
 
 static void action_search(DatabaseManager& db) {
-    std::string q = prompt_line("Search service (substring): ");
-    auto rows = db.searchByService(q);
-    if (rows.empty()) {
+    std::string q = prompt_line("Search service/username/notes (substring): ");
+    // Ranked: service hits first, then username, then notes
+    auto hits = db.searchCredentials(q);
+    if (hits.empty()) {
         std::cout << "No matches.\n";
         return;
     }
-    for (const auto& r : rows) print_row_brief(r);
+    for (const auto& h : hits) {
+        std::cout << "  [" << h.id << "] " << h.service
+                  << "  user=" << h.username
+                  << "  created=" << h.created_at;
+        if (!h.notes.empty()) std::cout << "  notes=" << h.notes;
+        std::cout << "\n";
+    }
+}
+
+// In-memory lookup over service/username: exact substrings first, and only
+// if there are none, fuzzy (subsequence / typo) matches
+static void action_quick_find(const MetadataIndex& index) {
+    std::string q = prompt_line("Quick find service/username: ");
+    auto hits = index.search(q, MetadataIndex::Mode::Substring);
+    if (hits.empty()) {
+        hits = index.search(q, MetadataIndex::Mode::Fuzzy, 10);
+        if (!hits.empty()) std::cout << "No exact matches; closest:\n";
+    }
+    if (hits.empty()) {
+        std::cout << "No matches.\n";
+        return;
+    }
+    for (const auto& h : hits) {
+        std::cout << "  [" << h.id << "] " << h.service
+                  << "  user=" << h.username
+                  << "  created=" << h.created_at << "\n";
+    }
 }
 
 static void action_view(DatabaseManager& db, const EncryptionManager& enc) {
@@ -108,17 +179,18 @@ static void action_view(DatabaseManager& db, const EncryptionManager& enc) {
     try { id = std::stoi(prompt_line("Enter id to view: ")); }
     catch (...) { std::cout << "Invalid id.\n"; return; }
 
-    auto row = db.getCredentialById(id);
-    if (!row) { std::cout << "Not found.\n"; return; }
+    auto cred = LazyCredential::load(db, enc, id);
+    if (!cred) { std::cout << "Not found.\n"; return; }
 
     try {
-        auto pt = enc.decrypt(row->iv, row->enc_password, makeAAD(*row));
+        const CredentialMeta& m = cred->meta;
+        const std::string_view secret = cred->secret.reveal();
         std::cout << "-----\n";
-        std::cout << "Service : " << row->service   << "\n";
-        std::cout << "Username: " << row->username  << "\n";
-        std::cout << "Notes   : " << row->notes     << "\n";
-        std::cout << "Created : " << row->created_at<< "\n";
-        std::cout << "Password: " << std::string(pt.begin(), pt.end()) << "\n";
+        std::cout << "Service : " << m.service   << "\n";
+        std::cout << "Username: " << m.username  << "\n";
+        std::cout << "Notes   : " << m.notes     << "\n";
+        std::cout << "Created : " << m.created_at<< "\n";
+        std::cout << "Password: " << secret << "\n";
         std::cout << "-----\n";
     } catch (const std::exception& ex) {
         std::cout << "Decrypt failed: " << ex.what() << "\n";
@@ -130,27 +202,29 @@ static void action_update(DatabaseManager& db, const EncryptionManager& enc) {
     try { id = std::stoi(prompt_line("Enter id to update: ")); }
     catch (...) { std::cout << "Invalid id.\n"; return; }
 
-    auto row = db.getCredentialById(id);
-    if (!row) { std::cout << "Not found.\n"; return; }
+    auto cred = LazyCredential::load(db, enc, id);
+    if (!cred) { std::cout << "Not found.\n"; return; }
 
     std::string newUser   = prompt_line("New username (blank=keep): ");
-    std::string newSecret = prompt_line("New password/secret (blank=keep): ");
+    secure_string newSecret = prompt_secret("New password/secret (blank=keep): ");
     std::string newNotes  = prompt_line("New notes (blank=keep): ");
 
-    if (newUser.empty())   newUser   = row->username;
-    if (newNotes.empty())  newNotes  = row->notes;
-
-    auto aad = toBytes(row->service + "\n" + newUser + "\n" + row->created_at);
-    std::vector<std::uint8_t> newCipher = row->enc_password;
-    std::vector<std::uint8_t> newIv     = row->iv;
+    if (newUser.empty())   newUser   = cred->meta.username;
+    if (newNotes.empty())  newNotes  = cred->meta.notes;
 
-    if (!newSecret.empty()) {
-        auto res = enc.encrypt(toBytes(newSecret), aad);
-        newCipher = std::move(res.encAndTag);
-        newIv     = std::move(res.iv);
+    // Always re-seal: the username is part of the AAD, so a kept secret must
+    // be decrypted and encrypted again under the new one
+    auto aad = makeAAD(cred->meta.service, newUser, cred->meta.created_at);
+    std::string_view pt = newSecret;
+    try {
+        if (newSecret.empty()) pt = cred->secret.reveal();
+    } catch (const std::exception& ex) {
+        std::cout << "Decrypt failed: " << ex.what() << "\n";
+        return;
     }
+    auto res = enc.encrypt(asBytes(pt), aad);
 
-    db.updateCredential(id, newUser, newCipher, newIv, newNotes);
+    db.updateCredential(id, newUser, res.encAndTag, res.iv, newNotes);
     std::cout << "Updated.\n";
 }
 
@@ -185,185 +259,655 @@ static void action_generate_password() {
 }
 
 static void action_list_all(DatabaseManager& db) {
-    auto rows = db.getAllCredentials();
-    if (rows.empty()) {
-        std::cout << "No credentials stored.\n";
-        return;
-    }
-    for (const auto& r : rows) {
-        std::cout << "  [" << r.id << "] " << r.service
-                  << "  user=" << r.username
-                  << "  created=" << r.created_at
-                  << "  (encLen=" << r.enc_password.size() << ")\n";
+    // Newest first, one page at a time; ciphertext is never read
+    constexpr int kPageSize = 20;
+    std::optional<ListCursor> cursor;
+    std::size_t shown = 0;
+    for (;;) {
+        CredentialPage page = db.listCredentials(cursor, kPageSize);
+        for (const auto& c : page.rows) {
+            std::cout << "  [" << c.id << "] " << c.service
+                      << "  user=" << c.username
+                      << "  created=" << c.created_at << "\n";
+        }
+        shown += page.rows.size();
+        if (!page.next) break;
+        std::string more = prompt_line("-- Enter for more, q to stop -- ");
+        if (more == "q" || more == "Q") break;
+        cursor = std::move(page.next);
     }
+    if (shown == 0) std::cout << "No credentials stored.\n";
 }
 
 static bool action_change_master(DatabaseManager& db) {
-    // 0) Verify current master password first
-    auto master = db.loadMaster();
-    if (!master) {
-        std::cout << "No master record present.\n";
-        return false;
-    }
-    std::string current = prompt_hidden("Current master password: ");
-    {
-        StoredAuth stored{ master->first, master->second };
-        AuthManager auth;
-        if (!auth.verifyMasterPassword(current, stored)) {
-            std::cout << "Current password incorrect. Aborting.\n";
-            std::fill(current.begin(), current.end(), '\0');
-            return false;
-        }
-    }
-
-    // 1) Prompt for new master twice
-    std::string new1 = prompt_hidden("New master password: ");
-    std::string new2 = prompt_hidden("Confirm new master password: ");
+    // 0) Prompt for current and new master (new twice)
+    // secure_string: wiped when these go out of scope, on every path
+    secure_string current = prompt_hidden("Current master password: ");
+    secure_string new1 = prompt_hidden("New master password: ");
+    secure_string new2 = prompt_hidden("Confirm new master password: ");
     if (new1.empty()) {
         std::cout << "Empty not allowed.\n";
-        std::fill(current.begin(), current.end(), '\0');
         return false;
     }
     if (new1 != new2) {
         std::cout << "Mismatch.\n";
-        std::fill(current.begin(), current.end(), '\0');
-        std::fill(new1.begin(), new1.end(), '\0');
-        std::fill(new2.begin(), new2.end(), '\0');
         return false;
     }
 
-    // 2) Derive OLD key from existing kdf_salt
-    auto oldKdfSaltOpt = db.loadKdfSalt();
-    if (!oldKdfSaltOpt) {
-        std::cout << "No KDF salt present. (Login once first to create it.)\n";
-        std::fill(current.begin(), current.end(), '\0');
-        std::fill(new1.begin(), new1.end(), '\0');
-        std::fill(new2.begin(), new2.end(), '\0');
-        return false;
-    }
-    const auto& oldKdfSalt = *oldKdfSaltOpt;
-    auto oldKey = EncryptionManager::deriveKey(current, oldKdfSalt);
-    EncryptionManager encOld(oldKey);
-
-    // 3) Generate NEW kdf_salt and key
-    std::vector<std::uint8_t> newKdfSalt(16);
-    if (RAND_bytes(newKdfSalt.data(), static_cast<int>(newKdfSalt.size())) != 1) {
-        std::cout << "RNG failed.\n";
-        std::fill(current.begin(), current.end(), '\0');
-        std::fill(new1.begin(), new1.end(), '\0');
-        std::fill(new2.begin(), new2.end(), '\0');
+    // 1) Verify, derive the new key and re-encrypt everything in one
+    //    transaction (rolled back on failure)
+    try {
+        std::size_t total = 0;
+        auto changed = changeMasterPassword(db, current, new1,
+            [&total](std::size_t done, std::size_t all) {
+                total = all;
+                std::cout << "\rRe-encrypting " << done << "/" << all << std::flush;
+            });
+        if (total > 0) std::cout << "\n";
+        if (!changed) {
+            std::cout << "Current password incorrect. Aborting.\n";
+            return false;
+        }
+        std::cout << "Master password changed. Re-encrypted all credentials.\n";
+        return true;
+    } catch (const std::exception& ex) {
+        std::cout << "Change failed, rolled back: " << ex.what() << "\n";
         return false;
     }
-    auto newKey = EncryptionManager::deriveKey(new1, newKdfSalt);
-    EncryptionManager encNew(newKey);
+}
 
-    // 4) Re-encrypt everything inside a transaction
-    try {
-        db.beginTransaction(); // must use persistent connection
 
-        auto rows = db.getAllCredentials(); // must include notes
-        for (const auto& r : rows) {
-            // AAD is stable triplet
-            std::string aadStr = r.service + "\n" + r.username + "\n" + r.created_at;
-            std::vector<std::uint8_t> aad(aadStr.begin(), aadStr.end());
+// ----- Non-interactive modes -----
+
+// Restore an `epm export` container: all rows or none
+static int run_import_export(DatabaseManager& db, const EncryptionManager& enc, std::istream& in) {
+    secure_string passphrase = prompt_hidden("Export passphrase: ");
+    const auto start = std::chrono::steady_clock::now();
+    const ExportStats stats = importVault(db, enc, passphrase, in);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Imported " << stats.records << " credentials from " << stats.chunks
+              << " chunks in " << secs << " s.\n";
+    return 0;
+}
+
+// Import plaintext CSV rows (service,username,password[,notes]) in batched
+// transactions. A leading "service,..." header line is skipped. Files
+// written by `epm export` are recognised and restored instead.
+static int run_import(DatabaseManager& db, const EncryptionManager& enc,
+                      const std::string& path, std::size_t batchSize) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << path << "\n";
+        return 1;
+    }
+    if (isVaultExport(in)) return run_import_export(db, enc, in);
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::string createdAt = iso8601UtcNow(); // one stamp for the whole import
+
+    std::vector<NewCredential> batch;
+    batch.reserve(batchSize);
+    std::vector<std::string> fields;
+    secure_string password;        // reused for every row, wiped when it grows
+    std::vector<std::uint8_t> aad; // reused for every row
+    std::size_t record = 0, imported = 0, skipped = 0;
+
+    auto flush = [&]() {
+        if (batch.empty()) return;
+        imported += db.addCredentials(batch, batchSize).size();
+        batch.clear();
+    };
+
+    while (read_csv_record(in, fields, password)) {
+        ++record;
+        if (record == 1 && fields[0] == "service") continue; // header
+        if (fields.size() < 3 || fields[0].empty()) {
+            ++skipped;
+            continue;
+        }
 
-            // decrypt with old key
-            auto pt = encOld.decrypt(r.iv, r.enc_password, aad);
+        NewCredential nc;
+        nc.service    = std::move(fields[0]);
+        nc.username   = std::move(fields[1]);
+        nc.notes      = fields.size() > 3 ? std::move(fields[3]) : std::string{};
+        nc.created_at = createdAt;
 
-            // encrypt with new key
-            auto encRes = encNew.encrypt(pt, aad);
+        // Encrypt straight from the parsed password into the row's buffers
+        sealCredential(enc, password, nc.service, nc.username, nc.created_at,
+                       nc.iv, nc.enc_password, aad);
+
+        batch.push_back(std::move(nc));
+        if (batch.size() >= batchSize) flush();
+    }
+    flush();
+
+    const double secs = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "Imported " << imported << " credentials";
+    if (skipped) std::cout << " (skipped " << skipped << " malformed rows)";
+    std::cout << " in " << secs << " s";
+    if (secs > 0) std::cout << " (" << static_cast<std::size_t>(imported / secs) << " rows/s)";
+    std::cout << ".\n";
+    return 0;
+}
 
-            // update row — preserve username and notes; DO NOT change created_at
-            db.updateCredential(r.id, r.username, encRes.encAndTag, encRes.iv, r.notes);
+// Write the whole vault to an encrypted container under a new passphrase.
+// Written to <path>.tmp and renamed, so a failed export never leaves a
+// partial file under the final name.
+static int run_export(const DatabaseManager& db, const EncryptionManager& enc,
+                      const std::string& path, bool compress) {
+    if (compress && !exportCompressionAvailable()) {
+        std::cerr << "This build has no zstd support; export without --zstd.\n";
+        return 1;
+    }
+    secure_string pw1 = prompt_hidden("New export passphrase: ");
+    secure_string pw2 = prompt_hidden("Confirm export passphrase: ");
+    if (pw1.empty() || pw1 != pw2) {
+        std::cerr << "Invalid passphrase.\n";
+        return 1;
+    }
 
-            // scrub plaintext asap
-            std::fill(pt.begin(), pt.end(), 0);
+    const std::string tmp = path + ".tmp";
+    const auto start = std::chrono::steady_clock::now();
+    ExportStats stats;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Cannot write " << tmp << "\n";
+            return 1;
         }
+        ExportOptions options;
+        options.compress = compress;
+        try {
+            stats = exportVault(db, enc, pw1, out, options);
+        } catch (...) {
+            out.close();
+            std::filesystem::remove(tmp);
+            throw;
+        }
+    }
+    std::filesystem::rename(tmp, path);
 
-        // 5) Update app_settings.kdf_salt
-        db.storeKdfSalt(newKdfSalt);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Exported " << stats.records << " credentials (" << stats.bytes / 1024 << " KiB, "
+              << stats.chunks << " chunks) in " << secs << " s.\n";
+    return 0;
+}
 
-        // 6) Update master_auth {salt, hash} for the new master
-        {
-            AuthManager auth;
-            StoredAuth newAuth = auth.createMasterRecord(new1);
-            db.storeMaster(newAuth.salt, newAuth.hash);
+#if !defined(_WIN32)
+// Buffered output over a descriptor the caller opened, so a file created with
+// O_NOFOLLOW and mode 0600 is written through that same descriptor and never
+// reopened by name. The buffer is locked and wiped like other secrets; the
+// descriptor is closed on destruction.
+class FdOutBuf : public std::streambuf {
+public:
+    explicit FdOutBuf(int fd) : m_fd(fd), m_buf(64 * 1024) {
+        setp(m_buf.data(), m_buf.data() + m_buf.size());
+    }
+    ~FdOutBuf() override {
+        drain();
+        ::close(m_fd);
+    }
+    FdOutBuf(const FdOutBuf&) = delete;
+    FdOutBuf& operator=(const FdOutBuf&) = delete;
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!drain()) return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+    int sync() override { return drain() ? 0 : -1; }
+
+private:
+    bool drain() {
+        const char* p = pbase();
+        while (p < pptr()) {
+            const ssize_t n = ::write(m_fd, p, static_cast<std::size_t>(pptr() - p));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            p += n;
         }
+        setp(m_buf.data(), m_buf.data() + m_buf.size());
+        return true;
+    }
 
-        db.commit();
-        std::cout << "Master password changed. Re-encrypted all credentials.\n";
+    int m_fd;
+    std::vector<char, SecureAllocator<char>> m_buf;
+};
+#endif
+
+// Plaintext dump in id order, decrypted on all cores. On POSIX a file target
+// is opened once without following symlinks, narrowed to mode 0600 (if it
+// already existed) before it is truncated, and written through that
+// descriptor; on Windows it gets the default ACL of its directory.
+static int run_dump(const DatabaseManager& db, const EncryptionManager& enc,
+                    DumpFormat format, const std::string& path, std::size_t threads) {
+#if !defined(_WIN32)
+    std::unique_ptr<FdOutBuf> fileBuf;
+    if (!path.empty()) {
+        const int fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_NOFOLLOW | O_CLOEXEC, 0600);
+        if (fd < 0 || ::fchmod(fd, 0600) != 0 || ::ftruncate(fd, 0) != 0) {
+            if (fd >= 0) ::close(fd);
+            std::cerr << "Cannot write " << path << "\n";
+            return 1;
+        }
+        fileBuf = std::make_unique<FdOutBuf>(fd);
+    }
+    std::ostream file(fileBuf.get());
+#else
+    std::ofstream file;
+    if (!path.empty()) {
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "Cannot write " << path << "\n";
+            return 1;
+        }
+    }
+#endif
+    std::ostream& out = path.empty() ? std::cout : file;
+
+    ScanOptions options;
+    options.threads = threads;
+    const auto start = std::chrono::steady_clock::now();
+    const DumpStats stats = dumpVault(db, enc, out, format, options);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Dumped " << stats.rows << " credentials in " << secs << " s";
+    if (secs > 0) std::cerr << " (" << static_cast<std::size_t>(stats.rows / secs) << " rows/s)";
+    std::cerr << ".\n";
+    if (stats.failed) {
+        std::cerr << stats.failed << " rows failed to decrypt and were skipped (see epm verify).\n";
+        return 3;
+    }
+    return 0;
+}
 
-        // scrub secrets
-        std::fill(current.begin(), current.end(), '\0');
-        std::fill(new1.begin(), new1.end(), '\0');
-        std::fill(new2.begin(), new2.end(), '\0');
+// Authenticate every row and report what is wrong, one line per finding
+static int run_verify(const DatabaseManager& db, const EncryptionManager& enc, std::size_t threads) {
+    ScanOptions options;
+    options.threads = threads;
+    const auto start = std::chrono::steady_clock::now();
+    const VerifyReport report = verifyVault(db, enc, options);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const std::string& e : report.storageErrors) std::cout << "storage: " << e << "\n";
+    for (const VerifyFinding& f : report.findings) {
+        std::cout << "id " << f.id << ": " << verifyIssueName(f.issue);
+        if (f.issue == VerifyIssue::DuplicateIv) std::cout << " (same as id " << f.otherId << ")";
+        std::cout << "\n";
+    }
+    std::cout << "Verified " << report.rows << " credentials in " << secs << " s";
+    if (secs > 0) std::cout << " (" << static_cast<std::size_t>(report.rows / secs) << " rows/s)";
+    std::cout << ": ";
+    if (report.clean()) std::cout << "no problems found.\n";
+    else std::cout << report.findings.size() << " row problems, "
+                   << report.storageErrors.size() << " storage errors.\n";
+    return report.clean() ? 0 : 3;
+}
 
-        return true;
-    } catch (const std::exception& ex) {
-        try { db.rollback(); } catch (...) {}
-        std::cout << "Change failed, rolled back: " << ex.what() << "\n";
+// Weak, reused and old credentials, one line per finding; never prints secrets
+static int run_audit(const DatabaseManager& db, const EncryptionManager& enc,
+                     std::size_t threads, int maxAgeDays) {
+    AuditOptions options;
+    options.scan.threads = threads;
+    if (maxAgeDays > 0) options.oldBefore = iso8601DaysAgo(maxAgeDays);
+    const auto start = std::chrono::steady_clock::now();
+    const AuditReport report = auditVault(db, enc, options);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const WeakFinding& w : report.weak) {
+        std::cout << "id " << w.id << ": weak (" << strengthLabel(w.score) << ", ~"
+                  << static_cast<int>(w.bits) << " bits)\n";
+    }
+    for (const auto& group : report.reused) {
+        std::cout << "reused by " << group.size() << " ids:";
+        for (const int id : group) std::cout << " " << id;
+        std::cout << "\n";
+    }
+    for (const OldFinding& o : report.old) {
+        std::cout << "id " << o.id << ": old (created " << o.created_at << ")\n";
+    }
+    std::cout << "Audited " << report.rows << " credentials in " << secs << " s";
+    if (secs > 0) std::cout << " (" << static_cast<std::size_t>(report.rows / secs) << " rows/s)";
+    std::cout << ": ";
+    if (report.clean()) {
+        std::cout << "no problems found.\n";
+    } else {
+        std::cout << report.weak.size() << " weak, " << report.reused.size() << " reused groups, "
+                  << report.old.size() << " old";
+        if (report.failed) std::cout << ", " << report.failed << " undecryptable (see epm verify)";
+        std::cout << ".\n";
+    }
+    return report.clean() ? 0 : 3;
+}
 
-        // scrub secrets even on failure
-        std::fill(current.begin(), current.end(), '\0');
-        std::fill(new1.begin(), new1.end(), '\0');
-        std::fill(new2.begin(), new2.end(), '\0');
+// Measure Argon2id on this host, show current vs proposed costs and, after
+// re-entering the master password, re-key the vault under the new costs.
+static int run_calibrate(DatabaseManager& db, std::chrono::milliseconds target) {
+    auto describe = [](const KdfParams& p) {
+        return "t=" + std::to_string(p.tCost) + " m=" + std::to_string(p.mCostKiB / 1024)
+             + " MiB p=" + std::to_string(p.parallelism);
+    };
+
+    const KdfParams current = db.loadKdfParams().value_or(KdfParams{});
+    std::cout << "Calibrating Argon2id for ~" << target.count() << " ms...\n";
+    const KdfCalibration cal = calibrateKdf(target);
+    std::cout << "Current:  " << describe(current) << "\n"
+              << "Proposed: " << describe(cal.params)
+              << "  (" << cal.measured.count() << " ms here)\n";
+    if (cal.params == current) {
+        std::cout << "Already calibrated.\n";
+        return 0;
+    }
 
-        return false;
+    std::string answer = prompt_line("Apply and re-encrypt the vault? [y/N] ");
+    if (answer != "y" && answer != "Y") {
+        std::cout << "Unchanged.\n";
+        return 0;
+    }
+
+    secure_string pw = prompt_hidden("Master password: ");
+    // Same password, new costs: fresh salt + re-key in one transaction
+    auto applied = changeMasterPassword(db, pw, pw, [](std::size_t done, std::size_t total) {
+        std::cout << "\rRe-encrypting " << done << "/" << total << std::flush;
+        if (done == total) std::cout << "\n";
+    }, cal.params);
+    if (!applied) {
+        std::cerr << "Login failed ❌\n";
+        return 2;
+    }
+    std::cout << "KDF parameters updated.\n";
+    return 0;
+}
+
+// EPM_STATS=1 prints the latency histograms to stderr when epm exits
+struct StatsOnExit {
+    ~StatsOnExit() {
+        const char* env = std::getenv("EPM_STATS");
+        if (env && *env && std::string(env) != "0") instrumentation::dump(std::cerr);
     }
+};
+
+static void print_usage() {
+    std::cerr << "Usage:\n"
+                 "  epm                                     interactive menu\n"
+                 "  epm import <file.csv> [--batch-size N]  bulk import service,username,password[,notes]\n"
+                 "  epm import <file.epmx>                  restore a file written by epm export\n"
+                 "  epm export <file.epmx> [--zstd]         encrypted backup of the whole vault\n"
+                 "  epm dump [--format csv|jsonl] [--out FILE] [--threads N]\n"
+                 "                                          PLAINTEXT dump of every credential (default csv\n"
+                 "                                          to stdout)\n"
+                 "  epm verify [--threads N]                check every row's tag, IV and fields\n"
+                 "  epm audit [--threads N] [--max-age DAYS]\n"
+                 "                                          report weak, reused and (default 365 days) old\n"
+                 "                                          passwords; --max-age 0 skips the age check\n"
+                 "  epm generate [--count N] [--length L] [--no-symbols] [--no-ambiguous]\n"
+                 "               [--min-upper N] [--min-lower N] [--min-digits N] [--min-symbols N]\n"
+                 "  epm generate [--count N] --wordlist FILE [--words K] [--separator S] [--capitalize]\n"
+                 "                                          print N random passwords or passphrases\n"
+                 "  epm calibrate [target-ms]               tune Argon2id cost to this host (default 500 ms)\n"
+                 "  epm upgrade                             re-encrypt an older vault for the single-KDF unlock\n"
+                 "  epm --batch                             master password on the first stdin line, then\n"
+                 "                                          JSON commands, one per line (see BatchRunner.hpp)\n";
 }
 
+// `epm generate ...`: needs no vault. Writes one password per line through
+// a block buffer, so large counts are cheap.
+static int run_generate(int argc, char** argv) {
+    PasswordPolicy policy;
+    PassphrasePolicy phrase;
+    std::string wordlistPath;
+    std::size_t count = 1;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--no-symbols")   { policy.symbols = false; continue; }
+        if (arg == "--no-ambiguous") { policy.excludeAmbiguous = true; continue; }
+        if (arg == "--capitalize")   { phrase.capitalize = true; continue; }
+        if (i + 1 >= argc) { print_usage(); return 1; }
+        const std::string val = argv[++i];
+        if (arg == "--wordlist")  { wordlistPath = val; continue; }
+        if (arg == "--separator") { phrase.separator = val; continue; }
+
+        std::size_t n = 0;
+        try { n = static_cast<std::size_t>(std::stoul(val)); }
+        catch (...) { print_usage(); return 1; }
+        if (arg == "--count")            count = n;
+        else if (arg == "--length")      policy.length = n;
+        else if (arg == "--words")       phrase.words = n;
+        else if (arg == "--min-upper")   policy.minUpper = n;
+        else if (arg == "--min-lower")   policy.minLower = n;
+        else if (arg == "--min-digits")  policy.minDigits = n;
+        else if (arg == "--min-symbols") policy.minSymbols = n;
+        else { print_usage(); return 1; }
+    }
+
+    try {
+        std::optional<PasswordGenerator> gen;
+        if (wordlistPath.empty()) {
+            gen.emplace(policy);
+        } else {
+            std::ifstream list(wordlistPath);
+            if (!list) {
+                std::cerr << "Cannot open " << wordlistPath << "\n";
+                return 1;
+            }
+            gen.emplace(readWordlist(list), phrase);
+        }
+
+        constexpr std::size_t kBlock = 4096;
+        std::string out;
+        for (std::size_t done = 0; done < count;) {
+            const auto block = gen->generateMany(std::min(kBlock, count - done));
+            out.clear();
+            for (const std::string& pw : block) {
+                out += pw;
+                out += '\n';
+            }
+            std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+            done += block.size();
+        }
+        std::cout.flush();
+        std::cerr << "~" << static_cast<int>(gen->entropyBits()) << " bits each\n";
+        return std::cout ? 0 : 1;
+    } catch (const std::invalid_argument& ex) {
+        std::cerr << ex.what() << "\n";
+        return 1;
+    }
+}
 
 // ----- Main -----
 
-int main() {
+int main(int argc, char** argv) {
+    const StatsOnExit statsOnExit;
+
+    // Parse the optional non-interactive mode before touching the vault
+    const std::string mode = argc > 1 ? argv[1] : "";
+    std::string importPath, exportPath;
+    bool exportZstd = false;
+    DumpFormat dumpFormat = DumpFormat::Csv;
+    std::string dumpPath;
+    std::size_t scanThreads = 0;
+    std::size_t batchSize = DatabaseManager::kDefaultBatchSize;
+    int auditMaxAge = 365;
+    std::chrono::milliseconds calibrateTarget(500);
+    if (mode == "import") {
+        if (argc < 3) { print_usage(); return 1; }
+        importPath = argv[2];
+        for (int i = 3; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--batch-size" && i + 1 < argc) {
+                try { batchSize = static_cast<std::size_t>(std::stoul(argv[++i])); }
+                catch (...) { batchSize = 0; }
+                if (batchSize == 0) { print_usage(); return 1; }
+            } else {
+                print_usage();
+                return 1;
+            }
+        }
+    } else if (mode == "export") {
+        if (argc < 3 || argc > 4) { print_usage(); return 1; }
+        exportPath = argv[2];
+        if (argc == 4) {
+            if (std::string(argv[3]) != "--zstd") { print_usage(); return 1; }
+            exportZstd = true;
+        }
+    } else if (mode == "dump") {
+        std::ios::sync_with_stdio(false); // one buffered stream for millions of lines
+        for (int i = 2; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) { print_usage(); return 1; }
+            const std::string val = argv[++i];
+            if (arg == "--format") {
+                const auto f = parseDumpFormat(val);
+                if (!f) { print_usage(); return 1; }
+                dumpFormat = *f;
+            } else if (arg == "--out") {
+                dumpPath = val;
+            } else if (arg == "--threads") {
+                try { scanThreads = static_cast<std::size_t>(std::stoul(val)); }
+                catch (...) { print_usage(); return 1; }
+            } else {
+                print_usage();
+                return 1;
+            }
+        }
+    } else if (mode == "verify") {
+        if (argc == 4 && std::string(argv[2]) == "--threads") {
+            try { scanThreads = static_cast<std::size_t>(std::stoul(argv[3])); }
+            catch (...) { print_usage(); return 1; }
+        } else if (argc != 2) {
+            print_usage();
+            return 1;
+        }
+    } else if (mode == "audit") {
+        for (int i = 2; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) { print_usage(); return 1; }
+            const std::string val = argv[++i];
+            try {
+                if (arg == "--threads") {
+                    scanThreads = static_cast<std::size_t>(std::stoul(val));
+                } else if (arg == "--max-age") {
+                    auditMaxAge = std::stoi(val);
+                    if (auditMaxAge < 0) { print_usage(); return 1; }
+                } else {
+                    print_usage();
+                    return 1;
+                }
+            } catch (...) { print_usage(); return 1; }
+        }
+    } else if (mode == "calibrate") {
+        if (argc > 3) { print_usage(); return 1; }
+        if (argc == 3) {
+            try { calibrateTarget = std::chrono::milliseconds(std::stol(argv[2])); }
+            catch (...) { calibrateTarget = std::chrono::milliseconds(0); }
+            if (calibrateTarget.count() <= 0) { print_usage(); return 1; }
+        }
+    } else if (mode == "upgrade") {
+        if (argc != 2) { print_usage(); return 1; }
+    } else if (mode == "generate") {
+        return run_generate(argc, argv);
+    } else if (mode == "--batch") {
+        if (argc > 2) { print_usage(); return 1; }
+        // Before any I/O: buffered stdin lets the runner see whether more
+        // commands are already queued (and so keep a transaction open)
+        std::ios::sync_with_stdio(false);
+    } else if (!mode.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    // In batch and dump modes stdout carries data; chatter goes to stderr
+    const bool batch = mode == "--batch";
+    std::ostream& status = batch || mode == "dump" ? std::cerr : std::cout;
+
     try {
-        std::cout << "EPM starting...\n";
+        status << "EPM starting...\n";
         std::filesystem::create_directories("data");
         DatabaseManager db("data/epm.sqlite");
         db.init();
 
-        AuthManager auth;
-        auto master = db.loadMaster();
-
-        if (!master.has_value()) {
+        if (!db.loadMaster().has_value()) {
+            if (!mode.empty()) {
+                std::cerr << "No master password set. Run epm once interactively first.\n";
+                return 1;
+            }
             std::cout << "No master password found (first run).\n";
-            std::string pw1 = prompt_hidden("Enter new master password: ");
-            std::string pw2 = prompt_hidden("Confirm master password: ");
+            secure_string pw1 = prompt_hidden("Enter new master password: ");
+            secure_string pw2 = prompt_hidden("Confirm master password: ");
 
             if (pw1.empty() || pw1 != pw2) {
                 std::cerr << "Invalid password.\n";
                 return 1;
             }
 
-            // ✅ Create once, store both pieces together
-            StoredAuth rec = auth.createMasterRecord(pw1);
-            db.storeMaster(rec.salt, rec.hash);
+            // ✅ One Argon2id run yields both the verifier and K_enc
+            createVault(db, pw1);
 
             std::cout << "Master password set. You can now log in.\n";
             return 0;
         }
 
-
-        std::cout << "Master record found. Please log in.\n";
-        std::string pw = prompt_hidden("Enter master password: ");
-        if (!auth.verifyMasterPassword(pw, StoredAuth{ master->first, master->second })) {
+        // Verifies the password itself, after measuring
+        if (mode == "calibrate") return run_calibrate(db, calibrateTarget);
+
+        status << "Master record found. Please log in.\n";
+        secure_string pw = prompt_hidden("Enter master password: ", status);
+        // Older vaults only move to the single-KDF scheme on `epm upgrade`,
+        // so a row that fails to re-key never locks the user out
+        auto unlocked = mode == "upgrade"
+            ? upgradeVault(db, pw, [&status](std::size_t done, std::size_t total) {
+                  status << "\rUpgrading vault " << done << "/" << total << std::flush;
+                  if (done == total) status << "\n";
+              })
+            : unlockVault(db, pw);
+        pw = secure_string(); // wipe now rather than at exit
+        if (!unlocked) {
             std::cerr << "Login failed ❌\n";
             return 2;
         }
-        std::cout << "Login succesful\n";
+        status << "Login succesful\n";
+
+        if (mode == "upgrade") {
+            std::cout << "Vault uses the single-KDF scheme.\n";
+            return 0;
+        }
+        if (db.loadMasterScheme() == kMasterSchemeTwoHash) {
+            status << "This vault uses the older two-KDF unlock; run `epm upgrade` to speed it up.\n";
+        }
+
+        EncryptionManager enc = std::move(*unlocked);
+
+        if (mode == "import") return run_import(db, enc, importPath, batchSize);
+        if (mode == "export") return run_export(db, enc, exportPath, exportZstd);
+        if (mode == "dump") return run_dump(db, enc, dumpFormat, dumpPath, scanThreads);
+        if (mode == "verify") return run_verify(db, enc, scanThreads);
+        if (mode == "audit") return run_audit(db, enc, scanThreads, auditMaxAge);
+        if (batch) {
+            const std::size_t failed = BatchRunner(db, enc).run(std::cin, std::cout);
+            return failed == 0 ? 0 : 3;
+        }
 
-        EncryptionManager enc(EncryptionManager::deriveKey(pw, ensure_kdf_salt(db)));
+        // Kept current by the DB from here on; db outlives it and never
+        // calls the observer from its destructor
+        MetadataIndex index = MetadataIndex::build(db);
+        db.setObserver(&index);
 
         for (;;) {
             std::cout << "\n=== Menu ===\n"
                          "1) Add credential\n"
-                         "2) Search by service\n"
+                         "2) Search\n"
                          "3) View (decrypt) by id\n"
                          "4) Update by id\n"
                          "5) Delete by id\n"
                          "6) Generate password\n"
                          "7) List all credentials\n"
                          "8) change master password\n"
+                         "9) Quick find (fuzzy)\n"
+                         "s) Latency stats\n"
                          "q) Quit\n";
             std::string choice = prompt_line("> ");
 
@@ -380,6 +924,8 @@ int main() {
                     break; // force exit to avoid using old EncryptionManager
                 }
             }
+            else if (choice == "9") action_quick_find(index);
+            else if (choice == "s" || choice == "S") instrumentation::dump(std::cout);
             else if (choice == "q" || choice == "Q") break;
             else std::cout << "Unknown option.\n";
         }
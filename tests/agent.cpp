@@ -0,0 +1,283 @@
+// tests/agent.cpp
+#include <catch2/catch_all.hpp>
+#include "AgentClient.hpp"
+#include "AgentProtocol.hpp"
+#include "AgentServer.hpp"
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    EncryptionManager test_key() {
+        return EncryptionManager(std::vector<std::uint8_t>(32, 0x42));
+    }
+
+    AgentServer::Options test_options(const std::string& sock) {
+        AgentServer::Options o;
+        o.socketPath = sock;
+        o.idleTimeout = std::chrono::seconds(0);
+        return o;
+    }
+
+    // Raw connection for pipelining and malformed frames
+    int raw_connect(const std::string& path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0);
+        return fd;
+    }
+
+    // Next response payload, or empty if the agent closed the connection
+    secure_vector raw_response(int fd) {
+        secure_vector buf;
+        std::uint8_t b;
+        while (!agent::completeFrame(buf)) {
+            if (::recv(fd, &b, 1, 0) != 1) return {};
+            buf.push_back(b);
+        }
+        buf.erase(buf.begin(), buf.begin() + 4);
+        return buf;
+    }
+}
+
+TEST_CASE("agent protocol: frames round-trip", "[agent]") {
+    secure_vector buf;
+    agent::FrameWriter(buf).u8(4).i32(-7).str("svc").str("").u32(0xDEADBEEF).finish();
+    agent::FrameWriter(buf).u8(1).finish();
+
+    const auto len = agent::completeFrame(buf);
+    REQUIRE(len);
+    agent::Reader r(std::span<const std::uint8_t>(buf).subspan(4, *len));
+    CHECK(r.u8() == 4);
+    CHECK(r.i32() == -7);
+    CHECK(r.str() == "svc");
+    CHECK(r.str().empty());
+    CHECK(r.u32() == 0xDEADBEEF);
+    CHECK(r.done());
+    CHECK_THROWS_AS(r.u8(), std::invalid_argument);
+
+    // Incomplete prefix or payload: wait for more
+    CHECK_FALSE(agent::completeFrame(std::span<const std::uint8_t>(buf).first(3)));
+    CHECK_FALSE(agent::completeFrame(std::span<const std::uint8_t>(buf).first(4 + *len - 1)));
+
+    const std::uint8_t huge[4] = {0xFF, 0xFF, 0xFF, 0x7F};
+    CHECK_THROWS_AS(agent::completeFrame(huge), std::length_error);
+}
+
+TEST_CASE("agent: serves get/search/add over the socket", "[agent]") {
+    const std::string testDb = "tmp_test_agent.sqlite";
+    const std::string sock = "tmp_test_agent.sock";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        AgentServer server(db, test_key(), test_options(sock));
+
+        struct stat st{};
+        REQUIRE(::stat(sock.c_str(), &st) == 0);
+        CHECK((st.st_mode & 0777) == 0600);
+        CHECK_THROWS_AS(AgentServer(db, test_key(), test_options(sock)), std::runtime_error);
+
+        AgentServer::StopReason reason{};
+        std::thread loop([&] { reason = server.run(); });
+
+        {
+            AgentClient client(sock);
+            client.ping();
+            const int id = client.add("github", "octocat", "s3cret", "work");
+            CHECK(id == 1);
+
+            const auto cred = client.get(id);
+            REQUIRE(cred);
+            CHECK(cred->meta.service == "github");
+            CHECK(cred->meta.username == "octocat");
+            CHECK(cred->meta.notes == "work");
+            CHECK(std::string_view(cred->password) == "s3cret");
+            CHECK_FALSE(client.get(999).has_value());
+
+            const auto hits = client.search("git", 10);
+            REQUIRE(hits.size() == 1);
+            CHECK(hits[0].id == id);
+            CHECK_THROWS_AS(client.search("git", 0), std::invalid_argument);
+            CHECK_THROWS_AS(client.add("", "x", "y"), std::invalid_argument);
+            client.ping(); // still usable after an error
+        }
+
+        // Many clients at once, each reading back its own writes
+        std::vector<std::thread> clients;
+        std::atomic<int> good{0};
+        for (int t = 0; t < 32; ++t) {
+            clients.emplace_back([&, t] {
+                AgentClient c(sock);
+                for (int i = 0; i < 10; ++i) {
+                    const std::string secret = "pw-" + std::to_string(t) + "-" + std::to_string(i);
+                    const int id = c.add("svc" + std::to_string(t), "u", secret);
+                    const auto back = c.get(id);
+                    if (back && std::string_view(back->password) == secret) ++good;
+                }
+            });
+        }
+        for (auto& t : clients) t.join();
+        CHECK(good == 320);
+
+        AgentClient(sock).lock();
+        loop.join();
+        CHECK(reason == AgentServer::StopReason::Locked);
+        CHECK_FALSE(std::filesystem::exists(sock));
+        CHECK(db.countCredentials() == 321);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("agent: pipelined and malformed requests", "[agent]") {
+    const std::string testDb = "tmp_test_agent_raw.sqlite";
+    const std::string sock = "tmp_test_agent_raw.sock";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        AgentServer server(db, test_key(), test_options(sock));
+        AgentServer::StopReason reason{};
+        std::thread loop([&] { reason = server.run(); });
+
+        // Add, Get of that row, Ping in one write: answered in order, and
+        // the Get sees the committed row
+        {
+            secure_vector req;
+            agent::FrameWriter(req).u8(static_cast<std::uint8_t>(agent::Op::Add))
+                .str("a").str("b").str("c").str("").finish();
+            agent::FrameWriter(req).u8(static_cast<std::uint8_t>(agent::Op::Get)).i32(1).finish();
+            agent::FrameWriter(req).u8(static_cast<std::uint8_t>(agent::Op::Ping)).finish();
+            agent::FrameWriter(req).u8(99).finish();
+            const int fd = raw_connect(sock);
+            REQUIRE(::send(fd, req.data(), req.size(), 0) == static_cast<ssize_t>(req.size()));
+
+            auto r = raw_response(fd);
+            REQUIRE(r.size() == 5);
+            CHECK(r[0] == static_cast<std::uint8_t>(agent::Status::Ok));
+            r = raw_response(fd);
+            REQUIRE_FALSE(r.empty());
+            CHECK(r[0] == static_cast<std::uint8_t>(agent::Status::Ok));
+            r = raw_response(fd);
+            CHECK(r.size() == 1);
+            r = raw_response(fd);
+            REQUIRE_FALSE(r.empty());
+            CHECK(r[0] == static_cast<std::uint8_t>(agent::Status::BadRequest));
+            ::close(fd);
+        }
+
+        // An oversized frame gets the connection dropped
+        {
+            const int fd = raw_connect(sock);
+            const std::uint8_t huge[5] = {0xFF, 0xFF, 0xFF, 0x7F, 1};
+            ::send(fd, huge, sizeof(huge), 0);
+            CHECK(raw_response(fd).empty());
+            ::close(fd);
+        }
+
+        // Half-closed client still gets its answer
+        {
+            secure_vector req;
+            agent::FrameWriter(req).u8(static_cast<std::uint8_t>(agent::Op::Ping)).finish();
+            const int fd = raw_connect(sock);
+            ::send(fd, req.data(), req.size(), 0);
+            ::shutdown(fd, SHUT_WR);
+            CHECK(raw_response(fd).size() == 1);
+            ::close(fd);
+        }
+
+        server.stop();
+        loop.join();
+        CHECK(reason == AgentServer::StopReason::Stopped);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("agent: idle timeout wipes the key", "[agent]") {
+    const std::string testDb = "tmp_test_agent_idle.sqlite";
+    const std::string sock = "tmp_test_agent_idle.sock";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        auto opt = test_options(sock);
+        opt.idleTimeout = std::chrono::seconds(1);
+        AgentServer server(db, test_key(), opt);
+        const auto start = std::chrono::steady_clock::now();
+        CHECK(server.run() == AgentServer::StopReason::IdleTimeout);
+        CHECK(std::chrono::steady_clock::now() - start >= std::chrono::seconds(1));
+        CHECK_FALSE(std::filesystem::exists(sock));
+        CHECK_THROWS_AS(AgentClient(sock), std::runtime_error);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("agent: refuses a socket directory others can reach", "[agent]") {
+    const std::string testDb = "tmp_test_agent_dir.sqlite";
+    const std::string dir = "tmp_test_agent_dir";
+    const std::string sock = dir + "/agent.sock";
+    std::filesystem::remove(testDb);
+    std::filesystem::remove_all(dir);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        // Pre-created with group/other access, as someone racing /tmp might
+        REQUIRE(::mkdir(dir.c_str(), 0700) == 0);
+        REQUIRE(::chmod(dir.c_str(), 0755) == 0);
+        CHECK_THROWS_AS(AgentServer(db, test_key(), test_options(sock)), std::runtime_error);
+        CHECK_FALSE(std::filesystem::exists(sock));
+
+        REQUIRE(::chmod(dir.c_str(), 0700) == 0);
+        AgentServer server(db, test_key(), test_options(sock));
+        std::thread loop([&] { server.run(); });
+        AgentClient client(sock); // same uid: SO_PEERCRED check passes
+        client.ping();
+        server.stop();
+        loop.join();
+    }
+    std::filesystem::remove_all(dir);
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("agent: client rejects a row count the response can't hold", "[agent]") {
+    const std::string sock = "tmp_test_agent_fake.sock";
+    std::filesystem::remove(sock);
+
+    // A fake agent answering any request with Ok and 2^32-1 rows, no row data
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", sock.c_str());
+    const int lfd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(::bind(lfd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0);
+    REQUIRE(::listen(lfd, 1) == 0);
+    std::thread fake([lfd] {
+        const int fd = ::accept(lfd, nullptr, nullptr);
+        if (fd < 0) return;
+        raw_response(fd);
+        secure_vector resp;
+        agent::FrameWriter(resp).u8(static_cast<std::uint8_t>(agent::Status::Ok)).u32(0xFFFFFFFF).finish();
+        ::send(fd, resp.data(), resp.size(), MSG_NOSIGNAL);
+        ::close(fd);
+    });
+
+    {
+        AgentClient client(sock);
+        CHECK_THROWS_AS(client.search("x", 10), std::invalid_argument);
+    }
+    fake.join();
+    ::close(lfd);
+    std::filesystem::remove(sock);
+}
@@ -0,0 +1,219 @@
+// tests/batch_runner.cpp
+#include <catch2/catch_all.hpp>
+#include "BatchRunner.hpp"
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "Json.hpp"
+
+#include <sqlite3.h>
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    std::vector<json::Object> run_lines(BatchRunner& runner, const std::string& input,
+                                        std::size_t* failed = nullptr) {
+        std::istringstream in(input);
+        std::ostringstream out;
+        const std::size_t f = runner.run(in, out);
+        if (failed) *failed = f;
+
+        std::vector<json::Object> results;
+        std::istringstream lines(out.str());
+        for (std::string line; std::getline(lines, line);) results.push_back(json::parseObject(line));
+        return results;
+    }
+
+    bool ok(const json::Object& r) { return json::getBool(r, "ok").value_or(false); }
+}
+
+TEST_CASE("json: flat objects round-trip", "[json]") {
+    const auto obj = json::parseObject(
+        R"( {"s":"a\"b\\c\n\u00e9\ud83d\ude00", "n":-12, "f":1.5e2, "t":true, "z":null} )");
+    CHECK(*json::getString(obj, "s") == "a\"b\\c\n\xC3\xA9\xF0\x9F\x98\x80");
+    CHECK(*json::getInt(obj, "n") == -12);
+    CHECK(*json::getInt(obj, "f") == 150);
+    CHECK(*json::getBool(obj, "t"));
+    CHECK_FALSE(json::getString(obj, "z").has_value()); // null reads as absent
+    CHECK_FALSE(json::getString(obj, "missing").has_value());
+    CHECK_THROWS_AS(json::getInt(obj, "s"), std::invalid_argument);
+
+    std::string out;
+    json::ObjectWriter w(out);
+    w.str("s", *json::getString(obj, "s")).num("n", -12).boolean("t", true);
+    w.close();
+    const auto back = json::parseObject(out);
+    CHECK(*json::getString(back, "s") == *json::getString(obj, "s"));
+    CHECK(*json::getInt(back, "n") == -12);
+
+    // Same output into locked memory, for results that carry a password
+    secure_string sec;
+    json::SecureObjectWriter sw(sec);
+    sw.str("s", *json::getString(obj, "s")).num("n", -12).boolean("t", true);
+    sw.close();
+    CHECK(std::string_view(sec) == out);
+
+    for (const char* bad : {"", "{", "{\"a\":}", "{\"a\":[1]}", "{\"a\":{}}", "{\"a\":1} x",
+                            "{\"a\":\"\\ud800\"}", "{'a':1}", "{\"a\":1e999}"}) {
+        CHECK_THROWS_AS(json::parseObject(bad), std::invalid_argument);
+    }
+
+    // A repeated key keeps the last value; wipeValues zeroes strings in place
+    auto dup = json::parseObject(R"({"password":"first","password":"second","n":1})");
+    CHECK(*json::getString(dup, "password") == "second");
+    json::wipeValues(dup);
+    CHECK(*json::getString(dup, "password") == std::string(6, '\0'));
+    CHECK(*json::getInt(dup, "n") == 1);
+}
+
+TEST_CASE("BatchRunner: add/get/search/update/delete/generate", "[batch]") {
+    const std::string testDb = "tmp_test_batch.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+        BatchRunner runner(db, enc);
+
+        std::size_t failed = 99;
+        auto r = run_lines(runner,
+            R"({"op":"add","tag":"a1","service":"github","username":"octocat","password":"s3cret","notes":"work"})" "\n"
+            R"({"op":"add","tag":2,"service":"gitlab","username":"cat","password":"other"})" "\n"
+            "\n"
+            R"({"op":"get","id":1})" "\n"
+            R"({"op":"generate","length":24,"symbols":false})" "\n",
+            &failed);
+        REQUIRE(r.size() == 4);
+        CHECK(failed == 0);
+        for (const auto& x : r) CHECK(ok(x));
+        CHECK(*json::getString(r[0], "tag") == "a1");
+        CHECK(*json::getInt(r[1], "tag") == 2);
+        CHECK(*json::getInt(r[0], "id") == 1);
+        CHECK(*json::getString(r[2], "password") == "s3cret");
+        CHECK(*json::getString(r[2], "notes") == "work");
+        CHECK(json::getString(r[3], "password")->size() == 24);
+
+        // Search results are a nested array, which parseObject rejects; check by content
+        std::ostringstream out;
+        std::istringstream in(R"({"op":"search","query":"git","limit":10})");
+        runner.run(in, out);
+        CHECK(out.str().find(R"("service":"github")") != std::string::npos);
+        CHECK(out.str().find(R"("service":"gitlab")") != std::string::npos);
+
+        // Rename keeps the secret readable (username is in the AAD)
+        r = run_lines(runner,
+            R"({"op":"update","id":1,"username":"renamed"})" "\n"
+            R"({"op":"get","id":1})" "\n"
+            R"({"op":"update","id":2,"password":"rotated"})" "\n"
+            R"({"op":"get","id":2})" "\n"
+            R"({"op":"delete","id":2})" "\n"
+            R"({"op":"get","id":2})" "\n");
+        REQUIRE(r.size() == 6);
+        CHECK(ok(r[0]));
+        CHECK(*json::getString(r[1], "username") == "renamed");
+        CHECK(*json::getString(r[1], "password") == "s3cret");
+        CHECK(*json::getString(r[3], "password") == "rotated");
+        CHECK(ok(r[4]));
+        CHECK_FALSE(ok(r[5]));
+        CHECK(*json::getString(r[5], "error") == "no such id");
+        CHECK(db.countCredentials() == 1);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("BatchRunner: bad commands fail alone", "[batch]") {
+    const std::string testDb = "tmp_test_batch_err.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+        BatchRunner runner(db, enc);
+
+        std::size_t failed = 0;
+        auto r = run_lines(runner,
+            "not json\n"
+            R"({"op":"frobnicate","tag":7})" "\n"
+            R"({"op":"add","service":"x"})" "\n"
+            R"({"op":"get","id":"one"})" "\n"
+            R"({"op":"add","service":"ok","password":"p"})" "\n",
+            &failed);
+        REQUIRE(r.size() == 5);
+        CHECK(failed == 4);
+        CHECK(*json::getInt(r[1], "tag") == 7);
+        CHECK(json::getString(r[1], "error")->find("unknown op") != std::string_view::npos);
+        CHECK(*json::getString(r[2], "error") == "missing \"password\"");
+        CHECK(ok(r[4]));
+        CHECK(db.countCredentials() == 1);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("BatchRunner: queued writes share transactions", "[batch]") {
+    const std::string testDb = "tmp_test_batch_txn.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+        BatchRunner runner(db, enc, BatchRunner::Options{100});
+
+        std::string input;
+        for (int i = 0; i < 250; ++i)
+            input += R"({"op":"add","service":"svc)" + std::to_string(i) + R"(","password":"p"})" "\n";
+
+        // All 250 lines are buffered up front: 100 + 100 + 50
+        auto r = run_lines(runner, input);
+        REQUIRE(r.size() == 250);
+        CHECK(runner.transactionsCommitted() == 3);
+        CHECK(db.countCredentials() == 250);
+        CHECK_FALSE(db.inTransaction());
+        for (int i = 0; i < 250; ++i) CHECK(*json::getInt(r[i], "id") == i + 1);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("BatchRunner: a failed commit fails the reads that saw it", "[batch]") {
+    const std::string testDb = "tmp_test_batch_fail.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        // Rollback journal and no busy wait: a reader holding its lock makes COMMIT fail
+        DatabaseOptions opts = DatabaseOptions::durable();
+        opts.journalMode = DatabaseOptions::JournalMode::Delete;
+        opts.busyTimeoutMs = 0;
+        DatabaseManager db(testDb, opts);
+        db.init();
+        EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+        BatchRunner runner(db, enc);
+        REQUIRE(ok(run_lines(runner, R"({"op":"add","service":"kept","password":"p"})" "\n").at(0)));
+
+        sqlite3* reader = nullptr;
+        REQUIRE(sqlite3_open(testDb.c_str(), &reader) == SQLITE_OK);
+        REQUIRE(sqlite3_exec(reader, "BEGIN; SELECT count(*) FROM credentials;",
+                             nullptr, nullptr, nullptr) == SQLITE_OK);
+
+        std::size_t failed = 0;
+        auto r = run_lines(runner,
+            R"({"op":"get","id":1})" "\n"
+            R"({"op":"add","service":"lost","password":"q"})" "\n"
+            R"({"op":"get","id":2})" "\n"
+            R"({"op":"generate","length":8})" "\n",
+            &failed);
+        sqlite3_exec(reader, "COMMIT;", nullptr, nullptr, nullptr);
+        sqlite3_close(reader);
+
+        REQUIRE(r.size() == 4);
+        CHECK(failed == 2);
+        CHECK(ok(r[0]));       // read before any write: committed data
+        CHECK_FALSE(ok(r[1])); // the write was rolled back...
+        CHECK_FALSE(ok(r[2])); // ...so the row this read returned never existed
+        CHECK(json::getString(r[2], "error")->find("commit failed") != std::string_view::npos);
+        CHECK_FALSE(json::getString(r[2], "password").has_value());
+        CHECK(ok(r[3]));
+        CHECK(db.countCredentials() == 1);
+        CHECK_FALSE(db.inTransaction());
+    }
+    std::filesystem::remove(testDb);
+}
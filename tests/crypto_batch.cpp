@@ -0,0 +1,101 @@
+#include <catch2/catch_all.hpp>
+#include "EncryptionManager.hpp"
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    using Bytes = std::span<const std::uint8_t>;
+
+    std::vector<std::uint8_t> bytesOf(const std::string& s) {
+        return { s.begin(), s.end() };
+    }
+}
+
+TEST_CASE("AES-GCM batch: round-trip, per-record failures, interop", "[crypto]") {
+    EncryptionManager enc(std::vector<std::uint8_t>(32, 0x24));
+
+    std::vector<std::vector<std::uint8_t>> pts, aads;
+    for (int i = 0; i < 50; ++i) {
+        pts.push_back(bytesOf("secret-" + std::string(static_cast<std::size_t>(i), 'x')));
+        aads.push_back(bytesOf("svc" + std::to_string(i) + "\nuser\n2024-01-01T00:00:00Z"));
+    }
+    pts.push_back({}); // empty plaintext is legal
+    aads.push_back(bytesOf("empty"));
+
+    std::vector<Bytes> ptSpans(pts.begin(), pts.end());
+    std::vector<Bytes> aadSpans(aads.begin(), aads.end());
+
+    EncryptionManager::SealedBatch sealed;
+    enc.encryptBatch(ptSpans, aadSpans, sealed);
+    REQUIRE(sealed.size() == pts.size());
+
+    std::vector<Bytes> ivs(pts.size()), cts(pts.size());
+    std::set<std::vector<std::uint8_t>> distinctIvs;
+    for (std::size_t i = 0; i < pts.size(); ++i) {
+        ivs[i] = sealed.iv(i);
+        cts[i] = sealed.sealed(i);
+        REQUIRE(cts[i].size() == EncryptionManager::sealedSize(pts[i].size()));
+        distinctIvs.emplace(ivs[i].begin(), ivs[i].end());
+    }
+    REQUIRE(distinctIvs.size() == pts.size());
+
+    SECTION("batch round-trip") {
+        EncryptionManager::OpenedBatch opened;
+        REQUIRE(enc.decryptBatch(ivs, cts, aadSpans, opened) == 0);
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            REQUIRE(opened.ok[i] == 1);
+            auto p = opened.plaintext(i);
+            REQUIRE(std::vector<std::uint8_t>(p.begin(), p.end()) == pts[i]);
+        }
+    }
+
+    SECTION("batch records decrypt with the single-record API") {
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            auto p = enc.decrypt(std::vector<std::uint8_t>(ivs[i].begin(), ivs[i].end()),
+                                 std::vector<std::uint8_t>(cts[i].begin(), cts[i].end()),
+                                 aads[i]);
+            REQUIRE(std::ranges::equal(p, pts[i]));
+        }
+    }
+
+    SECTION("a bad record only fails itself") {
+        std::vector<std::uint8_t> tampered(cts[3].begin(), cts[3].end());
+        tampered.back() ^= 0x01;
+        cts[3] = tampered;
+        const std::vector<std::uint8_t> shortIv(8, 0);
+        ivs[7] = shortIv;
+
+        EncryptionManager::OpenedBatch opened;
+        REQUIRE(enc.decryptBatch(ivs, cts, aadSpans, opened) == 2);
+        REQUIRE(opened.ok[3] == 0);
+        REQUIRE(opened.ok[7] == 0);
+        REQUIRE(opened.plaintext(3).empty());
+        auto p = opened.plaintext(4);
+        REQUIRE(std::vector<std::uint8_t>(p.begin(), p.end()) == pts[4]);
+    }
+
+    SECTION("mismatched counts throw") {
+        EncryptionManager::OpenedBatch opened;
+        REQUIRE_THROWS_AS(enc.decryptBatch(std::span<const Bytes>(ivs).first(1), cts, aadSpans, opened),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(enc.encryptBatch(ptSpans, std::span<const Bytes>(aadSpans).first(2), sealed),
+                          std::invalid_argument);
+    }
+
+    SECTION("no AAD and empty batches") {
+        EncryptionManager::SealedBatch noAad;
+        enc.encryptBatch(ptSpans, {}, noAad);
+        std::vector<Bytes> ivs2(pts.size()), cts2(pts.size());
+        for (std::size_t i = 0; i < pts.size(); ++i) { ivs2[i] = noAad.iv(i); cts2[i] = noAad.sealed(i); }
+        EncryptionManager::OpenedBatch opened;
+        REQUIRE(enc.decryptBatch(ivs2, cts2, {}, opened) == 0);
+        // Wrong AAD -> every record fails
+        REQUIRE(enc.decryptBatch(ivs2, cts2, aadSpans, opened) == pts.size());
+
+        EncryptionManager::SealedBatch none;
+        enc.encryptBatch({}, {}, none);
+        REQUIRE(none.size() == 0);
+    }
+}
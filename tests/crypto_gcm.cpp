@@ -1,6 +1,10 @@
 #include <catch2/catch_all.hpp>
 #include "EncryptionManager.hpp"
+#include <algorithm>
 #include <cstring>
+#include <atomic>
+#include <string>
+#include <thread>
 
 static std::vector<std::uint8_t> toBytes(const char* s) {
     return std::vector<std::uint8_t>(reinterpret_cast<const std::uint8_t*>(s),
@@ -26,7 +30,7 @@ TEST_CASE("AES-GCM: round-trip succeeds; tamper fails", "[crypto]") {
 
     // Good decrypt
     auto dec = enc.decrypt(encRes.iv, encRes.encAndTag, aad);
-    REQUIRE(dec == pt);
+    REQUIRE(std::ranges::equal(dec, pt));
 
     // Tamper one byte -> tag verify must fail
     auto bad = encRes.encAndTag;
@@ -38,3 +42,38 @@ TEST_CASE("AES-GCM: round-trip succeeds; tamper fails", "[crypto]") {
         );
     }
 }
+
+TEST_CASE("AES-GCM: pooled contexts survive failures and concurrent use", "[crypto]") {
+    EncryptionManager enc(std::vector<std::uint8_t>(32, 0x33));
+    auto aad = toBytes("service\nuser\n2025-01-01T00:00:00Z");
+
+    auto a = enc.encrypt(toBytes("first"), aad);
+    auto b = enc.encrypt(toBytes("second"), aad);
+    REQUIRE(a.iv != b.iv);
+
+    // A failed tag check must not poison the reused context
+    auto bad = a.encAndTag;
+    bad.back() ^= 0x80;
+    REQUIRE_THROWS_WITH(enc.decrypt(a.iv, bad, aad), "GCM tag verification failed");
+    REQUIRE(std::ranges::equal(enc.decrypt(a.iv, a.encAndTag, aad), toBytes("first")));
+    REQUIRE(std::ranges::equal(enc.decrypt(b.iv, b.encAndTag, aad), toBytes("second")));
+
+    // Many threads sharing one manager
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 200; ++i) {
+                auto pt = toBytes(("t" + std::to_string(t) + "-" + std::to_string(i)).c_str());
+                auto r = enc.encrypt(pt, aad);
+                if (!std::ranges::equal(enc.decrypt(r.iv, r.encAndTag, aad), pt)) ++failures;
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    REQUIRE(failures == 0);
+
+    // Moving keeps the pool usable
+    EncryptionManager moved(std::move(enc));
+    REQUIRE(std::ranges::equal(moved.decrypt(a.iv, a.encAndTag, aad), toBytes("first")));
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch_all.hpp>
+#include "EncryptionManager.hpp"
+#include <array>
+#include <stdexcept>
+#include <string_view>
+
+TEST_CASE("AES-GCM span API: caller-owned buffers", "[crypto]") {
+    EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+
+    const std::string_view pw  = "hunter2-but-longer";
+    const std::string_view aad = "svc\nuser\n2024-01-01T00:00:00Z";
+
+    std::array<std::uint8_t, EncryptionManager::kIvLen> iv{};
+    std::array<std::uint8_t, 64> sealed{};
+    std::size_t n = enc.encrypt(asBytes(pw), asBytes(aad), iv, sealed);
+    REQUIRE(n == EncryptionManager::sealedSize(pw.size()));
+
+    SECTION("span round-trip") {
+        std::array<std::uint8_t, 64> out{};
+        std::size_t m = enc.decrypt(iv, std::span(sealed.data(), n), asBytes(aad), out);
+        REQUIRE(std::string_view(reinterpret_cast<const char*>(out.data()), m) == pw);
+    }
+
+    SECTION("interops with the vector API") {
+        std::vector<std::uint8_t> ivV(iv.begin(), iv.end());
+        std::vector<std::uint8_t> sealedV(sealed.begin(), sealed.begin() + n);
+        std::vector<std::uint8_t> aadV(aad.begin(), aad.end());
+        auto pt = enc.decrypt(ivV, sealedV, aadV);
+        REQUIRE(std::string_view(reinterpret_cast<const char*>(pt.data()), pt.size()) == pw);
+
+        std::vector<std::uint8_t> ptV(pw.begin(), pw.end());
+        auto res = enc.encrypt(ptV, aadV);
+        std::array<std::uint8_t, 64> out{};
+        std::size_t m = enc.decrypt(res.iv, res.encAndTag, asBytes(aad), out);
+        REQUIRE(m == pw.size());
+    }
+
+    SECTION("undersized buffers are rejected") {
+        std::array<std::uint8_t, 8> shortIv{};
+        REQUIRE_THROWS_AS(enc.encrypt(asBytes(pw), asBytes(aad), shortIv, sealed),
+                          std::invalid_argument);
+
+        std::array<std::uint8_t, 8> shortSealed{};
+        REQUIRE_THROWS_AS(enc.encrypt(asBytes(pw), asBytes(aad), iv, shortSealed),
+                          std::invalid_argument);
+
+        std::array<std::uint8_t, 4> shortOut{};
+        REQUIRE_THROWS_AS(enc.decrypt(iv, std::span(sealed.data(), n), asBytes(aad), shortOut),
+                          std::invalid_argument);
+    }
+
+    SECTION("tag failure wipes the output buffer") {
+        sealed[0] ^= 0x01;
+        std::array<std::uint8_t, 64> out{};
+        out.fill(0xAA);
+        REQUIRE_THROWS_WITH(enc.decrypt(iv, std::span(sealed.data(), n), asBytes(aad), out),
+                            "GCM tag verification failed");
+        for (std::size_t i = 0; i < pw.size(); ++i) REQUIRE(out[i] == 0);
+    }
+}
@@ -0,0 +1,62 @@
+// tests/db_bulk_insert.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+#include <string>
+
+static std::vector<NewCredential> makeRows(int n) {
+    std::vector<NewCredential> rows;
+    for (int i = 0; i < n; ++i) {
+        NewCredential nc;
+        nc.service      = "svc-" + std::to_string(i);
+        nc.username     = "user" + std::to_string(i);
+        nc.enc_password = std::vector<std::uint8_t>(24, static_cast<std::uint8_t>(i));
+        nc.iv           = std::vector<std::uint8_t>(12, 0x01);
+        nc.notes        = "note";
+        nc.created_at   = (i % 2) ? "2024-06-01T12:00:00Z" : "";
+        rows.push_back(std::move(nc));
+    }
+    return rows;
+}
+
+TEST_CASE("DB: addCredentials inserts in batches and returns ids in order", "[db][bulk]") {
+    const std::string testDb = "tmp_test_bulk.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+
+        auto rows = makeRows(25);
+
+        SECTION("Chunked commits") {
+            auto ids = db.addCredentials(rows, 7); // 4 chunks
+            REQUIRE(ids.size() == rows.size());
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                auto c = db.getCredentialById(ids[i]);
+                REQUIRE(c.has_value());
+                REQUIRE(c->service == rows[i].service);
+                REQUIRE(c->enc_password == rows[i].enc_password);
+                if (!rows[i].created_at.empty()) REQUIRE(c->created_at == rows[i].created_at);
+                else REQUIRE_FALSE(c->created_at.empty());
+            }
+            REQUIRE(db.getAllCredentials().size() == rows.size());
+        }
+
+        SECTION("Joins an open transaction") {
+            db.beginTransaction();
+            auto ids = db.addCredentials(rows, 7);
+            REQUIRE(ids.size() == rows.size());
+            db.rollback();
+            REQUIRE(db.getAllCredentials().empty());
+        }
+
+        SECTION("Empty input and bad batch size") {
+            REQUIRE(db.addCredentials({}).empty());
+            REQUIRE_THROWS_AS(db.addCredentials(rows, 0), std::invalid_argument);
+        }
+    }
+    std::filesystem::remove(testDb);
+}
@@ -0,0 +1,84 @@
+// tests/db_cursor.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+#include <string>
+
+TEST_CASE("DB: forEachCredential streams views and pages by id", "[db][cursor]") {
+    const std::string testDb = "tmp_test_cursor.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+
+        std::vector<int> ids;
+        for (int i = 0; i < 10; ++i) {
+            std::vector<std::uint8_t> enc(16 + i, static_cast<std::uint8_t>(i));
+            std::vector<std::uint8_t> iv(12, 0x07);
+            const std::string service = (i < 4 ? "mail-" : "bank-") + std::to_string(i);
+            ids.push_back(db.addCredential(service, "user" + std::to_string(i), enc, iv,
+                                           "note" + std::to_string(i)));
+        }
+
+        SECTION("Full scan in id order with zero-copy views") {
+            std::vector<int> seen;
+            std::size_t n = db.forEachCredential([&](const CredentialView& v) {
+                const int i = static_cast<int>(seen.size());
+                REQUIRE(v.username == "user" + std::to_string(i));
+                REQUIRE(v.notes == "note" + std::to_string(i));
+                REQUIRE(v.enc_password.size() == static_cast<std::size_t>(16 + i));
+                REQUIRE(v.enc_password[0] == static_cast<std::uint8_t>(i));
+                REQUIRE(v.iv.size() == 12);
+                REQUIRE_FALSE(v.created_at.empty());
+                seen.push_back(v.id);
+            });
+            REQUIRE(n == ids.size());
+            REQUIRE(seen == ids);
+        }
+
+        SECTION("Keyset paging with afterId + limit") {
+            std::vector<int> seen;
+            int after = 0;
+            for (;;) {
+                std::size_t n = db.forEachCredential([&](const CredentialView& v) {
+                    seen.push_back(v.id);
+                    after = v.id;
+                }, after, 3);
+                if (n == 0) break;
+                REQUIRE(n <= 3);
+            }
+            REQUIRE(seen == ids);
+        }
+
+        SECTION("Service filter matches searchByService") {
+            std::vector<int> seen;
+            db.forEachByService("mail", [&](const CredentialView& v) { seen.push_back(v.id); });
+            auto rows = db.searchByService("mail");
+            REQUIRE(seen.size() == 4);
+            REQUIRE(rows.size() == seen.size());
+            for (std::size_t i = 0; i < rows.size(); ++i) REQUIRE(rows[i].id == seen[i]);
+        }
+
+        SECTION("A throwing visitor leaves the connection usable") {
+            // Abandon the scan after the first row, mid-iteration
+            std::size_t visited = 0;
+            REQUIRE_THROWS(db.forEachCredential([&](const CredentialView&) {
+                ++visited;
+                throw std::runtime_error("stop");
+            }));
+            REQUIRE(visited == 1);
+            REQUIRE_NOTHROW(db.beginTransaction());
+            db.deleteCredential(ids.front());
+            REQUIRE_NOTHROW(db.commit());
+
+            // The next scan starts over instead of resuming
+            std::vector<int> seen;
+            db.forEachCredential([&](const CredentialView& v) { seen.push_back(v.id); });
+            REQUIRE(seen == std::vector<int>(ids.begin() + 1, ids.end()));
+        }
+    }
+    std::filesystem::remove(testDb);
+}
@@ -34,3 +34,32 @@ TEST_CASE("DB: store/load kdf_salt", "[db][kdf]") {
     REQUIRE(after2.has_value());
     REQUIRE(*after2 == salt2);
 }
+
+TEST_CASE("DB: store/load KDF params next to kdf_salt", "[db][kdf]") {
+    const std::string testDb = "tmp_test_kdf_params.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        REQUIRE_NOTHROW(db.init());
+
+        // No settings row yet: nothing to load, nothing to update
+        REQUIRE_FALSE(db.loadKdfParams().has_value());
+        REQUIRE_THROWS_AS(db.storeKdfParams(KdfParams{}), std::logic_error);
+
+        // A salt-only row (older vaults) reads back as the historic defaults
+        db.storeKdfSalt(std::vector<std::uint8_t>(16, 0x5A));
+        REQUIRE(db.loadKdfParams() == KdfParams{});
+
+        KdfParams tuned{ 2, 128 * 1024, 4 };
+        REQUIRE_NOTHROW(db.storeKdfParams(tuned));
+        REQUIRE(db.loadKdfParams() == tuned);
+
+        // Re-storing the salt keeps the params
+        db.storeKdfSalt(std::vector<std::uint8_t>(16, 0xA5));
+        REQUIRE(db.loadKdfParams() == tuned);
+
+        REQUIRE_THROWS_AS(db.storeKdfParams(KdfParams{ 0, 1024, 1 }), std::invalid_argument);
+        REQUIRE_THROWS_AS(db.storeKdfParams(KdfParams{ 1, 16, 4 }), std::invalid_argument);
+    }
+    std::filesystem::remove(testDb);
+}
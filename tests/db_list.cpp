@@ -0,0 +1,125 @@
+// tests/db_list.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+
+#include <sqlite3.h>
+
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+#include <string>
+
+namespace {
+    const std::vector<std::uint8_t> kEnc(20, 0x01);
+    const std::vector<std::uint8_t> kIv(12, 0x02);
+
+    // EXPLAIN QUERY PLAN details, one per line
+    std::string queryPlan(const std::string& path, const std::string& sql) {
+        sqlite3* db = nullptr;
+        REQUIRE(sqlite3_open(path.c_str(), &db) == SQLITE_OK);
+        sqlite3_stmt* stmt = nullptr;
+        REQUIRE(sqlite3_prepare_v2(db, ("EXPLAIN QUERY PLAN " + sql).c_str(), -1, &stmt, nullptr) == SQLITE_OK);
+        std::string plan;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            plan += reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+            plan += "\n";
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+        return plan;
+    }
+}
+
+TEST_CASE("DB: listCredentials pages newest first by keyset", "[db][list]") {
+    const std::string testDb = "tmp_test_list.sqlite";
+    std::filesystem::remove(testDb);
+
+    DatabaseManager db(testDb);
+    db.init();
+
+    // 25 rows over 5 timestamps, so pages split inside runs of equal created_at
+    std::vector<NewCredential> rows(25);
+    for (int i = 0; i < 25; ++i) {
+        rows[i] = { "svc" + std::to_string(i), "user" + std::to_string(i), kEnc, kIv,
+                    "note" + std::to_string(i), "2025-01-0" + std::to_string(1 + i % 5) + "T00:00:00Z" };
+    }
+    const std::vector<int> ids = db.addCredentials(rows);
+
+    SECTION("pages cover every row once in (created_at, id) DESC order") {
+        std::vector<CredentialMeta> seen;
+        std::optional<ListCursor> cursor;
+        int pages = 0;
+        do {
+            CredentialPage page = db.listCredentials(cursor, 7);
+            REQUIRE(page.rows.size() <= 7);
+            seen.insert(seen.end(), page.rows.begin(), page.rows.end());
+            cursor = page.next;
+            ++pages;
+        } while (cursor);
+
+        CHECK(pages == 4);
+        REQUIRE(seen.size() == rows.size());
+        for (std::size_t i = 1; i < seen.size(); ++i) {
+            const auto& a = seen[i - 1];
+            const auto& b = seen[i];
+            CHECK((a.created_at > b.created_at || (a.created_at == b.created_at && a.id > b.id)));
+        }
+        CHECK(seen.front().created_at == "2025-01-05T00:00:00Z");
+        CHECK(seen.back().id == ids[0]);
+    }
+
+    SECTION("columns mask picks what is filled") {
+        auto brief = db.listCredentials(std::nullopt, 1);
+        REQUIRE(brief.rows.size() == 1);
+        CHECK_FALSE(brief.rows[0].service.empty());
+        CHECK_FALSE(brief.rows[0].username.empty());
+        CHECK(brief.rows[0].notes.empty());
+
+        auto notes = db.listCredentials(std::nullopt, 1, kListNotes);
+        CHECK(notes.rows[0].id == brief.rows[0].id);
+        CHECK(notes.rows[0].service.empty());
+        CHECK(notes.rows[0].notes == "note" + std::to_string(notes.rows[0].id - ids[0]));
+        CHECK_FALSE(notes.rows[0].created_at.empty());
+    }
+
+    SECTION("rows added while paging don't shift later pages") {
+        CredentialPage first = db.listCredentials(std::nullopt, 10);
+        REQUIRE(first.next);
+        db.addCredential("brand-new", "x", kEnc, kIv, ""); // newest, sorts before page 1
+        CredentialPage second = db.listCredentials(first.next, 10);
+        REQUIRE_FALSE(second.rows.empty());
+        CHECK((second.rows[0].created_at < first.rows.back().created_at ||
+               (second.rows[0].created_at == first.rows.back().created_at &&
+                second.rows[0].id < first.rows.back().id)));
+    }
+
+    SECTION("exact multiple of the page size ends with an empty page") {
+        CredentialPage all = db.listCredentials(std::nullopt, 25);
+        CHECK(all.rows.size() == 25);
+        REQUIRE(all.next);
+        CredentialPage tail = db.listCredentials(all.next, 25);
+        CHECK(tail.rows.empty());
+        CHECK_FALSE(tail.next);
+    }
+
+    SECTION("brief listing seeks the covering index, without sorting") {
+        // Same shape as the cursor query in listCredentials()
+        const std::string plan = queryPlan(testDb,
+            "SELECT id, created_at, service, username FROM credentials "
+            "WHERE created_at = '2025-01-03' AND id < 5 "
+            "UNION ALL "
+            "SELECT id, created_at, service, username FROM credentials "
+            "WHERE created_at < '2025-01-03' "
+            "ORDER BY created_at DESC, id DESC LIMIT 10");
+        INFO(plan);
+        CHECK(plan.find("COVERING INDEX idx_credentials_created (created_at=? AND id<?)") != std::string::npos);
+        CHECK(plan.find("COVERING INDEX idx_credentials_created (created_at<?)") != std::string::npos);
+        CHECK(plan.find("TEMP B-TREE") == std::string::npos);
+    }
+
+    CHECK_THROWS_AS(db.listCredentials(std::nullopt, 0), std::invalid_argument);
+
+    std::filesystem::remove(testDb);
+    std::filesystem::remove(testDb + "-wal");
+    std::filesystem::remove(testDb + "-shm");
+}
@@ -0,0 +1,82 @@
+// tests/db_options.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+
+#include <sqlite3.h>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Journal mode is persisted in the file, so a second raw connection can see
+// it. nullopt if the file can't be read.
+static std::optional<std::string> journal_mode_of(const std::string& path) {
+    sqlite3* raw = nullptr;
+    std::optional<std::string> mode;
+    if (sqlite3_open_v2(path.c_str(), &raw, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK) {
+        sqlite3_stmt* st = nullptr;
+        if (sqlite3_prepare_v2(raw, "PRAGMA journal_mode;", -1, &st, nullptr) == SQLITE_OK &&
+            sqlite3_step(st) == SQLITE_ROW) {
+            mode = reinterpret_cast<const char*>(sqlite3_column_text(st, 0));
+        }
+        sqlite3_finalize(st);
+    }
+    sqlite3_close(raw);
+    return mode;
+}
+
+// Every per-connection pragma the options map to, read back from `db`.
+// The enums are declared in SQLite's numeric order.
+static void check_pragmas(const DatabaseManager& db, const DatabaseOptions& o) {
+    CHECK(db.test_pragma("synchronous") == std::to_string(static_cast<int>(o.synchronous)));
+    CHECK(db.test_pragma("cache_size") == std::to_string(-o.cacheSizeKiB));
+    CHECK(db.test_pragma("mmap_size") == std::to_string(o.mmapSizeBytes));
+    CHECK(db.test_pragma("temp_store") == std::to_string(static_cast<int>(o.tempStore)));
+    CHECK(db.test_pragma("busy_timeout") == std::to_string(o.busyTimeoutMs));
+}
+
+TEST_CASE("DB: connection presets apply their pragmas", "[db][options]") {
+    const std::string testDb = "tmp_test_options.sqlite";
+    std::vector<std::uint8_t> enc(20, 0x42), iv(12, 0x24);
+
+    SECTION("durable preset uses WAL and synchronous=FULL") {
+        std::filesystem::remove(testDb);
+        const DatabaseOptions opts = DatabaseOptions::durable();
+        DatabaseManager db(testDb, opts);
+        db.init();
+        REQUIRE(db.addCredential("svc", "user", enc, iv, "") > 0);
+        CHECK(journal_mode_of(testDb) == "wal");
+        CHECK(db.test_pragma("synchronous") == "2");
+        CHECK(db.test_pragma("temp_store") == "0");
+        check_pragmas(db, opts);
+    }
+
+    SECTION("fast preset trades durability for cache, mmap and RAM temp tables") {
+        std::filesystem::remove(testDb);
+        const DatabaseOptions opts = DatabaseOptions::fast();
+        DatabaseManager db(testDb, opts);
+        db.init();
+        int id = db.addCredential("svc", "user", enc, iv, "");
+        REQUIRE(db.getCredentialById(id).has_value());
+        CHECK(journal_mode_of(testDb) == "wal");
+        CHECK(db.test_pragma("synchronous") == "1");              // NORMAL
+        CHECK(db.test_pragma("cache_size") == "-65536");          // 64 MiB
+        CHECK(db.test_pragma("mmap_size") == "268435456");        // 256 MiB
+        CHECK(db.test_pragma("temp_store") == "2");               // MEMORY
+        check_pragmas(db, opts);
+    }
+
+    SECTION("rollback journal can still be selected") {
+        std::filesystem::remove(testDb);
+        DatabaseOptions opts = DatabaseOptions::durable();
+        opts.journalMode = DatabaseOptions::JournalMode::Delete;
+        opts.synchronous = DatabaseOptions::Synchronous::Extra;
+        DatabaseManager db(testDb, opts);
+        db.init();
+        CHECK(journal_mode_of(testDb) == "delete");
+        CHECK(db.test_pragma("journal_mode") == "delete");
+        check_pragmas(db, opts);
+    }
+    std::filesystem::remove(testDb);
+}
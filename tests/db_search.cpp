@@ -0,0 +1,363 @@
+// tests/db_search.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+#include <string>
+
+namespace {
+    const std::vector<std::uint8_t> kEnc(20, 0x01);
+    const std::vector<std::uint8_t> kIv(12, 0x02);
+
+    std::vector<int> idsOf(const std::vector<CredentialMeta>& hits) {
+        std::vector<int> ids;
+        for (const auto& h : hits) ids.push_back(h.id);
+        return ids;
+    }
+
+    bool contains(const std::vector<int>& ids, int id) {
+        return std::find(ids.begin(), ids.end(), id) != ids.end();
+    }
+}
+
+TEST_CASE("DB: searchCredentials matches service, username and notes ranked", "[db][search]") {
+    const std::string testDb = "tmp_test_search.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        INFO("FTS5 trigram index: " << db.hasFullTextIndex());
+
+        const int gh    = db.addCredential("GitHub", "octocat", kEnc, kIv, "work account");
+        const int hub   = db.addCredential("mail", "hubert", kEnc, kIv, "");
+        const int note  = db.addCredential("bank", "alice", kEnc, kIv, "pin is on the github wiki");
+        const int other = db.addCredential("shop", "bob", kEnc, kIv, "nothing here");
+
+        SECTION("service hits rank above username and notes hits") {
+            auto ids = idsOf(db.searchCredentials("hub"));
+            REQUIRE(ids.size() == 3);
+            REQUIRE(ids.front() == gh);
+            REQUIRE(contains(ids, hub));
+            REQUIRE(contains(ids, note));
+            REQUIRE_FALSE(contains(ids, other));
+        }
+
+        SECTION("case-insensitive, metadata returned") {
+            auto hits = db.searchCredentials("GITHUB");
+            REQUIRE(hits.size() == 2);
+            REQUIRE(hits[0].id == gh);
+            REQUIRE(hits[0].service == "GitHub");
+            REQUIRE(hits[0].username == "octocat");
+            REQUIRE(hits[0].notes == "work account");
+            REQUIRE_FALSE(hits[0].created_at.empty());
+            REQUIRE(hits[1].id == note);
+        }
+
+        SECTION("field mask and limit") {
+            REQUIRE(idsOf(db.searchCredentials("hub", kSearchUsername)) == std::vector<int>{ hub });
+            REQUIRE(idsOf(db.searchCredentials("github", kSearchNotes)) == std::vector<int>{ note });
+            REQUIRE(db.searchCredentials("hub", kSearchAll, 1).size() == 1);
+            REQUIRE(db.searchCredentials("hub", kSearchAll, -1).size() == 3);
+            REQUIRE_THROWS_AS(db.searchCredentials("hub", 0), std::invalid_argument);
+        }
+
+        SECTION("short queries fall back to a scan with the same ranking") {
+            auto ids = idsOf(db.searchCredentials("bo"));
+            REQUIRE(ids == std::vector<int>{ other });
+            auto ba = idsOf(db.searchCredentials("ba"));
+            REQUIRE(ba == std::vector<int>{ note });
+            // "ub": service GitHub first, then username hubert
+            auto ub = idsOf(db.searchCredentials("ub"));
+            REQUIRE(ub.size() == 3);
+            REQUIRE(ub.front() == gh);
+            REQUIRE(ub[1] == hub);
+        }
+
+        SECTION("special characters are literal") {
+            const int q = db.addCredential("quote\"d", "x%y_z", kEnc, kIv, "");
+            REQUIRE(idsOf(db.searchCredentials("te\"d")) == std::vector<int>{ q });
+            REQUIRE(idsOf(db.searchCredentials("%y_")) == std::vector<int>{ q });
+            REQUIRE(db.searchCredentials("AND OR NOT").empty());
+        }
+
+        SECTION("index follows update and delete; secret rewrites don't matter") {
+            db.updateCredential(hub, "someone", kEnc, kIv, "");
+            REQUIRE_FALSE(contains(idsOf(db.searchCredentials("hubert")), hub));
+            REQUIRE(contains(idsOf(db.searchCredentials("someone")), hub));
+
+            SecretUpdate u{ gh, std::vector<std::uint8_t>(24, 0x09), kIv };
+            db.updateSecrets(std::span<const SecretUpdate>(&u, 1));
+            REQUIRE(idsOf(db.searchCredentials("octocat")) == std::vector<int>{ gh });
+
+            db.deleteCredential(gh);
+            REQUIRE(db.searchCredentials("octocat").empty());
+        }
+
+        SECTION("service searches agree with the LIKE semantics") {
+            REQUIRE(db.searchByService("github").size() == 1);
+            REQUIRE(db.searchByService("Hub").size() == 1);
+            REQUIRE(db.searchByService("ai").size() == 1); // short: LIKE path
+            std::size_t n = db.forEachByService("githu", [](const CredentialView&) {});
+            REQUIRE(n == 1);
+        }
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("DB: trigram index is built for rows that predate it", "[db][search]") {
+    const std::string testDb = "tmp_test_search_upgrade.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        // A vault from before the index existed
+        {
+            sqlite3* raw = nullptr;
+            REQUIRE(sqlite3_open(testDb.c_str(), &raw) == SQLITE_OK);
+            REQUIRE(sqlite3_exec(raw, R"SQL(
+                CREATE TABLE credentials (
+                  id INTEGER PRIMARY KEY AUTOINCREMENT, service TEXT NOT NULL,
+                  username TEXT NOT NULL, encrypted_password BLOB NOT NULL,
+                  iv BLOB NOT NULL, notes TEXT DEFAULT '', created_at TEXT NOT NULL);
+                INSERT INTO credentials(service, username, encrypted_password, iv, notes, created_at)
+                VALUES ('legacy-service', 'old-user', x'00', x'00', 'old note', '2020-01-01T00:00:00Z');
+            )SQL", nullptr, nullptr, nullptr) == SQLITE_OK);
+            sqlite3_close(raw);
+        }
+
+        DatabaseManager db(testDb);
+        db.init();
+        REQUIRE(db.searchCredentials("legacy").size() == 1);
+        REQUIRE(db.searchCredentials("old note").size() == 1);
+
+        // A second init() must not duplicate postings
+        db.init();
+        REQUIRE(db.searchCredentials("legacy").size() == 1);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("DB: rows added without the index are picked up on init", "[db][search]") {
+    const std::string testDb = "tmp_test_search_catchup.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        {
+            DatabaseManager db(testDb);
+            db.init();
+            db.addCredential("indexed", "u", kEnc, kIv, "");
+        }
+        // An older build appends a row (no insert indexing)
+        {
+            sqlite3* raw = nullptr;
+            REQUIRE(sqlite3_open(testDb.c_str(), &raw) == SQLITE_OK);
+            REQUIRE(sqlite3_exec(raw,
+                "INSERT INTO credentials(service, username, encrypted_password, iv, notes, created_at)"
+                " VALUES ('appended', 'u', x'00', x'00', '', '2020-01-01T00:00:00Z');",
+                nullptr, nullptr, nullptr) == SQLITE_OK);
+            sqlite3_close(raw);
+        }
+        DatabaseManager db(testDb);
+        db.init();
+        REQUIRE(db.searchCredentials("appended").size() == 1);
+        REQUIRE(db.searchCredentials("indexed").size() == 1);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("DB: updating or deleting a row the index never saw keeps it consistent", "[db][search]") {
+    const std::string testDb = "tmp_test_search_unindexed.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        REQUIRE(db.hasFullTextIndex());
+        const int kept = db.addCredential("indexed", "u", kEnc, kIv, "");
+
+        // Another writer inserts two rows behind this connection's back
+        sqlite3* raw = nullptr;
+        REQUIRE(sqlite3_open(testDb.c_str(), &raw) == SQLITE_OK);
+        REQUIRE(sqlite3_exec(raw,
+            "INSERT INTO credentials(service, username, encrypted_password, iv, notes, created_at)"
+            " VALUES ('stray-one', 'u', x'00', x'00', '', '2020-01-01T00:00:00Z'),"
+            "        ('stray-two', 'u', x'00', x'00', '', '2020-01-01T00:00:00Z');",
+            nullptr, nullptr, nullptr) == SQLITE_OK);
+        const int updated = kept + 1, deleted = kept + 2;
+
+        db.updateCredential(updated, "renamed-user", kEnc, kIv, "fresh note");
+        db.deleteCredential(deleted);
+
+        // The updated row is left to the next catch-up, not indexed out of order
+        CHECK(db.searchCredentials("renamed").empty());
+        CHECK(db.searchCredentials("indexed").size() == 1);
+
+        DatabaseManager reopened(testDb);
+        reopened.init();
+
+        // rank 1: also compare the index against the content table
+        CHECK(sqlite3_exec(raw, "INSERT INTO credentials_fts(credentials_fts, rank) VALUES('integrity-check', 1);",
+                           nullptr, nullptr, nullptr) == SQLITE_OK);
+        sqlite3_close(raw);
+
+        CHECK(reopened.searchCredentials("renamed").size() == 1);
+        CHECK(reopened.searchCredentials("stray").size() == 1);
+        CHECK(reopened.searchCredentials("indexed").size() == 1);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("DB: updating an unindexed row doesn't hide older unindexed rows from init", "[db][search]") {
+    const std::string testDb = "tmp_test_search_unindexed_gap.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        {
+            DatabaseManager db(testDb);
+            db.init();
+            db.addCredential("indexed", "u", kEnc, kIv, "");
+
+            // An older build appends three rows, then this build updates the last
+            sqlite3* raw = nullptr;
+            REQUIRE(sqlite3_open(testDb.c_str(), &raw) == SQLITE_OK);
+            REQUIRE(sqlite3_exec(raw,
+                "INSERT INTO credentials(service, username, encrypted_password, iv, notes, created_at)"
+                " VALUES ('gap-one', 'u', x'00', x'00', '', '2020-01-01T00:00:00Z'),"
+                "        ('gap-two', 'u', x'00', x'00', '', '2020-01-01T00:00:00Z'),"
+                "        ('gap-three', 'u', x'00', x'00', '', '2020-01-01T00:00:00Z');",
+                nullptr, nullptr, nullptr) == SQLITE_OK);
+            const int last = static_cast<int>(sqlite3_last_insert_rowid(raw));
+            sqlite3_close(raw);
+            db.updateCredential(last, "touched", kEnc, kIv, "");
+        }
+        DatabaseManager db(testDb);
+        db.init();
+        CHECK(db.searchCredentials("gap").size() == 3);
+        CHECK(db.searchCredentials("touched").size() == 1);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("DB: deferred indexing catches up on resume", "[db][search]") {
+    const std::string testDb = "tmp_test_search_deferred.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        REQUIRE(db.hasFullTextIndex());
+        db.addCredential("indexed", "u", kEnc, kIv, "");
+
+        db.deferFullTextIndex();
+        const int single = db.addCredential("deferred-one", "u", kEnc, kIv, "");
+        NewCredential nc;
+        nc.service = "deferred-bulk";
+        nc.username = "u";
+        nc.iv = kIv;
+        nc.enc_password = kEnc;
+        nc.created_at = "2025-01-02T03:04:05Z";
+        const std::vector<NewCredential> bulk(3, nc);
+        const auto ids = db.addCredentials(bulk);
+        CHECK(db.searchCredentials("deferred").empty());
+
+        // Touching deferred rows before the catch-up must not corrupt the index
+        db.updateCredential(single, "renamed-user", kEnc, kIv, "");
+        db.deleteCredential(ids.back());
+
+        db.resumeFullTextIndex();
+        CHECK(db.searchCredentials("deferred").size() == 3);
+        CHECK(idsOf(db.searchCredentials("renamed")) == std::vector<int>{ single });
+        CHECK(db.searchCredentials("indexed").size() == 1);
+
+        // Back to indexing each insert
+        db.addCredential("after", "u", kEnc, kIv, "");
+        CHECK(db.searchCredentials("after").size() == 1);
+
+        sqlite3* raw = nullptr;
+        REQUIRE(sqlite3_open(testDb.c_str(), &raw) == SQLITE_OK);
+        // Resuming clears the mark, so later opens skip the gap scan
+        sqlite3_stmt* marks = nullptr;
+        REQUIRE(sqlite3_prepare_v2(raw, "SELECT count(*) FROM credentials_fts_deferred;", -1,
+                                   &marks, nullptr) == SQLITE_OK);
+        CHECK(sqlite3_step(marks) == SQLITE_ROW);
+        CHECK(sqlite3_column_int(marks, 0) == 0);
+        sqlite3_finalize(marks);
+        CHECK(sqlite3_exec(raw, "INSERT INTO credentials_fts(credentials_fts, rank) VALUES('integrity-check', 1);",
+                           nullptr, nullptr, nullptr) == SQLITE_OK);
+        sqlite3_close(raw);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("DB: updating the newest deferred row doesn't hide the others", "[db][search]") {
+    const std::string testDb = "tmp_test_search_deferred_update.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        REQUIRE(db.hasFullTextIndex());
+
+        db.deferFullTextIndex();
+        const int first  = db.addCredential("alphaservice", "u", kEnc, kIv, "");
+        const int second = db.addCredential("betaservice", "u", kEnc, kIv, "");
+        const int third  = db.addCredential("gammaservice", "u", kEnc, kIv, "");
+        db.updateCredential(third, "renamed-user", kEnc, kIv, "");
+
+        // Meanwhile another connection indexes a row of its own
+        {
+            DatabaseManager other(testDb);
+            other.init();
+            other.addCredential("deltaservice", "u", kEnc, kIv, "");
+        }
+
+        db.resumeFullTextIndex();
+        CHECK(idsOf(db.searchCredentials("alphaservice")) == std::vector<int>{ first });
+        CHECK(idsOf(db.searchCredentials("betaservice")) == std::vector<int>{ second });
+        CHECK(idsOf(db.searchCredentials("renamed")) == std::vector<int>{ third });
+        CHECK(db.searchCredentials("deltaservice").size() == 1);
+
+        sqlite3* raw = nullptr;
+        REQUIRE(sqlite3_open(testDb.c_str(), &raw) == SQLITE_OK);
+        CHECK(sqlite3_exec(raw, "INSERT INTO credentials_fts(credentials_fts, rank) VALUES('integrity-check', 1);",
+                           nullptr, nullptr, nullptr) == SQLITE_OK);
+        sqlite3_close(raw);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("DB: init indexes deferred rows that were never resumed", "[db][search]") {
+    const std::string testDb = "tmp_test_search_deferred_abandoned.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        int first = 0, second = 0;
+        {
+            DatabaseManager db(testDb);
+            db.init();
+            REQUIRE(db.hasFullTextIndex());
+            db.addCredential("indexed", "u", kEnc, kIv, "");
+            DatabaseManager other(testDb);
+            other.init();
+
+            db.deferFullTextIndex();
+            first  = db.addCredential("alphaservice", "u", kEnc, kIv, "");
+            second = db.addCredential("betaservice", "u", kEnc, kIv, "");
+
+            // Another connection indexes a higher id, then the loader dies
+            // without resumeFullTextIndex()
+            other.addCredential("deltaservice", "u", kEnc, kIv, "");
+        }
+
+        DatabaseManager db(testDb);
+        db.init();
+        CHECK(idsOf(db.searchCredentials("alphaservice")) == std::vector<int>{ first });
+        CHECK(idsOf(db.searchCredentials("betaservice")) == std::vector<int>{ second });
+        CHECK(db.searchCredentials("deltaservice").size() == 1);
+        CHECK(db.searchCredentials("indexed").size() == 1);
+
+        sqlite3* raw = nullptr;
+        REQUIRE(sqlite3_open(testDb.c_str(), &raw) == SQLITE_OK);
+        CHECK(sqlite3_exec(raw, "INSERT INTO credentials_fts(credentials_fts, rank) VALUES('integrity-check', 1);",
+                           nullptr, nullptr, nullptr) == SQLITE_OK);
+        sqlite3_close(raw);
+    }
+    std::filesystem::remove(testDb);
+}
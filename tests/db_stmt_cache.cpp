@@ -0,0 +1,50 @@
+// tests/db_stmt_cache.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+#include <string>
+
+TEST_CASE("DB: prepared statements are cached per connection", "[db][stmt]") {
+    const std::string testDb = "tmp_test_stmt_cache.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+
+        // Nothing prepared yet
+        auto s0 = db.stmtCacheStats();
+        REQUIRE(s0.hits == 0);
+        REQUIRE(s0.misses == 0);
+
+        std::vector<std::uint8_t> enc(20, 0x42), iv(12, 0x24);
+        int id1 = db.addCredential("svc-a", "alice", enc, iv, "n1");
+        int id2 = db.addCredential("svc-b", "bob",   enc, iv, "n2");
+
+        // First insert compiles, second reuses (the trigram index adds a
+        // second statement per insert)
+        const std::uint64_t perInsert = db.hasFullTextIndex() ? 2 : 1;
+        auto s1 = db.stmtCacheStats();
+        REQUIRE(s1.misses == perInsert);
+        REQUIRE(s1.hits == perInsert);
+
+        // Reused statements must not leak bindings/state between calls
+        auto r1 = db.getCredentialById(id1);
+        auto r2 = db.getCredentialById(id2);
+        REQUIRE(r1.has_value());
+        REQUIRE(r2.has_value());
+        REQUIRE(r1->username == "alice");
+        REQUIRE(r2->username == "bob");
+        REQUIRE_FALSE(db.getCredentialById(9999).has_value());
+
+        REQUIRE(db.searchByService("svc").size() == 2);
+        REQUIRE(db.searchByService("svc-b").size() == 1);
+
+        auto s2 = db.stmtCacheStats();
+        REQUIRE(s2.misses == perInsert + 2); // insert, getById, search
+        REQUIRE(s2.hits == perInsert + 2 + 1);
+    }
+    std::filesystem::remove(testDb);
+}
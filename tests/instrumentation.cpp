@@ -0,0 +1,111 @@
+// tests/instrumentation.cpp
+#include <catch2/catch_all.hpp>
+#include "Instrumentation.hpp"
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using instrumentation::Histogram;
+
+TEST_CASE("Histogram: buckets stay within 1/16 of the value", "[instr]") {
+    // Exact up to 32 ns
+    for (std::uint64_t v = 0; v < 32; ++v) {
+        CHECK(Histogram::bucketUpperBound(Histogram::bucketOf(v)) == v);
+    }
+    std::uint64_t prev = 0;
+    for (std::uint64_t v = 32; v < (std::uint64_t{1} << 40); v = v * 9 / 8 + 1) {
+        const std::size_t b = Histogram::bucketOf(v);
+        const std::uint64_t hi = Histogram::bucketUpperBound(b);
+        CHECK(b >= prev);
+        CHECK(hi >= v);
+        CHECK(hi - v <= v / 16);
+        prev = b;
+    }
+    // Clamped, never out of range
+    CHECK(Histogram::bucketOf(UINT64_MAX) == Histogram::kBuckets - 1);
+}
+
+TEST_CASE("Histogram: percentiles, max and totals", "[instr]") {
+    Histogram h("test.uniform");
+    for (std::uint64_t v = 1; v <= 10000; ++v) h.record(v * 1000); // 1 us .. 10 ms
+
+    const auto s = h.summary();
+    CHECK(s.count == 10000);
+    CHECK(s.maxNs == 10000000);
+    CHECK(s.totalNs == 1000ull * 10000 * 10001 / 2);
+    auto near = [](std::uint64_t got, double want) {
+        return got >= want && got <= want * 1.07;
+    };
+    CHECK(near(s.p50Ns, 5.0e6));
+    CHECK(near(s.p90Ns, 9.0e6));
+    CHECK(near(s.p99Ns, 9.9e6));
+    CHECK(h.percentile(1.0) == 10000000);
+
+    h.reset();
+    CHECK(h.count() == 0);
+    CHECK(h.percentile(0.5) == 0);
+}
+
+TEST_CASE("Histogram: concurrent records are all counted", "[instr]") {
+    Histogram h("test.concurrent");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&h, t] {
+            for (int i = 0; i < 50000; ++i) h.record(static_cast<std::uint64_t>(100 * (t + 1)));
+        });
+    }
+    for (auto& th : threads) th.join();
+    CHECK(h.count() == 200000);
+    CHECK(h.summary().maxNs == 400);
+}
+
+TEST_CASE("Registry: one histogram per name, dump lists recorded ones", "[instr]") {
+    Histogram& a = instrumentation::histogram("test.registry");
+    CHECK(&instrumentation::histogram("test.registry") == &a);
+    a.reset();
+    {
+        instrumentation::ScopedTimer timer(a);
+    }
+    CHECK(a.count() == 1);
+
+    std::ostringstream out;
+    instrumentation::dump(out);
+    if (instrumentation::kEnabled) CHECK(out.str().find("test.registry") != std::string::npos);
+}
+
+TEST_CASE("Instrumented hot paths record when enabled", "[instr][db]") {
+    if (!instrumentation::kEnabled) return; // timers compiled out
+
+    const std::string testDb = "tmp_test_instr.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+        instrumentation::resetAll();
+
+        const int id = db.addCredential("github", "octocat", {1}, {2}, "");
+        REQUIRE(db.getCredentialById(id).has_value());
+        REQUIRE(db.getCredentialById(id).has_value());
+        auto sealed = enc.encrypt(asBytes("secret"));
+        enc.decrypt(sealed.iv, sealed.encAndTag);
+
+        auto countOf = [](const std::string& name) {
+            for (const auto& s : instrumentation::snapshot())
+                if (s.name == name) return s.count;
+            return std::uint64_t{0};
+        };
+        CHECK(countOf("sql.addCredential") == 1);
+        CHECK(countOf("sql.getCredentialById") == 2);
+        CHECK(countOf("aes.encrypt") == 1);
+        CHECK(countOf("aes.decrypt") == 1);
+    }
+    std::filesystem::remove(testDb);
+}
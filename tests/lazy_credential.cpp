@@ -0,0 +1,81 @@
+// tests/lazy_credential.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "LazyCredential.hpp"
+#include "test_vault.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+TEST_CASE("LazyCredential: metadata now, secret on first reveal", "[cred][lazy]") {
+    const std::string testDb = "tmp_test_lazy.sqlite";
+    std::filesystem::remove(testDb);
+
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+
+        const std::string createdAt = "2025-01-02T03:04:05Z";
+        const std::string secret = "s3cr3t-token";
+        const int id = addSealed(db, enc, "github", "octocat", secret, createdAt, "work");
+        const Credential sealed = *db.getCredentialById(id);
+
+        REQUIRE_FALSE(LazyCredential::load(db, enc, 9999).has_value());
+
+        auto cred = LazyCredential::load(db, enc, id);
+        REQUIRE(cred);
+        CHECK(cred->meta.service == "github");
+        CHECK(cred->meta.username == "octocat");
+        CHECK(cred->meta.notes == "work");
+        CHECK(cred->meta.created_at == createdAt);
+        CHECK(cred->secret.id() == id);
+        CHECK_FALSE(cred->secret.revealed());
+
+        SECTION("reveal decrypts once and caches") {
+            CHECK(cred->secret.reveal() == secret);
+            CHECK(cred->secret.revealed());
+            db.deleteCredential(id); // no second read
+            CHECK(cred->secret.reveal() == secret);
+
+            cred->secret.forget();
+            CHECK_FALSE(cred->secret.revealed());
+            CHECK_THROWS_AS(cred->secret.reveal(), std::runtime_error); // row is gone now
+        }
+
+        SECTION("metadata loads without touching the ciphertext") {
+            // Corrupt the secret: metadata paths don't care, reveal does
+            auto bad = sealed.enc_password;
+            bad[0] ^= 0xFF;
+            db.updateSecrets(std::vector<SecretUpdate>{ {id, bad, sealed.iv} });
+
+            auto again = LazyCredential::load(db, enc, id);
+            REQUIRE(again);
+            CHECK(again->meta.service == "github");
+            CHECK_THROWS_AS(again->secret.reveal(), std::runtime_error);
+            CHECK_FALSE(again->secret.revealed());
+        }
+
+        SECTION("a renamed row no longer verifies under the old AAD") {
+            db.updateCredential(id, "someone-else", sealed.enc_password, sealed.iv, "");
+            CHECK_THROWS_AS(cred->secret.reveal(), std::runtime_error);
+        }
+
+        SECTION("moves carry the plaintext and leave the source empty") {
+            CHECK(cred->secret.reveal() == secret);
+            SecretRef moved = std::move(cred->secret);
+            CHECK(moved.revealed());
+            CHECK(moved.reveal() == secret);
+            CHECK_FALSE(cred->secret.revealed());
+
+            SecretRef other(db, enc, id);
+            other = std::move(moved);
+            CHECK(other.reveal() == secret);
+        }
+    }
+
+    std::filesystem::remove(testDb);
+}
@@ -0,0 +1,135 @@
+// tests/metadata_index.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+#include "MetadataIndex.hpp"
+
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+#include <string>
+
+namespace {
+    const std::vector<std::uint8_t> kEnc(20, 0x01);
+    const std::vector<std::uint8_t> kIv(12, 0x02);
+
+    std::vector<int> idsOf(const std::vector<MetadataIndex::Hit>& hits) {
+        std::vector<int> ids;
+        for (const auto& h : hits) ids.push_back(h.id);
+        return ids;
+    }
+
+    using Mode = MetadataIndex::Mode;
+}
+
+TEST_CASE("MetadataIndex: prefix, substring and fuzzy matching", "[index]") {
+    MetadataIndex index;
+    index.upsert(1, "GitHub", "octocat", "2024-01-01T00:00:00Z");
+    index.upsert(2, "GitLab", "hubert", "2024-01-02T00:00:00Z");
+    index.upsert(3, "Amazon Web Services", "ops", "2024-01-03T00:00:00Z");
+    index.upsert(4, "mail", "github-bot", "2024-01-04T00:00:00Z");
+    REQUIRE(index.size() == 4);
+
+    SECTION("prefix is case-insensitive; service hits outrank username hits") {
+        CHECK(idsOf(index.search("git", Mode::Prefix)) == std::vector<int>{1, 2, 4});
+        CHECK(idsOf(index.search("OCTO", Mode::Prefix)) == std::vector<int>{1});
+        CHECK(index.search("hub", Mode::Prefix).size() == 1); // hubert, not GitHub
+    }
+
+    SECTION("substring finds any position, never across fields") {
+        CHECK(idsOf(index.search("hub", Mode::Substring)) == std::vector<int>{1, 2, 4});
+        CHECK(idsOf(index.search("web", Mode::Substring)) == std::vector<int>{3});
+        // "GitHub" + "octocat" must not match "huboc"
+        CHECK(index.search("huboc", Mode::Substring).empty());
+        CHECK(index.search("", Mode::Substring).empty());
+    }
+
+    SECTION("hits carry the original text") {
+        auto hits = index.search("github", Mode::Substring, 1);
+        REQUIRE(hits.size() == 1);
+        CHECK(hits[0].service == "GitHub");
+        CHECK(hits[0].username == "octocat");
+        CHECK(hits[0].created_at == "2024-01-01T00:00:00Z");
+    }
+
+    SECTION("fuzzy: subsequences and typos") {
+        CHECK(idsOf(index.search("aws", Mode::Fuzzy)).front() == 3); // A.. W.. S..
+        CHECK(idsOf(index.search("gthb", Mode::Fuzzy)).front() == 1);
+        CHECK(idsOf(index.search("gihtub", Mode::Fuzzy)).front() == 1); // swapped letters
+        CHECK(idsOf(index.search("gitlba", Mode::Fuzzy)).front() == 2);
+        CHECK(index.search("zzz", Mode::Fuzzy).empty());
+    }
+
+    SECTION("limit keeps the best hits") {
+        CHECK(idsOf(index.search("g", Mode::Substring, 2)) == std::vector<int>{1, 2});
+    }
+}
+
+TEST_CASE("MetadataIndex: upsert replaces and erase removes", "[index]") {
+    MetadataIndex index;
+    index.upsert(7, "dropbox", "ann", "t");
+    index.upsert(7, "dropbox", "bea", "t");
+    CHECK(index.size() == 1);
+    CHECK(index.search("ann", Mode::Substring).empty());
+    CHECK(idsOf(index.search("bea", Mode::Substring)) == std::vector<int>{7});
+
+    index.erase(7);
+    index.erase(7); // unknown ids are ignored
+    CHECK(index.size() == 0);
+    CHECK(index.search("dropbox", Mode::Prefix).empty());
+
+    // Enough churn to trigger compaction; survivors must still be found
+    for (int id = 1; id <= 5000; ++id) index.upsert(id, "svc" + std::to_string(id), "u", "t");
+    for (int id = 1; id <= 4000; ++id) index.erase(id);
+    CHECK(index.size() == 1000);
+    CHECK(idsOf(index.search("svc4999", Mode::Prefix)) == std::vector<int>{4999});
+    CHECK(index.search("svc12", Mode::Prefix).empty());
+}
+
+TEST_CASE("MetadataIndex: built from and kept in sync with the DB", "[index][db]") {
+    const std::string testDb = "tmp_test_metadata_index.sqlite";
+    std::filesystem::remove(testDb);
+
+    DatabaseManager db(testDb);
+    db.init();
+    const int gh = db.addCredential("GitHub", "octocat", kEnc, kIv, "");
+    db.addCredential("mail", "alice", kEnc, kIv, "");
+
+    MetadataIndex index = MetadataIndex::build(db);
+    db.setObserver(&index);
+    CHECK(index.size() == 2);
+
+    const int bank = db.addCredential("bank", "bob", kEnc, kIv, "");
+    CHECK(idsOf(index.search("bank", Mode::Prefix)) == std::vector<int>{bank});
+
+    db.updateCredential(gh, "mona", kEnc, kIv, "");
+    auto hits = index.search("github", Mode::Prefix);
+    REQUIRE(hits.size() == 1);
+    CHECK(hits[0].username == "mona");
+
+    db.deleteCredential(bank);
+    CHECK(index.search("bank", Mode::Prefix).empty());
+
+    SECTION("changes in a rolled back transaction never reach the index") {
+        db.beginTransaction();
+        db.addCredential("ghost", "x", kEnc, kIv, "");
+        CHECK(index.search("ghost", Mode::Prefix).empty()); // held until commit
+        db.rollback();
+        CHECK(index.search("ghost", Mode::Prefix).empty());
+        CHECK(index.size() == 2);
+    }
+
+    SECTION("committed bulk inserts are applied once") {
+        std::vector<NewCredential> rows(3);
+        for (int i = 0; i < 3; ++i) {
+            rows[i] = { "bulk" + std::to_string(i), "u", kEnc, kIv, "", "" };
+        }
+        db.addCredentials(rows, 2);
+        CHECK(index.size() == 5);
+        CHECK(index.search("bulk", Mode::Prefix).size() == 3);
+    }
+
+    db.setObserver(nullptr);
+    std::filesystem::remove(testDb);
+    std::filesystem::remove(testDb + "-wal");
+    std::filesystem::remove(testDb + "-shm");
+}
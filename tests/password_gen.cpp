@@ -0,0 +1,113 @@
+// tests/password_gen.cpp
+#include <catch2/catch_all.hpp>
+#include "PasswordGenerator.hpp"
+#include "password_gen.hpp"
+
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("PasswordGenerator: classes, ambiguity and minimums", "[passgen]") {
+    PasswordPolicy noSymbols;
+    noSymbols.length = 32;
+    noSymbols.symbols = false;
+    noSymbols.excludeAmbiguous = true;
+    for (const std::string& pw : PasswordGenerator(noSymbols).generateMany(500)) {
+        REQUIRE(pw.size() == 32);
+        for (const char c : pw) {
+            CHECK(std::isalnum(static_cast<unsigned char>(c)));
+            CHECK(std::string_view("0O1lI").find(c) == std::string_view::npos);
+        }
+    }
+
+    // Minimums hold every time, and the required characters get shuffled
+    PasswordPolicy strict;
+    strict.length = 8;
+    strict.lower = false;
+    strict.digits = false;
+    strict.minUpper = 2;
+    strict.minSymbols = 5;
+    std::size_t symbolLast = 0;
+    for (const std::string& pw : PasswordGenerator(strict).generateMany(2000)) {
+        REQUIRE(pw.size() == 8);
+        std::size_t up = 0, sym = 0;
+        for (const char c : pw) (std::isupper(static_cast<unsigned char>(c)) ? up : sym)++;
+        CHECK(up >= 2);
+        CHECK(sym >= 5);
+        if (!std::isupper(static_cast<unsigned char>(pw.back()))) ++symbolLast;
+    }
+    CHECK(symbolLast > 1000);
+    CHECK(symbolLast < 2000);
+
+    // Unbiased: 200k digits land within a few sigma of uniform
+    PasswordPolicy digitsOnly;
+    digitsOnly.length = 200000;
+    digitsOnly.upper = digitsOnly.lower = digitsOnly.symbols = false;
+    std::array<std::size_t, 10> counts{};
+    for (const char c : PasswordGenerator(digitsOnly).generate()) ++counts[c - '0'];
+    for (const std::size_t n : counts) CHECK(std::abs(static_cast<double>(n) - 20000.0) < 1000.0);
+
+    const auto batch = PasswordGenerator().generateMany(1000);
+    CHECK(std::set<std::string>(batch.begin(), batch.end()).size() == 1000);
+    CHECK(std::abs(PasswordGenerator().entropyBits() - 20 * std::log2(86.0)) < 1e-9);
+}
+
+TEST_CASE("PasswordGenerator: rejects impossible policies", "[passgen]") {
+    PasswordPolicy p;
+    p.upper = p.lower = p.digits = p.symbols = false;
+    CHECK_THROWS_AS(PasswordGenerator(p), std::invalid_argument);
+    CHECK_THROWS_AS(generate_password(10, false, false, false, false), std::invalid_argument);
+
+    p = PasswordPolicy{};
+    p.symbols = false;
+    p.minSymbols = 1;
+    CHECK_THROWS_AS(PasswordGenerator(p), std::invalid_argument);
+
+    p = PasswordPolicy{};
+    p.length = 4;
+    p.minDigits = 3;
+    p.minUpper = 2;
+    CHECK_THROWS_AS(PasswordGenerator(p), std::invalid_argument);
+
+    // Minimums whose sum wraps around to a small number
+    p = PasswordPolicy{};
+    p.minUpper = SIZE_MAX;
+    p.minLower = 1;
+    CHECK_THROWS_AS(PasswordGenerator(p), std::invalid_argument);
+    p.minUpper = SIZE_MAX - 2;
+    p.minLower = 2;
+    p.minDigits = 2;
+    CHECK_THROWS_AS(PasswordGenerator(p), std::invalid_argument);
+
+    CHECK(generate_password(0).empty());
+    CHECK(generate_password(16, false, true, false, false).size() == 16);
+}
+
+TEST_CASE("PasswordGenerator: passphrases", "[passgen]") {
+    std::istringstream list("11111\tapple\n11112\tbanana\n\napple\ncherry\r\n");
+    const std::vector<std::string> words = readWordlist(list);
+    CHECK(words == std::vector<std::string>{ "apple", "banana", "cherry" });
+
+    PassphrasePolicy policy;
+    policy.words = 4;
+    policy.separator = ".";
+    policy.capitalize = true;
+    const PasswordGenerator gen(words, policy);
+    CHECK(std::abs(gen.entropyBits() - 4 * std::log2(3.0)) < 1e-9);
+
+    const std::set<std::string> allowed{ "Apple", "Banana", "Cherry" };
+    for (const std::string& phrase : gen.generateMany(200)) {
+        std::istringstream parts(phrase);
+        std::size_t n = 0;
+        for (std::string w; std::getline(parts, w, '.'); ++n) CHECK(allowed.count(w) == 1);
+        CHECK(n == 4);
+    }
+
+    CHECK_THROWS_AS(PasswordGenerator(std::vector<std::string>{ "one", "one" }, policy),
+                    std::invalid_argument);
+}
@@ -0,0 +1,83 @@
+// tests/rekey_engine.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "CredentialAad.hpp"
+#include "ReKeyEngine.hpp"
+#include "test_vault.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+TEST_CASE("ReKeyEngine: re-encrypts every row under the new key", "[rekey]") {
+    const std::string testDb = "tmp_test_rekey.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+
+        // Fixed keys keep the test fast (no Argon2)
+        EncryptionManager encOld(std::vector<std::uint8_t>(32, 0x01));
+        EncryptionManager encNew(std::vector<std::uint8_t>(32, 0x02));
+
+        const std::string created = "2025-01-01T00:00:00Z";
+        std::vector<NewCredential> rows;
+        for (int i = 0; i < 500; ++i) {
+            rows.push_back(sealedRow(encOld, "svc" + std::to_string(i % 13), "user" + std::to_string(i),
+                                     "secret-" + std::to_string(i), created, "n" + std::to_string(i)));
+        }
+        auto ids = db.addCredentials(rows);
+
+        ReKeyOptions opts;
+        opts.threads   = 3;
+        opts.batchSize = 37; // many small batches exercise the pipeline
+
+        SECTION("All rows decrypt with the new key; notes preserved") {
+            std::size_t lastDone = 0;
+            db.beginTransaction();
+            ReKeyEngine engine(db, encOld, encNew, opts);
+            std::size_t n = engine.run([&](std::size_t done, std::size_t total) {
+                REQUIRE(done > lastDone);
+                REQUIRE(total == rows.size());
+                lastDone = done;
+            });
+            db.commit();
+            REQUIRE(n == rows.size());
+            REQUIRE(lastDone == rows.size());
+
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                auto c = db.getCredentialById(ids[i]);
+                REQUIRE(c.has_value());
+                REQUIRE(c->notes == rows[i].notes);
+                auto aad = makeCredentialAad(c->service, c->username, c->created_at);
+                auto pt = encNew.decrypt(c->iv, c->enc_password, aad);
+                REQUIRE(std::string(pt.begin(), pt.end()) == "secret-" + std::to_string(i));
+                REQUIRE_THROWS(encOld.decrypt(c->iv, c->enc_password, aad));
+            }
+        }
+
+        SECTION("A tampered row aborts and rollback keeps the old ciphertext") {
+            auto bad = db.getCredentialById(ids[250]);
+            auto tampered = bad->enc_password;
+            tampered[0] ^= 0x01;
+            db.updateCredential(bad->id, bad->username, tampered, bad->iv, bad->notes);
+
+            db.beginTransaction();
+            ReKeyEngine engine(db, encOld, encNew, opts);
+            REQUIRE_THROWS_AS(engine.run(), std::runtime_error);
+            db.rollback();
+
+            auto first = db.getCredentialById(ids[0]);
+            auto aad = makeCredentialAad(first->service, first->username, first->created_at);
+            REQUIRE_NOTHROW(encOld.decrypt(first->iv, first->enc_password, aad));
+        }
+
+        SECTION("Requires an open transaction") {
+            ReKeyEngine engine(db, encOld, encNew, opts);
+            REQUIRE_THROWS_AS(engine.run(), std::logic_error);
+        }
+    }
+    std::filesystem::remove(testDb);
+}
@@ -0,0 +1,35 @@
+// tests/test_vault.hpp
+#pragma once
+#include "CredentialAad.hpp"
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+
+#include <span>
+#include <string>
+#include <utility>
+
+// A row sealed the way the app seals it: the AAD covers the service,
+// username and created_at stored with the row
+inline NewCredential sealedRow(const EncryptionManager& enc, const std::string& service,
+                               const std::string& username, const std::string& secret,
+                               const std::string& createdAt = "2025-01-02T03:04:05Z",
+                               const std::string& notes = "") {
+    NewCredential nc;
+    nc.service    = service;
+    nc.username   = username;
+    nc.notes      = notes;
+    nc.created_at = createdAt;
+    auto sealed = enc.encrypt(asBytes(secret), makeCredentialAad(nc.service, nc.username, nc.created_at));
+    nc.iv = std::move(sealed.iv);
+    nc.enc_password = std::move(sealed.encAndTag);
+    return nc;
+}
+
+// Seal and insert one row; returns its id
+inline int addSealed(DatabaseManager& db, const EncryptionManager& enc, const std::string& service,
+                     const std::string& username, const std::string& secret,
+                     const std::string& createdAt = "2025-01-02T03:04:05Z",
+                     const std::string& notes = "") {
+    const NewCredential nc = sealedRow(enc, service, username, secret, createdAt, notes);
+    return db.addCredentials(std::span<const NewCredential>(&nc, 1)).front();
+}
@@ -0,0 +1,93 @@
+// tests/vault_audit.cpp
+#include <catch2/catch_all.hpp>
+#include "CredentialAad.hpp"
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "PasswordStrength.hpp"
+#include "VaultAudit.hpp"
+#include "test_vault.hpp"
+
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    int score(std::string_view pw) { return estimateStrength(pw).score; }
+}
+
+TEST_CASE("estimateStrength: patterns cost far less than their length", "[strength]") {
+    CHECK(estimateStrength("").bits == 0);
+    for (const char* pw : { "password", "P@ssw0rd", "drowssap", "qwertyuiop", "abcdefgh",
+                            "98765432", "aaaaaaaaaaaa", "summer2019", "Monkey1234" }) {
+        INFO(pw);
+        CHECK(score(pw) <= 1);
+    }
+
+    // Repeating a weak block barely helps; a known context word is free-ish
+    CHECK(estimateStrength("batmanbatmanbatman").bits < estimateStrength("batman").bits + 4);
+    const std::string_view ctx[] = { "github.com", "octocat" };
+    CHECK(estimateStrength("Octocat2024!", ctx).bits < estimateStrength("Octocat2024!").bits);
+
+    // Random-looking strings keep roughly their brute-force entropy
+    CHECK(score("xK9#mQ2$vL7p") >= 2);
+    CHECK(score("G7v#q9Lz!T2m@wR4") == 4);
+    CHECK(score("correct horse battery staple") >= 3);
+    CHECK(estimateStrength(std::string(1000, 'x') + "Zq9!").bits > 0); // long input, no overflow
+    CHECK(std::string(strengthLabel(0)) == "very weak");
+    CHECK(std::string(strengthLabel(4)) == "very strong");
+}
+
+TEST_CASE("auditVault: weak, reused and old entries", "[audit]") {
+    const std::string testDb = "tmp_test_audit.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+        CHECK(auditVault(db, enc).clean());
+
+        std::vector<NewCredential> rows;
+        rows.push_back(sealedRow(enc, "mail", "alice", "G7v#q9Lz!T2m@wR4"));        // 1
+        rows.push_back(sealedRow(enc, "bank", "alice", "letmein"));                 // 2 weak
+        rows.push_back(sealedRow(enc, "forum", "alice", "G7v#q9Lz!T2m@wR4"));       // 3 reuses 1
+        rows.push_back(sealedRow(enc, "shop", "bob", "bob2020", "2019-06-01T00:00:00Z")); // 4 weak, old
+        rows.push_back(sealedRow(enc, "news", "carol", "letmein"));                 // 5 weak, reuses 2
+        rows.push_back(sealedRow(enc, "chat", "dave", "G7v#q9Lz!T2m@wR4"));         // 6 reuses 1
+        for (int i = 0; i < 500; ++i) {
+            rows.push_back(sealedRow(enc, "bulk", "u", "Zx8&kP3!rN6q-" + std::to_string(i)));
+        }
+        db.addCredentials(rows);
+
+        AuditOptions opt;
+        opt.scan.threads = 3;
+        opt.scan.chunkRows = 16;
+        opt.oldBefore = "2020-01-01T00:00:00Z";
+        const AuditReport r = auditVault(db, enc, opt);
+        CHECK(r.rows == 506);
+        CHECK(r.failed == 0);
+        REQUIRE(r.weak.size() == 3);
+        CHECK(r.weak[0].id == 2);
+        CHECK(r.weak[1].id == 4);
+        CHECK(r.weak[2].id == 5);
+        CHECK(r.reused == std::vector<std::vector<int>>{ { 1, 3, 6 }, { 2, 5 } });
+        REQUIRE(r.old.size() == 1);
+        CHECK(r.old[0].id == 4);
+        CHECK(r.old[0].created_at == "2019-06-01T00:00:00Z");
+        CHECK_FALSE(r.clean());
+
+        // Undecryptable rows are counted, not audited
+        EncryptionManager other(std::vector<std::uint8_t>(32, 0x43));
+        const AuditReport wrong = auditVault(db, other, opt);
+        CHECK(wrong.failed == 506);
+        CHECK(wrong.weak.empty());
+        CHECK(wrong.reused.empty());
+        CHECK(wrong.old.size() == 1);
+
+        CHECK(iso8601DaysAgo(0) > iso8601DaysAgo(1));
+        CHECK(iso8601DaysAgo(365).size() == 20);
+        CHECK(iso8601Utc(0) == "1970-01-01T00:00:00Z");
+        CHECK(iso8601Utc(1735787045) == "2025-01-02T03:04:05Z");
+    }
+    std::filesystem::remove(testDb);
+}
@@ -0,0 +1,116 @@
+// tests/vault_dump.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "Json.hpp"
+#include "VaultDump.hpp"
+#include "VaultScan.hpp"
+#include "test_vault.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("scanDecrypted: parallel, in id order, failures reported", "[scan]") {
+    const std::string testDb = "tmp_test_scan.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+        for (int i = 0; i < 1000; ++i) {
+            addSealed(db, enc, "svc" + std::to_string(i), "u", "pw" + std::to_string(i));
+        }
+        // Swap two rows' ciphertexts: both fail their AAD check
+        auto a = db.getCredentialById(10), b = db.getCredentialById(20);
+        db.updateSecrets(std::vector<SecretUpdate>{ {10, b->enc_password, b->iv}, {20, a->enc_password, a->iv} });
+
+        ScanOptions opt;
+        opt.threads = 4;
+        opt.chunkRows = 7; // many chunks in flight
+        std::vector<int> ids;
+        std::size_t mismatches = 0;
+        const std::size_t failed = scanDecrypted(db, enc, [&](const PlainRow& r) {
+            ids.push_back(r.id);
+            CHECK(r.iv.size() == EncryptionManager::kIvLen);
+            if (r.id == 10 || r.id == 20) {
+                CHECK_FALSE(r.ok);
+                CHECK(r.password.empty());
+            } else if (!r.ok || r.password != "pw" + std::to_string(r.id - 1) ||
+                       r.service != "svc" + std::to_string(r.id - 1)) {
+                ++mismatches;
+            }
+        }, opt);
+        CHECK(failed == 2);
+        CHECK(mismatches == 0);
+        REQUIRE(ids.size() == 1000);
+        for (std::size_t i = 0; i < ids.size(); ++i) CHECK(ids[i] == static_cast<int>(i) + 1);
+
+        // A throwing visitor stops the scan and surfaces its exception
+        int seen = 0;
+        CHECK_THROWS_AS(scanDecrypted(db, enc, [&](const PlainRow&) {
+            if (++seen == 50) throw std::logic_error("stop");
+        }, opt), std::logic_error);
+        CHECK(seen == 50);
+
+        // Unordered: every row exactly once, across the workers
+        std::mutex mu;
+        std::vector<int> chunked;
+        std::size_t chunks = 0, oversized = 0;
+        CHECK(scanDecryptedUnordered(db, enc, [&](std::span<const PlainRow> rows) {
+            // Runs on the workers: tally here, assert once the scan is done
+            const std::lock_guard<std::mutex> lock(mu);
+            if (rows.size() > opt.chunkRows) ++oversized;
+            ++chunks;
+            for (const PlainRow& r : rows) chunked.push_back(r.id);
+        }, opt) == 2);
+        std::sort(chunked.begin(), chunked.end());
+        CHECK(chunked == ids);
+        CHECK(chunks == 143);
+        CHECK(oversized == 0);
+        CHECK_THROWS_AS(scanDecryptedUnordered(db, enc, [](std::span<const PlainRow>) {
+            throw std::logic_error("stop");
+        }, opt), std::logic_error);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("dumpVault: CSV and JSON Lines", "[dump]") {
+    const std::string testDb = "tmp_test_dump.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+        const std::string created = "2025-03-04T05:06:07Z";
+        addSealed(db, enc, "plain", "bob", "s3cret", created);
+        addSealed(db, enc, "with,comma", "say \"hi\"", "multi\nline", created, "n");
+
+        std::ostringstream csv;
+        const DumpStats st = dumpVault(db, enc, csv, DumpFormat::Csv);
+        CHECK(st.rows == 2);
+        CHECK(st.failed == 0);
+        CHECK(csv.str() ==
+              "service,username,password,notes,created_at,id\n"
+              "plain,bob,s3cret,,2025-03-04T05:06:07Z,1\n"
+              "\"with,comma\",\"say \"\"hi\"\"\",\"multi\nline\",n,2025-03-04T05:06:07Z,2\n");
+
+        std::ostringstream jsonl;
+        CHECK(dumpVault(db, enc, jsonl, DumpFormat::JsonLines).rows == 2);
+        std::istringstream lines(jsonl.str());
+        std::vector<json::Object> rows;
+        for (std::string line; std::getline(lines, line);) rows.push_back(json::parseObject(line));
+        REQUIRE(rows.size() == 2);
+        CHECK(*json::getInt(rows[1], "id") == 2);
+        CHECK(*json::getString(rows[1], "username") == "say \"hi\"");
+        CHECK(*json::getString(rows[1], "password") == "multi\nline");
+        CHECK(*json::getString(rows[0], "created_at") == "2025-03-04T05:06:07Z");
+
+        CHECK(parseDumpFormat("jsonl") == DumpFormat::JsonLines);
+        CHECK_FALSE(parseDumpFormat("xml").has_value());
+    }
+    std::filesystem::remove(testDb);
+}
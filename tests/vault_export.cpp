@@ -0,0 +1,144 @@
+// tests/vault_export.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "LazyCredential.hpp"
+#include "VaultExport.hpp"
+#include "test_vault.hpp"
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    ExportOptions fast_options(std::size_t chunkBytes) {
+        ExportOptions o;
+        o.kdf = KdfParams{1, 64, 1}; // keep the test fast
+        o.chunkBytes = chunkBytes;
+        return o;
+    }
+
+    void seed(DatabaseManager& db, const EncryptionManager& enc, int n) {
+        std::vector<NewCredential> rows;
+        for (int i = 0; i < n; ++i) {
+            const std::string createdAt = "2024-01-" + std::string(i % 28 < 9 ? "0" : "")
+                                        + std::to_string(i % 28 + 1) + "T00:00:00Z";
+            rows.push_back(sealedRow(enc, "svc-" + std::to_string(i),
+                                     i % 3 ? "user" + std::to_string(i) : "",
+                                     "secret-" + std::to_string(i * 7919), createdAt,
+                                     i % 2 ? "nöte " + std::string(i % 50, 'x') : ""));
+        }
+        db.addCredentials(rows);
+    }
+}
+
+TEST_CASE("VaultExport: round-trip into another vault", "[export]") {
+    const std::string dbA = "tmp_test_export_a.sqlite", dbB = "tmp_test_export_b.sqlite";
+    std::filesystem::remove(dbA);
+    std::filesystem::remove(dbB);
+    {
+        DatabaseManager a(dbA), b(dbB);
+        a.init();
+        b.init();
+        EncryptionManager keyA(std::vector<std::uint8_t>(32, 0x11));
+        EncryptionManager keyB(std::vector<std::uint8_t>(32, 0x22));
+        seed(a, keyA, 500);
+
+        std::vector<bool> modes{false};
+        if (exportCompressionAvailable()) modes.push_back(true);
+        for (const bool compress : modes) {
+            DYNAMIC_SECTION("compress=" << compress) {
+                std::stringstream file;
+                auto opt = fast_options(1024); // many small chunks
+                opt.compress = compress;
+                const ExportStats out = exportVault(a, keyA, "backup pw", file, opt);
+                CHECK(out.records == 500);
+                CHECK(out.chunks > 10);
+                CHECK(out.bytes == file.str().size());
+
+                REQUIRE(isVaultExport(file));
+                const ExportStats in = importVault(b, keyB, "backup pw", file);
+                CHECK(in.records == 500);
+                CHECK(in.chunks == out.chunks);
+                CHECK_FALSE(b.inTransaction());
+                REQUIRE(b.countCredentials() == 500);
+
+                // Same fields, re-sealed under B's key
+                for (int id = 1; id <= 500; ++id) {
+                    auto src = LazyCredential::load(a, keyA, id);
+                    auto dst = LazyCredential::load(b, keyB, id);
+                    REQUIRE(src);
+                    REQUIRE(dst);
+                    CHECK(dst->meta.service == src->meta.service);
+                    CHECK(dst->meta.username == src->meta.username);
+                    CHECK(dst->meta.notes == src->meta.notes);
+                    CHECK(dst->meta.created_at == src->meta.created_at);
+                    CHECK(dst->secret.reveal() == src->secret.reveal());
+                }
+            }
+        }
+    }
+    std::filesystem::remove(dbA);
+    std::filesystem::remove(dbB);
+}
+
+TEST_CASE("VaultExport: rejects wrong passphrase and tampering", "[export]") {
+    const std::string dbA = "tmp_test_export_c.sqlite", dbB = "tmp_test_export_d.sqlite";
+    std::filesystem::remove(dbA);
+    std::filesystem::remove(dbB);
+    {
+        DatabaseManager a(dbA), b(dbB);
+        a.init();
+        b.init();
+        EncryptionManager keyA(std::vector<std::uint8_t>(32, 0x11));
+        EncryptionManager keyB(std::vector<std::uint8_t>(32, 0x22));
+
+        // Empty vault: just the final chunk
+        {
+            std::stringstream file;
+            const auto st = exportVault(a, keyA, "pw", file, fast_options(1024));
+            CHECK(st.records == 0);
+            CHECK(st.chunks == 1);
+            CHECK(importVault(b, keyB, "pw", file).records == 0);
+        }
+
+        seed(a, keyA, 200);
+        std::stringstream file;
+        exportVault(a, keyA, "pw", file, fast_options(512));
+        const std::string good = file.str();
+
+        auto import_of = [&](const std::string& bytes, std::string_view pw) {
+            std::stringstream in(bytes);
+            return importVault(b, keyB, pw, in);
+        };
+
+        CHECK_THROWS_AS(import_of(good, "wrong"), std::runtime_error);
+
+        std::string flipped = good;
+        flipped[flipped.size() / 2] ^= 0x01;
+        CHECK_THROWS_AS(import_of(flipped, "pw"), std::runtime_error);
+
+        std::string header = good;
+        header[12] ^= 0x01; // m cost: still valid, but in every chunk's AAD
+        CHECK_THROWS_AS(import_of(header, "pw"), std::runtime_error);
+        header = good;
+        header[8] = 0;      // t = 0 is rejected before any KDF run
+        CHECK_THROWS_AS(import_of(header, "pw"), std::runtime_error);
+
+        CHECK_THROWS_AS(import_of(good.substr(0, good.size() - 100), "pw"), std::runtime_error);
+        CHECK_THROWS_AS(import_of(good + "x", "pw"), std::runtime_error);
+
+        // Every failure rolled back completely
+        CHECK(b.countCredentials() == 0);
+        CHECK_FALSE(b.inTransaction());
+
+        CHECK(import_of(good, "pw").records == 200);
+
+        std::stringstream csv("service,username,password\n");
+        CHECK_FALSE(isVaultExport(csv));
+        CHECK(csv.get() == 's'); // rewound
+    }
+    std::filesystem::remove(dbA);
+    std::filesystem::remove(dbB);
+}
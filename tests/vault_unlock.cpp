@@ -0,0 +1,242 @@
+// tests/vault_unlock.cpp
+#include <catch2/catch_all.hpp>
+#include "AuthManager.hpp"
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "CredentialAad.hpp"
+#include "VaultUnlock.hpp"
+#include "test_vault.hpp"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace {
+    std::string decryptRow(const EncryptionManager& enc, const Credential& c) {
+        auto pt = enc.decrypt(c.iv, c.enc_password,
+                              makeCredentialAad(c.service, c.username, c.created_at));
+        return { pt.begin(), pt.end() };
+    }
+
+    int addSecret(DatabaseManager& db, const EncryptionManager& enc,
+                  const std::string& service, const std::string& secret) {
+        return addSealed(db, enc, service, "alice", secret);
+    }
+}
+
+TEST_CASE("Vault: create, unlock and change master with one KDF run", "[vault]") {
+    const std::string testDb = "tmp_test_vault.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+
+        auto enc = createVault(db, "correct horse");
+        REQUIRE(db.loadMasterScheme() == kMasterSchemeHkdf);
+        REQUIRE(db.loadKdfSalt().has_value());
+        const int id = addSecret(db, enc, "github", "s3cret");
+
+        REQUIRE_FALSE(unlockVault(db, "wrong horse").has_value());
+
+        auto again = unlockVault(db, "correct horse");
+        REQUIRE(again.has_value());
+        REQUIRE(decryptRow(*again, *db.getCredentialById(id)) == "s3cret");
+
+        SECTION("change master re-keys under a fresh salt") {
+            const auto oldSalt = *db.loadKdfSalt();
+            REQUIRE_FALSE(changeMasterPassword(db, "wrong horse", "new horse").has_value());
+
+            auto changed = changeMasterPassword(db, "correct horse", "new horse");
+            REQUIRE(changed.has_value());
+            REQUIRE(*db.loadKdfSalt() != oldSalt);
+            REQUIRE(decryptRow(*changed, *db.getCredentialById(id)) == "s3cret");
+
+            REQUIRE_FALSE(unlockVault(db, "correct horse").has_value());
+            auto relog = unlockVault(db, "new horse");
+            REQUIRE(relog.has_value());
+            REQUIRE(decryptRow(*relog, *db.getCredentialById(id)) == "s3cret");
+        }
+
+        SECTION("verifier and K_enc are independent HKDF outputs") {
+            std::vector<std::uint8_t> root(32, 0x33);
+            MasterKeys keys = splitRootKey(root);
+            REQUIRE(keys.encKey.size() == 32);
+            REQUIRE(keys.verifier.size() == 32);
+            REQUIRE_FALSE(std::ranges::equal(keys.encKey, keys.verifier));
+            REQUIRE_FALSE(std::ranges::equal(keys.encKey, root));
+            REQUIRE_FALSE(std::ranges::equal(db.loadMaster()->second, keys.verifier));
+        }
+    }
+    std::filesystem::remove(testDb);
+}
+
+namespace {
+    // The pre-`scheme` master_auth table older builds created
+    void createLegacyMasterTable(const std::string& path) {
+        sqlite3* raw = nullptr;
+        REQUIRE(sqlite3_open(path.c_str(), &raw) == SQLITE_OK);
+        REQUIRE(sqlite3_exec(raw,
+            "CREATE TABLE master_auth (id INTEGER PRIMARY KEY CHECK (id = 1),"
+            " salt BLOB NOT NULL, hash BLOB NOT NULL);",
+            nullptr, nullptr, nullptr) == SQLITE_OK);
+        sqlite3_close(raw);
+    }
+
+    // A scheme-1 master record and kdf_salt; returns the key rows were sealed with
+    EncryptionManager storeLegacyMaster(DatabaseManager& db) {
+        AuthManager auth;
+        StoredAuth rec = auth.createMasterRecord("legacy pw");
+        db.storeMaster(rec.salt, rec.hash);
+        REQUIRE(db.loadMasterScheme() == kMasterSchemeTwoHash);
+
+        std::vector<std::uint8_t> kdfSalt(16, 0x5A);
+        db.storeKdfSalt(kdfSalt);
+        return EncryptionManager(EncryptionManager::deriveKey("legacy pw", kdfSalt));
+    }
+}
+
+TEST_CASE("Vault: legacy two-hash vault unlocks as is and upgrades on request", "[vault]") {
+    const std::string testDb = "tmp_test_vault_legacy.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        createLegacyMasterTable(testDb);
+        DatabaseManager db(testDb);
+        db.init(); // adds the scheme column
+        EncryptionManager legacyEnc = storeLegacyMaster(db);
+        const int a = addSecret(db, legacyEnc, "mail", "one");
+        const int b = addSecret(db, legacyEnc, "bank", "two");
+
+        REQUIRE_FALSE(unlockVault(db, "nope").has_value());
+        REQUIRE_FALSE(upgradeVault(db, "nope").has_value());
+        REQUIRE(db.loadMasterScheme() == kMasterSchemeTwoHash);
+
+        // Unlock leaves the rows alone
+        auto legacy = unlockVault(db, "legacy pw");
+        REQUIRE(legacy.has_value());
+        REQUIRE(db.loadMasterScheme() == kMasterSchemeTwoHash);
+        REQUIRE(decryptRow(*legacy, *db.getCredentialById(a)) == "one");
+
+        std::size_t reported = 0;
+        auto enc = upgradeVault(db, "legacy pw", [&](std::size_t done, std::size_t) { reported = done; });
+        REQUIRE(enc.has_value());
+        REQUIRE(reported == 2);
+        REQUIRE(db.loadMasterScheme() == kMasterSchemeHkdf);
+        REQUIRE(decryptRow(*enc, *db.getCredentialById(a)) == "one");
+        REQUIRE(decryptRow(*enc, *db.getCredentialById(b)) == "two");
+        REQUIRE_THROWS(decryptRow(legacyEnc, *db.getCredentialById(a)));
+
+        // Later unlocks take the scheme-2 path and see the same data
+        auto again = unlockVault(db, "legacy pw");
+        REQUIRE(again.has_value());
+        REQUIRE(decryptRow(*again, *db.getCredentialById(b)) == "two");
+        REQUIRE(upgradeVault(db, "legacy pw").has_value());
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("Vault: a legacy row that fails to decrypt never blocks unlock", "[vault]") {
+    const std::string testDb = "tmp_test_vault_legacy_bad.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        createLegacyMasterTable(testDb);
+        DatabaseManager db(testDb);
+        db.init(); // adds the scheme column
+        EncryptionManager legacyEnc = storeLegacyMaster(db);
+        const int good = addSecret(db, legacyEnc, "mail", "one");
+
+        // Older builds stamped created_at twice; the stored one could be a
+        // second past the one that went into the AAD
+        NewCredential ticked = sealedRow(legacyEnc, "bank", "alice", "two", "2025-01-02T03:04:05Z");
+        ticked.created_at = "2025-01-02T03:04:06Z";
+        const int bad = db.addCredentials(std::span<const NewCredential>(&ticked, 1)).front();
+
+        auto enc = unlockVault(db, "legacy pw");
+        REQUIRE(enc.has_value());
+        REQUIRE(decryptRow(*enc, *db.getCredentialById(good)) == "one");
+        REQUIRE_THROWS(decryptRow(*enc, *db.getCredentialById(bad)));
+
+        // The upgrade is all or nothing and leaves a usable scheme-1 vault
+        REQUIRE_THROWS(upgradeVault(db, "legacy pw"));
+        REQUIRE(db.loadMasterScheme() == kMasterSchemeTwoHash);
+        auto still = unlockVault(db, "legacy pw");
+        REQUIRE(still.has_value());
+        REQUIRE(decryptRow(*still, *db.getCredentialById(good)) == "one");
+
+        // Once the bad row is gone the upgrade goes through
+        db.deleteCredential(bad);
+        auto upgraded = upgradeVault(db, "legacy pw");
+        REQUIRE(upgraded.has_value());
+        REQUIRE(db.loadMasterScheme() == kMasterSchemeHkdf);
+        REQUIRE(decryptRow(*upgraded, *db.getCredentialById(good)) == "one");
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("Vault: legacy vault without kdf_salt upgrades without re-keying", "[vault]") {
+    const std::string testDb = "tmp_test_vault_nosalt.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        AuthManager auth;
+        StoredAuth rec = auth.createMasterRecord("first run");
+        db.storeMaster(rec.salt, rec.hash);
+
+        auto enc = unlockVault(db, "first run");
+        REQUIRE(enc.has_value());
+        REQUIRE(db.loadMasterScheme() == kMasterSchemeHkdf);
+        REQUIRE(db.loadKdfSalt().has_value());
+        REQUIRE(unlockVault(db, "first run").has_value());
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("Vault: KDF params are persisted and used at unlock", "[vault][kdf]") {
+    const std::string testDb = "tmp_test_vault_params.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+
+        // Cheap multi-lane params keep the test quick
+        const KdfParams lanes{ 1, 8 * 1024, 2 };
+        auto enc = createVault(db, "pw", lanes);
+        REQUIRE(db.loadKdfParams() == lanes);
+        const int id = addSecret(db, enc, "svc", "lanes");
+
+        auto unlocked = unlockVault(db, "pw");
+        REQUIRE(unlocked.has_value());
+        REQUIRE(decryptRow(*unlocked, *db.getCredentialById(id)) == "lanes");
+
+        // Same password + new params re-tunes the vault
+        const KdfParams tuned{ 2, 16 * 1024, 4 };
+        auto retuned = changeMasterPassword(db, "pw", "pw", {}, tuned);
+        REQUIRE(retuned.has_value());
+        REQUIRE(db.loadKdfParams() == tuned);
+        REQUIRE(decryptRow(*retuned, *db.getCredentialById(id)) == "lanes");
+
+        // A plain password change keeps them
+        REQUIRE(changeMasterPassword(db, "pw", "pw2").has_value());
+        REQUIRE(db.loadKdfParams() == tuned);
+        REQUIRE(unlockVault(db, "pw2").has_value());
+
+        // Lanes change the derived key
+        const std::vector<std::uint8_t> salt(16, 0x01);
+        REQUIRE(EncryptionManager::deriveKey("pw", salt, KdfParams{ 1, 8 * 1024, 1 })
+                != EncryptionManager::deriveKey("pw", salt, KdfParams{ 1, 8 * 1024, 2 }));
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("Vault: calibrateKdf stays within the memory budget", "[vault][kdf]") {
+    auto cal = calibrateKdf(std::chrono::milliseconds(20), 16 * 1024);
+    REQUIRE_NOTHROW(cal.params.validate());
+    REQUIRE(cal.params.mCostKiB <= 16 * 1024);
+    REQUIRE(cal.params.parallelism >= 1);
+    REQUIRE(cal.measured.count() > 0);
+}
@@ -0,0 +1,99 @@
+// tests/vault_verify.cpp
+#include <catch2/catch_all.hpp>
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "VaultVerify.hpp"
+#include "test_vault.hpp"
+
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    NewCredential sealed_row(const EncryptionManager& enc, const std::string& service, int i) {
+        return sealedRow(enc, service, "user" + std::to_string(i), "pw" + std::to_string(i));
+    }
+
+    std::vector<std::pair<int, VerifyIssue>> issues_of(const VerifyReport& r) {
+        std::vector<std::pair<int, VerifyIssue>> out;
+        for (const auto& f : r.findings) out.emplace_back(f.id, f.issue);
+        return out;
+    }
+}
+
+TEST_CASE("verifyVault: clean vault", "[verify]") {
+    const std::string testDb = "tmp_test_verify_a.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+        CHECK(verifyVault(db, enc).rows == 0);
+
+        std::vector<NewCredential> rows;
+        for (int i = 0; i < 2000; ++i) rows.push_back(sealed_row(enc, "svc", i));
+        db.addCredentials(rows);
+
+        ScanOptions opt;
+        opt.threads = 3;
+        opt.chunkRows = 100;
+        const VerifyReport r = verifyVault(db, enc, opt);
+        CHECK(r.rows == 2000);
+        CHECK(r.clean());
+
+        // Every row fails under another key, each reported once
+        EncryptionManager other(std::vector<std::uint8_t>(32, 0x43));
+        const VerifyReport wrong = verifyVault(db, other, opt);
+        CHECK(wrong.findings.size() == 2000);
+        CHECK(wrong.findings.back().issue == VerifyIssue::BadTag);
+    }
+    std::filesystem::remove(testDb);
+}
+
+TEST_CASE("verifyVault: reports tampering, IV reuse and malformed rows", "[verify]") {
+    const std::string testDb = "tmp_test_verify_b.sqlite";
+    std::filesystem::remove(testDb);
+    {
+        DatabaseManager db(testDb);
+        db.init();
+        EncryptionManager enc(std::vector<std::uint8_t>(32, 0x42));
+
+        std::vector<NewCredential> rows;
+        for (int i = 0; i < 10; ++i) rows.push_back(sealed_row(enc, "svc", i));
+        // 11: exact copy of row 3, so it authenticates but reuses the IV
+        rows.push_back(rows[2]);
+        // 12: IV of the wrong length; 13: ciphertext shorter than a tag
+        rows.push_back(sealed_row(enc, "svc", 12));
+        rows.back().iv.resize(8);
+        rows.push_back(sealed_row(enc, "svc", 13));
+        rows.back().enc_password.resize(4);
+        // 14: valid, but with no service
+        rows.push_back(sealed_row(enc, "", 14));
+        db.addCredentials(rows);
+
+        // 5 and 7 swap secrets; 9's created_at (part of the AAD) is rewritten
+        auto a = db.getCredentialById(5), b = db.getCredentialById(7);
+        db.updateSecrets(std::vector<SecretUpdate>{ {5, b->enc_password, b->iv}, {7, a->enc_password, a->iv} });
+        db.test_updateCreatedAt(9, "yesterday");
+
+        const VerifyReport r = verifyVault(db, enc);
+        CHECK(r.rows == 14);
+        CHECK(r.storageErrors.empty());
+        CHECK_FALSE(r.clean());
+        const std::vector<std::pair<int, VerifyIssue>> expected{
+            {5, VerifyIssue::BadTag},
+            {7, VerifyIssue::BadTag},
+            {9, VerifyIssue::BadCreatedAt},
+            {9, VerifyIssue::BadTag},
+            {11, VerifyIssue::DuplicateIv},
+            {12, VerifyIssue::BadIvLength},
+            {13, VerifyIssue::ShortCiphertext},
+            {14, VerifyIssue::EmptyService},
+        };
+        CHECK(issues_of(r) == expected);
+        CHECK(r.findings[4].otherId == 3);
+        CHECK(std::string(verifyIssueName(VerifyIssue::DuplicateIv)) == "duplicate-iv");
+    }
+    std::filesystem::remove(testDb);
+}
@@ -0,0 +1,194 @@
+// tools/epm_agent.cpp
+// Unlock agent (Linux). `start` unlocks the vault once and serves requests on
+// a Unix socket until stopped, locked or idle; the other commands are a
+// small client for scripts, each costing a socket round trip instead of an
+// Argon2id run.
+//
+//   epm_agent start &                 # prompts for the master password
+//   pw=$(epm_agent get 42)
+//   epm_agent search github
+//   echo "s3cret" | epm_agent add github octocat
+//   epm_agent lock
+#include "AgentClient.hpp"
+#include "AgentServer.hpp"
+#include "DatabaseManager.hpp"
+#include "VaultUnlock.hpp"
+#include "console_io.hpp"
+
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/prctl.h>
+
+namespace {
+    AgentServer* g_server = nullptr; // for the signal handler
+
+    extern "C" void on_signal(int) {
+        if (g_server) g_server->stop(); // one write() to an eventfd
+    }
+
+    void print_usage() {
+        std::cerr << "Usage: epm_agent <command> [--socket PATH]\n"
+                     "  start [--db PATH] [--idle-timeout SEC]  unlock and serve (default data/epm.sqlite, 900 s;\n"
+                     "                                          0 = no timeout). Runs in the foreground.\n"
+                     "  get <id>                                print the password\n"
+                     "  search <query> [--limit N]              print id, service, username, created_at\n"
+                     "  add <service> [username] [--notes TEXT] password is read from stdin\n"
+                     "  ping                                    exit 0 if an agent is running\n"
+                     "  lock                                    wipe the agent's key and stop it\n"
+                     "The socket defaults to $EPM_AGENT_SOCK, $XDG_RUNTIME_DIR/epm-agent.sock or\n"
+                     "/tmp/epm-agent-<uid>/agent.sock.\n";
+    }
+
+    struct Args {
+        std::string command;
+        std::vector<std::string> positional;
+        std::string socketPath = agent::defaultSocketPath();
+        std::string dbPath = "data/epm.sqlite";
+        std::string notes;
+        long idleTimeout = 900;
+        long limit = 50;
+    };
+
+    bool parse_args(int argc, char** argv, Args& a) {
+        if (argc < 2) return false;
+        a.command = argv[1];
+        for (int i = 2; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) { a.positional.push_back(arg); continue; }
+            if (i + 1 >= argc) return false;
+            const std::string val = argv[++i];
+            if (arg == "--socket")            a.socketPath = val;
+            else if (arg == "--db")           a.dbPath = val;
+            else if (arg == "--notes")        a.notes = val;
+            else if (arg == "--idle-timeout") a.idleTimeout = std::stol(val);
+            else if (arg == "--limit")        a.limit = std::stol(val);
+            else return false;
+        }
+        return a.idleTimeout >= 0 && a.limit > 0;
+    }
+
+    // Keep the key, the pre-keyed cipher contexts (AES key schedules on the
+    // normal heap) and every decrypted secret out of swap and core dumps for
+    // the agent's lifetime. Also blocks ptrace and /proc/<pid>/mem from
+    // other processes of the same user. Failures are reported, not fatal:
+    // mlockall needs a memlock limit (ulimit -l) above the process size.
+    void harden_process() {
+        if (::prctl(PR_SET_DUMPABLE, 0, 0, 0, 0) != 0) {
+            std::cerr << "Warning: prctl(PR_SET_DUMPABLE) failed: " << std::strerror(errno)
+                      << "; the key may end up in a core dump.\n";
+        }
+        if (::mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            std::cerr << "Warning: mlockall failed: " << std::strerror(errno)
+                      << "; only the key itself is kept out of swap. Raise `ulimit -l`"
+                         " (or grant CAP_IPC_LOCK) to lock the whole agent.\n";
+        }
+    }
+
+    int run_start(const Args& a) {
+        if (!std::filesystem::exists(a.dbPath)) {
+            std::cerr << a.dbPath << " not found. Run epm once interactively first.\n";
+            return 1;
+        }
+        DatabaseManager db(a.dbPath);
+        db.init();
+        if (!db.loadMaster()) {
+            std::cerr << "No master password set. Run epm once interactively first.\n";
+            return 1;
+        }
+
+        harden_process();
+        secure_string pw = prompt_hidden("Master password: ", std::cerr);
+        auto unlocked = unlockVault(db, pw);
+        pw = secure_string();
+        if (!unlocked) {
+            std::cerr << "Login failed\n";
+            return 2;
+        }
+
+        AgentServer::Options opt;
+        opt.socketPath = a.socketPath;
+        opt.idleTimeout = std::chrono::seconds(a.idleTimeout);
+        AgentServer server(db, std::move(*unlocked), opt);
+
+        g_server = &server;
+        std::signal(SIGINT, on_signal);
+        std::signal(SIGTERM, on_signal);
+        std::signal(SIGHUP, on_signal);
+
+        // ssh-agent style, so `eval $(epm_agent start)` works for other paths
+        std::cout << "EPM_AGENT_SOCK=" << server.socketPath() << "; export EPM_AGENT_SOCK;" << std::endl;
+        const auto reason = server.run();
+        g_server = nullptr;
+
+        switch (reason) {
+        case AgentServer::StopReason::Locked:      std::cerr << "Locked.\n"; break;
+        case AgentServer::StopReason::IdleTimeout: std::cerr << "Idle timeout, key wiped.\n"; break;
+        case AgentServer::StopReason::Stopped:     std::cerr << "Stopped.\n"; break;
+        }
+        return 0;
+    }
+
+    int run_client(const Args& a) {
+        const auto& pos = a.positional;
+        AgentClient client(a.socketPath);
+
+        if (a.command == "ping" && pos.empty()) {
+            client.ping();
+        } else if (a.command == "lock" && pos.empty()) {
+            client.lock();
+        } else if (a.command == "get" && pos.size() == 1) {
+            const auto cred = client.get(std::stoi(pos[0]));
+            if (!cred) {
+                std::cerr << "No such id.\n";
+                return 2;
+            }
+            std::cout << cred->password << "\n";
+        } else if (a.command == "search" && pos.size() == 1) {
+            for (const CredentialMeta& m : client.search(pos[0], static_cast<std::uint32_t>(a.limit))) {
+                std::cout << m.id << '\t' << m.service << '\t' << m.username << '\t' << m.created_at << "\n";
+            }
+        } else if (a.command == "add" && (pos.size() == 1 || pos.size() == 2)) {
+            secure_string pw;
+            std::getline(std::cin, pw);
+            if (pw.empty()) {
+                std::cerr << "Empty password on stdin.\n";
+                return 1;
+            }
+            std::cout << client.add(pos[0], pos.size() == 2 ? pos[1] : "", pw, a.notes) << "\n";
+        } else {
+            print_usage();
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    Args args;
+    try {
+        if (!parse_args(argc, argv, args)) { print_usage(); return 1; }
+    } catch (const std::exception& ex) {
+        std::cerr << "Bad argument: " << ex.what() << "\n";
+        print_usage();
+        return 1;
+    }
+
+    try {
+        if (args.command == "start") {
+            if (!args.positional.empty()) { print_usage(); return 1; }
+            return run_start(args);
+        }
+        return run_client(args);
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 3;
+    }
+}
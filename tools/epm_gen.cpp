@@ -0,0 +1,315 @@
+// tools/epm_gen.cpp
+// Synthetic vault generator for load testing. Creates a new vault and fills
+// it with N credentials sealed by the real EncryptionManager, exactly as the
+// app would store them (same AAD, same schema, same KDF record).
+//
+//   epm_gen load.sqlite -n 1000000 --password test
+//
+// Rows are generated and encrypted in chunks on a thread pool; the main
+// thread inserts finished chunks in order, one transaction per chunk. The
+// output is deterministic for a given --seed (up to IVs, which are random).
+#include "DatabaseManager.hpp"
+#include "EncryptionManager.hpp"
+#include "CredentialAad.hpp"
+#include "KdfParams.hpp"
+#include "ThreadPool.hpp"
+#include "VaultUnlock.hpp"
+#include "console_io.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    struct Range {
+        std::size_t min, max;
+    };
+
+    struct GenOptions {
+        std::string   path;
+        std::size_t   count       = 100000;
+        std::size_t   services    = 1000;  // distinct service names
+        double        zipf        = 1.0;   // service popularity skew, 0 = uniform
+        Range         userLen     {6, 16};
+        Range         noteLen     {0, 80};
+        double        noteRate    = 0.3;   // fraction of rows with notes
+        Range         secretLen   {12, 32};
+        std::size_t   days        = 730;   // created_at span, oldest row first
+        std::uint64_t seed        = 1;
+        std::size_t   threads     = 0;     // 0 = all hardware threads
+        std::size_t   chunk       = 20000; // rows per job and per transaction
+        KdfParams     kdf         = defaultKdfParams();
+        std::string   password;
+    };
+
+    const char* const kBaseServices[] = {
+        "github", "google", "amazon", "netflix", "spotify", "slack", "dropbox",
+        "microsoft", "apple", "twitter", "facebook", "linkedin", "reddit",
+        "gitlab", "atlassian", "zoom", "paypal", "stripe", "digitalocean",
+        "cloudflare", "steam", "discord", "notion", "figma", "heroku",
+        "bank-of-somewhere", "mail-provider", "home-router", "vpn", "nas",
+    };
+    constexpr std::size_t kBaseCount = std::size(kBaseServices);
+
+    const char* const kNoteWords[] = {
+        "work", "personal", "shared", "team", "login", "admin", "backup",
+        "recovery", "codes", "in", "the", "safe", "old", "account", "do",
+        "not", "use", "billing", "contact", "support", "2fa", "enabled",
+    };
+
+    // Service of popularity rank r: real-looking names, then numbered variants
+    std::string service_name(std::size_t rank) {
+        std::string s = kBaseServices[rank % kBaseCount];
+        if (rank >= kBaseCount) s += "-" + std::to_string(rank / kBaseCount);
+        return s;
+    }
+
+    // Zipf(s) over ranks 0..n-1 as a cumulative table, sampled by bisection
+    std::vector<double> zipf_cdf(std::size_t n, double s) {
+        std::vector<double> cdf(n);
+        double sum = 0;
+        for (std::size_t r = 0; r < n; ++r) {
+            sum += 1.0 / std::pow(static_cast<double>(r + 1), s);
+            cdf[r] = sum;
+        }
+        for (double& c : cdf) c /= sum;
+        return cdf;
+    }
+
+    // One unit of work: rows [first, first + count) generated and sealed
+    struct Chunk {
+        std::size_t                first = 0, count = 0;
+        std::vector<NewCredential> rows;
+    };
+
+    class Generator {
+    public:
+        Generator(const GenOptions& o, const EncryptionManager& enc, std::time_t now)
+            : m_opt(o), m_enc(enc), m_now(now),
+              m_cdf(zipf_cdf(std::max<std::size_t>(o.services, 1), o.zipf)) {}
+
+        void fill(Chunk& c) const {
+            // Per-chunk stream: same rows for the same seed, any thread count
+            std::mt19937_64 rng(m_opt.seed * 0x9E3779B97F4A7C15ull + c.first);
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+            auto between = [&](Range r) {
+                return r.min + static_cast<std::size_t>(rng() % (r.max - r.min + 1));
+            };
+            auto pick = [&](std::string_view alphabet, std::size_t len, std::string& out) {
+                out.resize(len);
+                for (char& ch : out) ch = alphabet[rng() % alphabet.size()];
+            };
+            static constexpr std::string_view kUser = "abcdefghijklmnopqrstuvwxyz0123456789._";
+            static constexpr std::string_view kSecret =
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789!@#$%^&*()-_=+";
+            const std::int64_t spread = static_cast<std::int64_t>(m_opt.days) * 86400;
+
+            c.rows.resize(c.count);
+            std::vector<std::string> secrets(c.count);
+            std::vector<std::vector<std::uint8_t>> aads(c.count);
+            for (std::size_t i = 0; i < c.count; ++i) {
+                NewCredential& r = c.rows[i];
+                const auto rank = static_cast<std::size_t>(
+                    std::lower_bound(m_cdf.begin(), m_cdf.end(), unit(rng)) - m_cdf.begin());
+                r.service = service_name(std::min(rank, m_cdf.size() - 1));
+
+                pick(kUser, between(m_opt.userLen), r.username);
+                if (rng() % 3 == 0) r.username += "@example.com";
+
+                r.notes.clear();
+                if (unit(rng) < m_opt.noteRate) {
+                    const std::size_t len = between(m_opt.noteLen);
+                    while (r.notes.size() < len) {
+                        if (!r.notes.empty()) r.notes += ' ';
+                        r.notes += kNoteWords[rng() % std::size(kNoteWords)];
+                    }
+                    r.notes.resize(len);
+                }
+
+                // Ascending with id, like a vault filled over time; this also
+                // keeps the created_at index append-only while generating
+                const auto row = static_cast<double>(c.first + i);
+                const auto back = static_cast<std::int64_t>(
+                    spread * (1.0 - row / static_cast<double>(m_opt.count)));
+                r.created_at = iso8601Utc(static_cast<std::time_t>(m_now - back));
+
+                pick(kSecret, between(m_opt.secretLen), secrets[i]);
+                makeCredentialAad(aads[i], r.service, r.username, r.created_at);
+            }
+
+            // Seal the whole chunk with one context lease and one RAND_bytes
+            using Bytes = std::span<const std::uint8_t>;
+            std::vector<Bytes> pts(c.count), aadSpans(c.count);
+            for (std::size_t i = 0; i < c.count; ++i) {
+                pts[i] = asBytes(secrets[i]);
+                aadSpans[i] = aads[i];
+            }
+            EncryptionManager::SealedBatch sealed;
+            m_enc.encryptBatch(pts, aadSpans, sealed);
+            for (std::size_t i = 0; i < c.count; ++i) {
+                c.rows[i].iv.assign(sealed.iv(i).begin(), sealed.iv(i).end());
+                c.rows[i].enc_password.assign(sealed.sealed(i).begin(), sealed.sealed(i).end());
+            }
+        }
+
+    private:
+        const GenOptions&        m_opt;
+        const EncryptionManager& m_enc;
+        std::time_t              m_now;
+        std::vector<double>      m_cdf;
+    };
+
+    void print_usage() {
+        std::cerr << "Usage: epm_gen <vault.sqlite> [options]\n"
+                     "  -n, --count N          credentials to generate (default 100000)\n"
+                     "  --services N           distinct service names (default 1000)\n"
+                     "  --zipf S               service popularity skew, 0 = uniform (default 1.0)\n"
+                     "  --user-len MIN:MAX     username length (default 6:16)\n"
+                     "  --note-len MIN:MAX     note length when present (default 0:80)\n"
+                     "  --note-rate P          fraction of rows with notes (default 0.3)\n"
+                     "  --secret-len MIN:MAX   secret length (default 12:32)\n"
+                     "  --days N               created_at span ending now, oldest first (default 730)\n"
+                     "  --seed N               RNG seed (default 1)\n"
+                     "  --threads N            encryption threads, 0 = all (default 0)\n"
+                     "  --chunk N              rows per job and transaction (default 20000)\n"
+                     "  --kdf T:MIB:P          Argon2id cost for the vault (default: app default)\n"
+                     "  --password PW          master password (default: prompt)\n";
+    }
+
+    std::size_t parse_size(const std::string& s) {
+        std::size_t pos = 0;
+        const unsigned long long v = std::stoull(s, &pos);
+        if (pos != s.size()) throw std::invalid_argument(s);
+        return static_cast<std::size_t>(v);
+    }
+
+    Range parse_range(const std::string& s) {
+        const auto colon = s.find(':');
+        if (colon == std::string::npos) {
+            const std::size_t v = parse_size(s);
+            return {v, v};
+        }
+        Range r{parse_size(s.substr(0, colon)), parse_size(s.substr(colon + 1))};
+        if (r.min > r.max) throw std::invalid_argument(s);
+        return r;
+    }
+
+    KdfParams parse_kdf(const std::string& s) {
+        const auto a = s.find(':'), b = s.find(':', a + 1);
+        if (a == std::string::npos || b == std::string::npos) throw std::invalid_argument(s);
+        KdfParams p;
+        p.tCost       = static_cast<std::uint32_t>(parse_size(s.substr(0, a)));
+        p.mCostKiB    = static_cast<std::uint32_t>(parse_size(s.substr(a + 1, b - a - 1)) * 1024);
+        p.parallelism = static_cast<std::uint32_t>(parse_size(s.substr(b + 1)));
+        p.validate();
+        return p;
+    }
+
+    // Throws std::invalid_argument on anything malformed
+    bool parse_args(int argc, char** argv, GenOptions& o) {
+        if (argc < 2 || argv[1][0] == '-') return false;
+        o.path = argv[1];
+        for (int i = 2; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) return false;
+            const std::string val = argv[++i];
+            if (arg == "-n" || arg == "--count")  o.count     = parse_size(val);
+            else if (arg == "--services")         o.services  = parse_size(val);
+            else if (arg == "--zipf")             o.zipf      = std::stod(val);
+            else if (arg == "--user-len")         o.userLen   = parse_range(val);
+            else if (arg == "--note-len")         o.noteLen   = parse_range(val);
+            else if (arg == "--note-rate")        o.noteRate  = std::stod(val);
+            else if (arg == "--secret-len")       o.secretLen = parse_range(val);
+            else if (arg == "--days")             o.days      = parse_size(val);
+            else if (arg == "--seed")             o.seed      = parse_size(val);
+            else if (arg == "--threads")          o.threads   = parse_size(val);
+            else if (arg == "--chunk")            o.chunk     = parse_size(val);
+            else if (arg == "--kdf")              o.kdf       = parse_kdf(val);
+            else if (arg == "--password")         o.password  = val;
+            else return false;
+        }
+        if (o.chunk == 0 || o.services == 0 || o.userLen.min == 0 || o.secretLen.min == 0 ||
+            o.zipf < 0 || o.noteRate < 0 || o.noteRate > 1) {
+            throw std::invalid_argument("option out of range");
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    GenOptions opt;
+    try {
+        if (!parse_args(argc, argv, opt)) { print_usage(); return 1; }
+    } catch (const std::exception& ex) {
+        std::cerr << "Bad argument: " << ex.what() << "\n";
+        print_usage();
+        return 1;
+    }
+
+    try {
+        if (std::filesystem::exists(opt.path)) {
+            std::cerr << opt.path << " already exists; epm_gen only creates new vaults.\n";
+            return 1;
+        }
+        secure_string pw = opt.password.empty() ? prompt_hidden("Master password for the new vault: ")
+                                                : secure_string(opt.password);
+        if (pw.empty()) {
+            std::cerr << "Empty password.\n";
+            return 1;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        DatabaseManager db(opt.path, DatabaseOptions::fast());
+        db.init();
+        EncryptionManager enc = createVault(db, pw, opt.kdf);
+        pw = secure_string();
+        // Trigram indexing per chunk is most of the cost; do it once at the end
+        db.deferFullTextIndex();
+
+        const auto sealedAt = std::chrono::steady_clock::now();
+        const Generator gen(opt, enc, std::time(nullptr));
+        std::size_t written = 0;
+
+        auto retire = [&](std::unique_ptr<Chunk> c) {
+            db.addCredentials(c->rows, c->rows.size());
+            written += c->rows.size();
+            std::cout << "\rWritten " << written << "/" << opt.count << std::flush;
+        };
+        OrderedPipeline<Chunk> pipeline(opt.threads, 0, retire);
+        const std::size_t threads = pipeline.threads();
+
+        for (std::size_t first = 0; first < opt.count; first += opt.chunk) {
+            auto c = std::make_unique<Chunk>();
+            c->first = first;
+            c->count = std::min(opt.chunk, opt.count - first);
+            pipeline.submit(std::move(c), [&gen](Chunk& chunk) { gen.fill(chunk); });
+        }
+        pipeline.finish();
+        if (written) std::cout << "\n";
+
+        const auto loadedAt = std::chrono::steady_clock::now();
+        db.resumeFullTextIndex();
+
+        const auto end = std::chrono::steady_clock::now();
+        const double kdfSecs = std::chrono::duration<double>(sealedAt - start).count();
+        const double genSecs = std::chrono::duration<double>(loadedAt - sealedAt).count();
+        const double ftsSecs = std::chrono::duration<double>(end - loadedAt).count();
+        std::cout << "Generated " << written << " credentials in " << genSecs << " s";
+        if (genSecs > 0) std::cout << " (" << static_cast<std::size_t>(written / genSecs) << " rows/s)";
+        std::cout << " on " << threads << " threads; search index " << ftsSecs
+                  << " s; vault setup " << kdfSecs << " s.\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+}